@@ -1,43 +1,23 @@
 #include "CubeModel.h"
 
-CubeModel::CubeModel() : Model((float*) vertices, 288)
+// The floor is drawn from the first face alone, so its triangles are kept ahead of the rest. Every corner is a seam
+// between faces, so the cube has no coarser levels of detail than the full mesh
+CubeModel::CubeModel() : Model(MeshSimplifier::generateLods(MeshOptimiser::optimise(
+        MeshBuilder::weld(vertices, sizeof(vertices) / sizeof(float), 8, "CubeModel"), 3, "CubeModel", {6}), 3, "CubeModel"), {
+        // Position, Normal, Texture. Each is stored exactly, as the cube's values are all 0, 1 or its size
+        {0, 3, 0, VertexPacking::QUANTISED_SHORT},
+        {1, 3, 3, VertexPacking::NORMALISED_INT_2_10_10_10},
+        {2, 2, 6, VertexPacking::HALF_FLOAT}
+}, "CubeModel")
 {
-    // Position
-    // Tells OpenGL how to interpret the vertex buffer data
-    // Index, Size, Type, Normalized, Stride, Pointer
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void *) 0);
-    // Enables a generic vertex attribute at the given index
-    glEnableVertexAttribArray(0);
-
-    // Location
-    // Tells OpenGL how to interpret the vertex buffer data
-    // Index, Size, Type, Normalized, Stride, Pointer
-    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void *) (3 * sizeof(float)));
-    // Enables a generic vertex attribute at the given index
-    glEnableVertexAttribArray(1);
-
-    // Texture
-    // Tells OpenGL how to interpret the vertex buffer data
-    // Index, Size, Type, Normalized, Stride, Pointer
-    glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void *) (6 * sizeof(float)));
-    // Enables a generic vertex attribute at the given index
-    glEnableVertexAttribArray(2);
-
-    // Note that this is allowed, the call to glVertexAttribPointer registered VBO as the vertex attribute's bound vertex buffer object so afterwards we can safely unbind
-    // Unbinds the buffer
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
-
-    // You can unbind the VAO afterwards so other VAO calls won't accidentally modify this VAO, but this rarely happens. Modifying other
-    // VAOs requires a call to glBindVertexArray anyways so we generally don't unbind VAOs (nor VBOs) when it's not directly necessary.
-    glBindVertexArray(0);
 }
 
-void CubeModel::draw(glm::vec3 position, Shader shader)
+void CubeModel::draw(glm::vec3 position, const Shader &shader)
 {
     Model::draw(position, shader, 36);
 }
 
-void CubeModel::drawS(glm::vec3 position, Shader shader, float size)
+void CubeModel::drawS(glm::vec3 position, const Shader &shader, float size)
 {
     Model::drawS(position, shader, 36, size);
 }
\ No newline at end of file
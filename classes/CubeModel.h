@@ -55,13 +55,13 @@ public:
 
     CubeModel();
 
-    void draw(glm::vec3 position, Shader shader);
+    void draw(glm::vec3 position, const Shader &shader);
     /**
      * DO NOT USE - This is specifically for 2D Models
      */
-    void draw(glm::vec2 position, glm::vec2 screen, glm::vec2 size, Shader shader) {};
+    void draw(glm::vec2 position, glm::vec2 screen, glm::vec2 size, const Shader &shader) {};
 
-    void drawS(glm::vec3 position, Shader shader, float size);
+    void drawS(glm::vec3 position, const Shader &shader, float size);
 };
 
 
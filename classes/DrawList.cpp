@@ -0,0 +1,135 @@
+#include "DrawList.h"
+#include "Extensions.h"
+#include "ShaderProfiler.h"
+#include "StreamBuffer.h"
+
+bool DrawList::indirect = false;
+
+DrawList::DrawList(bool multiDraw) : multiDraw(multiDraw)
+{
+    if(multiDraw) glGenBuffers(1, &commandBuffer);
+}
+
+DrawList::~DrawList()
+{
+    glDeleteBuffers(1, &commandBuffer);
+}
+
+ShaderDefines DrawList::drawDefines(bool multiDraw)
+{
+    if(multiDraw) return ShaderDefines{{"INSTANCED", "1"}};
+    return ShaderDefines{};
+}
+
+void DrawList::setCuller(MeshletCuller *culler)
+{
+    this->culler = culler;
+}
+
+void DrawList::add(const Shader &shader, const Model &model, int vertices, const glm::mat4 &transform)
+{
+    add(shader, model, MeshLod{0, (size_t) vertices, 0.0f}, transform);
+}
+
+void DrawList::add(const Shader &shader, const Model &model, const MeshLod &lod, const glm::mat4 &transform)
+{
+    // An empty model's arena may have no buffers to draw from
+    if(lod.indexCount == 0) return;
+    visible.clear();
+    if(culler && lod.meshletCount > 0)
+    {
+        culler->cull(model, lod, transform, visible);
+        if(visible.empty()) return;
+    }
+    else
+    {
+        visible.push_back(lod);
+    }
+
+    GeometryArena *arena = &model.getArena();
+    Batch *batch = nullptr;
+    for(Batch &existing : batches)
+    {
+        if(existing.shader == &shader && existing.arena == arena)
+        {
+            batch = &existing;
+            break;
+        }
+    }
+    if(batch == nullptr)
+    {
+        batches.push_back(Batch{&shader, arena, {}, {}});
+        batch = &batches.back();
+    }
+
+    // Quantised positions are restored by the transform, as the shaders have no separate matrix for it
+    batch->transforms.push_back(transform * model.getDequantisation());
+    for(const MeshLod &range : visible)
+    {
+        batch->commands.push_back(DrawElementsIndirectCommand{(GLuint) range.indexCount, 1,
+                (GLuint) (model.getFirstIndex() + range.firstIndex), model.getBaseVertex(),
+                (GLuint) batch->transforms.size() - 1});
+    }
+}
+
+void DrawList::draw()
+{
+    // Offset of the next batch's commands into the indirect buffer in bytes
+    size_t offset = 0;
+    if(multiDraw)
+    {
+        // Every batch's commands go in one upload, each batch drawing from its own offset
+        commands.clear();
+        for(const Batch &batch : batches)
+        {
+            commands.insert(commands.end(), batch.commands.begin(), batch.commands.end());
+        }
+        size_t size = commands.size() * sizeof(DrawElementsIndirectCommand);
+        if(StreamBuffer::active)
+        {
+            offset = StreamBuffer::active->write(commands.data(), size, sizeof(GLuint));
+            glBindBuffer(GL_DRAW_INDIRECT_BUFFER, StreamBuffer::active->getBuffer());
+        }
+        else
+        {
+            glBindBuffer(GL_DRAW_INDIRECT_BUFFER, commandBuffer);
+            // Orphans the previous commands, so the driver needn't wait for draws still reading them
+            glBufferData(GL_DRAW_INDIRECT_BUFFER, size, nullptr, GL_STREAM_DRAW);
+            glBufferSubData(GL_DRAW_INDIRECT_BUFFER, 0, size, commands.data());
+        }
+    }
+
+    for(Batch &batch : batches)
+    {
+        if(batch.commands.empty()) continue;
+        batch.shader->use();
+        if(multiDraw)
+        {
+            // Each command reads its transform at its base instance
+            batch.arena->setInstances(batch.transforms.data(), batch.transforms.size(), nullptr);
+            ShaderProfiler::multiDrawElementsIndirect(GL_TRIANGLES, batch.arena->getIndexType(), offset,
+                    batch.commands.data(), (int) batch.commands.size());
+            offset += batch.commands.size() * sizeof(DrawElementsIndirectCommand);
+        }
+        else
+        {
+            batch.arena->bind();
+            size_t indexSize = batch.arena->getIndexType() == GL_UNSIGNED_SHORT ? 2 : 4;
+            for(size_t i = 0; i < batch.commands.size(); i++)
+            {
+                const DrawElementsIndirectCommand &command = batch.commands[i];
+                // Ranges of the same object share its transform
+                if(i == 0 || command.baseInstance != batch.commands[i - 1].baseInstance)
+                {
+                    batch.shader->setMat4("model"_u, batch.transforms[command.baseInstance]);
+                }
+                ShaderProfiler::drawElements(GL_TRIANGLES, command.count, batch.arena->getIndexType(),
+                        command.firstIndex * indexSize, command.baseVertex);
+            }
+        }
+        batch.commands.clear();
+        batch.transforms.clear();
+    }
+
+    if(multiDraw) glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+}
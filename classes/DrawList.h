@@ -0,0 +1,109 @@
+#ifndef OPENGLPROJECT_DRAWLIST_H
+#define OPENGLPROJECT_DRAWLIST_H
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include <vector>
+#include "Shader.h"
+#include "Model.h"
+#include "GeometryArena.h"
+#include "MeshletCuller.h"
+
+/**
+ * One draw of glMultiDrawElementsIndirect, laid out as OpenGL reads it from the indirect buffer
+ */
+struct DrawElementsIndirectCommand {
+    GLuint count;
+    GLuint instanceCount;
+    // In indices, not bytes
+    GLuint firstIndex;
+    GLint baseVertex;
+    // First element of the per-instance attributes the draw reads
+    GLuint baseInstance;
+};
+
+/**
+ * Collects the objects of a frame, then submits every object sharing a shader and a GeometryArena in one draw call
+ *
+ * With multi draw indirect, each object becomes a command reading its transform from the arena's per-instance
+ * attributes at its base instance, so the shaders must be built with drawDefines. Without it, each object is drawn in
+ * turn with its transform set as the model uniform. Levels of detail split into meshlets are culled as they're added,
+ * if a MeshletCuller is set, and draw only the ranges of meshlets left
+ */
+class DrawList {
+public:
+    // Whether objects are drawn with glMultiDrawElementsIndirect, rather than one glDrawElementsBaseVertex each, by
+    // default. Only true where the driver supports it
+    static bool indirect;
+
+    /**
+     * Creates an empty list
+     * @param multiDraw Whether to draw with glMultiDrawElementsIndirect, which the driver must support
+     */
+    explicit DrawList(bool multiDraw = indirect);
+    ~DrawList();
+    DrawList(const DrawList &) = delete;
+    DrawList &operator=(const DrawList &) = delete;
+
+    /**
+     * Gets the defines shaders drawn through a DrawList must be built with
+     * @param multiDraw Whether the list draws with glMultiDrawElementsIndirect
+     * @return INSTANCED when drawing indirectly, otherwise nothing
+     */
+    static ShaderDefines drawDefines(bool multiDraw = indirect);
+
+    /**
+     * Sets the culler rejecting the meshlets of objects as they're added
+     * @param culler Culler set to the view being drawn, or nullptr to draw every meshlet
+     */
+    void setCuller(MeshletCuller *culler);
+
+    /**
+     * Adds an object to draw. The shader and model must outlive the next draw
+     * @param shader Shader to draw with
+     * @param model Model to draw
+     * @param vertices Number of vertices to draw, from the start of the triangle list
+     * @param transform Model matrix of the object
+     */
+    void add(const Shader &shader, const Model &model, int vertices, const glm::mat4 &transform);
+    /**
+     * Adds an object to draw at a level of detail, leaving out any meshlets the culler rejects. The shader and model
+     * must outlive the next draw
+     * @param shader Shader to draw with
+     * @param model Model to draw
+     * @param lod One of the model's levels of detail
+     * @param transform Model matrix of the object
+     */
+    void add(const Shader &shader, const Model &model, const MeshLod &lod, const glm::mat4 &transform);
+    /**
+     * Draws every object added since the last draw, in the order their shader and arena were first added
+     */
+    void draw();
+
+private:
+    /**
+     * Objects sharing a shader and an arena
+     */
+    struct Batch {
+        const Shader *shader;
+        GeometryArena *arena;
+        std::vector<DrawElementsIndirectCommand> commands;
+        // Transforms of the objects, which each command reads at its base instance. An object culled to several
+        // ranges has a command for each sharing its transform
+        std::vector<glm::mat4> transforms;
+    };
+
+    // Batches are kept once emptied, so their vectors don't reallocate each frame
+    std::vector<Batch> batches;
+    bool multiDraw;
+    // Commands of every batch, as uploaded to the indirect buffer
+    std::vector<DrawElementsIndirectCommand> commands;
+    unsigned int commandBuffer = 0;
+    MeshletCuller *culler = nullptr;
+    // Ranges of the last object culled, kept to avoid allocating each add
+    std::vector<MeshLod> visible;
+};
+
+
+#endif //OPENGLPROJECT_DRAWLIST_H
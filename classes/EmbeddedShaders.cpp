@@ -0,0 +1,27 @@
+#include <cstdlib>
+#include <iostream>
+#include <stb_image.h>
+#include "EmbeddedShaders.h"
+
+const std::map<std::string, std::string> &EmbeddedShaders::load()
+{
+    static std::map<std::string, std::string> sources;
+    if(!sources.empty()) return sources;
+
+    for(unsigned int i = 0; i < embeddedShaderCount; i++)
+    {
+        const EmbeddedShader &shader = embeddedShaders[i];
+        int length;
+        // stb_image's zlib decoder is already built into the program for PNGs
+        char *source = stbi_zlib_decode_malloc((const char *) shader.data, (int) shader.size, &length);
+        if(source == nullptr)
+        {
+            std::cerr << "ERROR::SHADER::EMBEDDED::DECOMPRESSION_FAILED " << shader.path << std::endl;
+            continue;
+        }
+        sources[shader.path] = std::string(source, length);
+        free(source);
+    }
+    std::cout << "INFO::SHADER::EMBEDDED::LOADED " << sources.size() << " shaders" << std::endl;
+    return sources;
+}
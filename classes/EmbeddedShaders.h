@@ -0,0 +1,35 @@
+#ifndef OPENGLPROJECT_EMBEDDEDSHADERS_H
+#define OPENGLPROJECT_EMBEDDEDSHADERS_H
+
+#include <map>
+#include <string>
+
+/**
+ * A shader built into the program, with its includes already resolved
+ */
+struct EmbeddedShader {
+    // Path relative to shaders
+    const char *path;
+    // Source code compressed with zlib
+    const unsigned char *data;
+    unsigned int size;
+};
+
+// Written by shaderpack when building, from every shader in shaders/
+extern const EmbeddedShader embeddedShaders[];
+extern const unsigned int embeddedShaderCount;
+
+/**
+ * Gives access to the shaders built into the program, so they needn't be read from disk
+ */
+class EmbeddedShaders {
+public:
+    /**
+     * Decompresses every embedded shader. Only done the first time it's called
+     * @return Source code by path relative to shaders
+     */
+    static const std::map<std::string, std::string> &load();
+};
+
+
+#endif //OPENGLPROJECT_EMBEDDEDSHADERS_H
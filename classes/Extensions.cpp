@@ -0,0 +1,104 @@
+#include <cstring>
+#include "Extensions.h"
+
+PFNGLGETPROGRAMBINARYPROC ext_glGetProgramBinary = nullptr;
+PFNGLPROGRAMBINARYPROC ext_glProgramBinary = nullptr;
+PFNGLPROGRAMPARAMETERIPROC ext_glProgramParameteri = nullptr;
+PFNGLMAXSHADERCOMPILERTHREADSKHRPROC ext_glMaxShaderCompilerThreadsKHR = nullptr;
+PFNGLGENPROGRAMPIPELINESPROC ext_glGenProgramPipelines = nullptr;
+PFNGLDELETEPROGRAMPIPELINESPROC ext_glDeleteProgramPipelines = nullptr;
+PFNGLBINDPROGRAMPIPELINEPROC ext_glBindProgramPipeline = nullptr;
+PFNGLUSEPROGRAMSTAGESPROC ext_glUseProgramStages = nullptr;
+PFNGLPROGRAMUNIFORM1IVPROC ext_glProgramUniform1iv = nullptr;
+PFNGLPROGRAMUNIFORM1FVPROC ext_glProgramUniform1fv = nullptr;
+PFNGLPROGRAMUNIFORM2FVPROC ext_glProgramUniform2fv = nullptr;
+PFNGLPROGRAMUNIFORM3FVPROC ext_glProgramUniform3fv = nullptr;
+PFNGLPROGRAMUNIFORM4FVPROC ext_glProgramUniform4fv = nullptr;
+PFNGLPROGRAMUNIFORMMATRIX4FVPROC ext_glProgramUniformMatrix4fv = nullptr;
+PFNGLMULTIDRAWELEMENTSINDIRECTPROC ext_glMultiDrawElementsIndirect = nullptr;
+PFNGLBUFFERSTORAGEPROC ext_glBufferStorage = nullptr;
+
+bool Extensions::programBinary = false;
+bool Extensions::parallelShaderCompile = false;
+bool Extensions::separateShaderObjects = false;
+bool Extensions::multiDrawIndirect = false;
+bool Extensions::bufferStorage = false;
+
+void Extensions::load(GLADloadproc load)
+{
+    if(version(4, 1) || has("GL_ARB_get_program_binary"))
+    {
+        ext_glGetProgramBinary = (PFNGLGETPROGRAMBINARYPROC) load("glGetProgramBinary");
+        ext_glProgramBinary = (PFNGLPROGRAMBINARYPROC) load("glProgramBinary");
+        ext_glProgramParameteri = (PFNGLPROGRAMPARAMETERIPROC) load("glProgramParameteri");
+
+        // A driver can support the extension without supporting any binary formats
+        int formats = 0;
+        glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+        programBinary = formats > 0 && ext_glGetProgramBinary && ext_glProgramBinary && ext_glProgramParameteri;
+    }
+
+    if(has("GL_KHR_parallel_shader_compile"))
+    {
+        ext_glMaxShaderCompilerThreadsKHR = (PFNGLMAXSHADERCOMPILERTHREADSKHRPROC) load("glMaxShaderCompilerThreadsKHR");
+    }
+    else if(has("GL_ARB_parallel_shader_compile"))
+    {
+        ext_glMaxShaderCompilerThreadsKHR = (PFNGLMAXSHADERCOMPILERTHREADSKHRPROC) load("glMaxShaderCompilerThreadsARB");
+    }
+    if(ext_glMaxShaderCompilerThreadsKHR)
+    {
+        // Lets the driver use as many threads as it likes
+        glMaxShaderCompilerThreadsKHR(0xFFFFFFFF);
+        parallelShaderCompile = true;
+    }
+
+    if(version(4, 1) || has("GL_ARB_separate_shader_objects"))
+    {
+        ext_glProgramParameteri = (PFNGLPROGRAMPARAMETERIPROC) load("glProgramParameteri");
+        ext_glGenProgramPipelines = (PFNGLGENPROGRAMPIPELINESPROC) load("glGenProgramPipelines");
+        ext_glDeleteProgramPipelines = (PFNGLDELETEPROGRAMPIPELINESPROC) load("glDeleteProgramPipelines");
+        ext_glBindProgramPipeline = (PFNGLBINDPROGRAMPIPELINEPROC) load("glBindProgramPipeline");
+        ext_glUseProgramStages = (PFNGLUSEPROGRAMSTAGESPROC) load("glUseProgramStages");
+        ext_glProgramUniform1iv = (PFNGLPROGRAMUNIFORM1IVPROC) load("glProgramUniform1iv");
+        ext_glProgramUniform1fv = (PFNGLPROGRAMUNIFORM1FVPROC) load("glProgramUniform1fv");
+        ext_glProgramUniform2fv = (PFNGLPROGRAMUNIFORM2FVPROC) load("glProgramUniform2fv");
+        ext_glProgramUniform3fv = (PFNGLPROGRAMUNIFORM3FVPROC) load("glProgramUniform3fv");
+        ext_glProgramUniform4fv = (PFNGLPROGRAMUNIFORM4FVPROC) load("glProgramUniform4fv");
+        ext_glProgramUniformMatrix4fv = (PFNGLPROGRAMUNIFORMMATRIX4FVPROC) load("glProgramUniformMatrix4fv");
+        // A driver exporting only some of the entry points would otherwise fail on a null pointer partway through
+        separateShaderObjects = ext_glProgramParameteri && ext_glGenProgramPipelines && ext_glDeleteProgramPipelines
+                && ext_glBindProgramPipeline && ext_glUseProgramStages && ext_glProgramUniform1iv
+                && ext_glProgramUniform1fv && ext_glProgramUniform2fv && ext_glProgramUniform3fv
+                && ext_glProgramUniform4fv && ext_glProgramUniformMatrix4fv;
+    }
+
+    // The base instance of each command is only read with ARB_base_instance (core in 4.2)
+    if(version(4, 3) || (has("GL_ARB_multi_draw_indirect") && has("GL_ARB_base_instance")))
+    {
+        ext_glMultiDrawElementsIndirect = (PFNGLMULTIDRAWELEMENTSINDIRECTPROC) load("glMultiDrawElementsIndirect");
+        multiDrawIndirect = ext_glMultiDrawElementsIndirect != nullptr;
+    }
+
+    if(version(4, 4) || has("GL_ARB_buffer_storage"))
+    {
+        ext_glBufferStorage = (PFNGLBUFFERSTORAGEPROC) load("glBufferStorage");
+        bufferStorage = ext_glBufferStorage != nullptr;
+    }
+}
+
+bool Extensions::has(const char *name)
+{
+    int count = 0;
+    glGetIntegerv(GL_NUM_EXTENSIONS, &count);
+    for(int i = 0; i < count; i++)
+    {
+        if(strcmp((const char *) glGetStringi(GL_EXTENSIONS, i), name) == 0) return true;
+    }
+    return false;
+}
+
+bool Extensions::version(int major, int minor)
+{
+    return GLVersion.major > major || (GLVersion.major == major && GLVersion.minor >= minor);
+}
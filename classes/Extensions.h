@@ -0,0 +1,132 @@
+#ifndef OPENGLPROJECT_EXTENSIONS_H
+#define OPENGLPROJECT_EXTENSIONS_H
+
+#include <glad/glad.h>
+
+/*
+ * OpenGL functionality beyond the 3.3 profile glad was generated for, loaded at runtime if the driver supports it
+ */
+
+// ARB_get_program_binary (core in 4.1)
+#ifndef GL_PROGRAM_BINARY_RETRIEVABLE_HINT
+#define GL_PROGRAM_BINARY_RETRIEVABLE_HINT 0x8257
+#define GL_PROGRAM_BINARY_LENGTH 0x8741
+#define GL_NUM_PROGRAM_BINARY_FORMATS 0x87FE
+#define GL_PROGRAM_BINARY_FORMATS 0x87FF
+#endif
+
+// KHR_parallel_shader_compile
+#ifndef GL_COMPLETION_STATUS_KHR
+#define GL_MAX_SHADER_COMPILER_THREADS_KHR 0x91B0
+#define GL_COMPLETION_STATUS_KHR 0x91B1
+#endif
+
+// ARB_separate_shader_objects (core in 4.1)
+#ifndef GL_PROGRAM_SEPARABLE
+#define GL_VERTEX_SHADER_BIT 0x00000001
+#define GL_FRAGMENT_SHADER_BIT 0x00000002
+#define GL_PROGRAM_SEPARABLE 0x8258
+#define GL_PROGRAM_PIPELINE_BINDING 0x825A
+#endif
+
+// ARB_draw_indirect (core in 4.0)
+#ifndef GL_DRAW_INDIRECT_BUFFER
+#define GL_DRAW_INDIRECT_BUFFER 0x8F3F
+#endif
+
+// ARB_buffer_storage (core in 4.4)
+#ifndef GL_MAP_PERSISTENT_BIT
+#define GL_MAP_PERSISTENT_BIT 0x0040
+#define GL_MAP_COHERENT_BIT 0x0080
+#define GL_DYNAMIC_STORAGE_BIT 0x0100
+#define GL_CLIENT_STORAGE_BIT 0x0200
+#endif
+
+typedef void (APIENTRYP PFNGLGETPROGRAMBINARYPROC)(GLuint program, GLsizei bufSize, GLsizei *length, GLenum *binaryFormat, void *binary);
+typedef void (APIENTRYP PFNGLPROGRAMBINARYPROC)(GLuint program, GLenum binaryFormat, const void *binary, GLsizei length);
+typedef void (APIENTRYP PFNGLPROGRAMPARAMETERIPROC)(GLuint program, GLenum pname, GLint value);
+typedef void (APIENTRYP PFNGLMAXSHADERCOMPILERTHREADSKHRPROC)(GLuint count);
+typedef void (APIENTRYP PFNGLGENPROGRAMPIPELINESPROC)(GLsizei n, GLuint *pipelines);
+typedef void (APIENTRYP PFNGLDELETEPROGRAMPIPELINESPROC)(GLsizei n, const GLuint *pipelines);
+typedef void (APIENTRYP PFNGLBINDPROGRAMPIPELINEPROC)(GLuint pipeline);
+typedef void (APIENTRYP PFNGLUSEPROGRAMSTAGESPROC)(GLuint pipeline, GLbitfield stages, GLuint program);
+typedef void (APIENTRYP PFNGLPROGRAMUNIFORM1IVPROC)(GLuint program, GLint location, GLsizei count, const GLint *value);
+typedef void (APIENTRYP PFNGLPROGRAMUNIFORM1FVPROC)(GLuint program, GLint location, GLsizei count, const GLfloat *value);
+typedef void (APIENTRYP PFNGLPROGRAMUNIFORM2FVPROC)(GLuint program, GLint location, GLsizei count, const GLfloat *value);
+typedef void (APIENTRYP PFNGLPROGRAMUNIFORM3FVPROC)(GLuint program, GLint location, GLsizei count, const GLfloat *value);
+typedef void (APIENTRYP PFNGLPROGRAMUNIFORM4FVPROC)(GLuint program, GLint location, GLsizei count, const GLfloat *value);
+typedef void (APIENTRYP PFNGLPROGRAMUNIFORMMATRIX4FVPROC)(GLuint program, GLint location, GLsizei count, GLboolean transpose, const GLfloat *value);
+typedef void (APIENTRYP PFNGLMULTIDRAWELEMENTSINDIRECTPROC)(GLenum mode, GLenum type, const void *indirect, GLsizei drawcount, GLsizei stride);
+typedef void (APIENTRYP PFNGLBUFFERSTORAGEPROC)(GLenum target, GLsizeiptr size, const void *data, GLbitfield flags);
+
+extern PFNGLGETPROGRAMBINARYPROC ext_glGetProgramBinary;
+extern PFNGLPROGRAMBINARYPROC ext_glProgramBinary;
+extern PFNGLPROGRAMPARAMETERIPROC ext_glProgramParameteri;
+extern PFNGLMAXSHADERCOMPILERTHREADSKHRPROC ext_glMaxShaderCompilerThreadsKHR;
+extern PFNGLGENPROGRAMPIPELINESPROC ext_glGenProgramPipelines;
+extern PFNGLDELETEPROGRAMPIPELINESPROC ext_glDeleteProgramPipelines;
+extern PFNGLBINDPROGRAMPIPELINEPROC ext_glBindProgramPipeline;
+extern PFNGLUSEPROGRAMSTAGESPROC ext_glUseProgramStages;
+extern PFNGLPROGRAMUNIFORM1IVPROC ext_glProgramUniform1iv;
+extern PFNGLPROGRAMUNIFORM1FVPROC ext_glProgramUniform1fv;
+extern PFNGLPROGRAMUNIFORM2FVPROC ext_glProgramUniform2fv;
+extern PFNGLPROGRAMUNIFORM3FVPROC ext_glProgramUniform3fv;
+extern PFNGLPROGRAMUNIFORM4FVPROC ext_glProgramUniform4fv;
+extern PFNGLPROGRAMUNIFORMMATRIX4FVPROC ext_glProgramUniformMatrix4fv;
+extern PFNGLMULTIDRAWELEMENTSINDIRECTPROC ext_glMultiDrawElementsIndirect;
+extern PFNGLBUFFERSTORAGEPROC ext_glBufferStorage;
+#define glGetProgramBinary ext_glGetProgramBinary
+#define glProgramBinary ext_glProgramBinary
+#define glProgramParameteri ext_glProgramParameteri
+#define glMaxShaderCompilerThreadsKHR ext_glMaxShaderCompilerThreadsKHR
+#define glGenProgramPipelines ext_glGenProgramPipelines
+#define glDeleteProgramPipelines ext_glDeleteProgramPipelines
+#define glBindProgramPipeline ext_glBindProgramPipeline
+#define glUseProgramStages ext_glUseProgramStages
+#define glProgramUniform1iv ext_glProgramUniform1iv
+#define glProgramUniform1fv ext_glProgramUniform1fv
+#define glProgramUniform2fv ext_glProgramUniform2fv
+#define glProgramUniform3fv ext_glProgramUniform3fv
+#define glProgramUniform4fv ext_glProgramUniform4fv
+#define glProgramUniformMatrix4fv ext_glProgramUniformMatrix4fv
+#define glMultiDrawElementsIndirect ext_glMultiDrawElementsIndirect
+#define glBufferStorage ext_glBufferStorage
+
+/**
+ * Records which optional OpenGL features are available
+ */
+class Extensions {
+public:
+    // Whether programs can be saved and loaded as binaries
+    static bool programBinary;
+    // Whether shaders compile on driver threads, with GL_COMPLETION_STATUS_KHR to check them without waiting
+    static bool parallelShaderCompile;
+    // Whether stages can be linked on their own and combined into program pipelines
+    static bool separateShaderObjects;
+    // Whether many indexed draws, each with its own base instance, can be submitted in one call from a buffer
+    static bool multiDrawIndirect;
+    // Whether buffers can be given immutable storage, and so stay mapped while the GPU reads them
+    static bool bufferStorage;
+
+    /**
+     * Loads every optional function the driver supports. Must be called after glad has been loaded
+     * @param load Function to find OpenGL functions with (Use glfwGetProcAddress)
+     */
+    static void load(GLADloadproc load);
+    /**
+     * Checks whether the driver reports an extension
+     * @param name Name of the extension, such as GL_ARB_get_program_binary
+     * @return True if the extension is supported
+     */
+    static bool has(const char *name);
+    /**
+     * Checks whether the context is at least the given OpenGL version
+     * @param major Major version
+     * @param minor Minor version
+     * @return True if the context version is the same or newer
+     */
+    static bool version(int major, int minor);
+};
+
+
+#endif //OPENGLPROJECT_EXTENSIONS_H
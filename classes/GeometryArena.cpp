@@ -0,0 +1,341 @@
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+#include "GeometryArena.h"
+#include "Hash.h"
+#include "StreamBuffer.h"
+
+std::map<uint64_t, std::unique_ptr<GeometryArena>> GeometryArena::arenas;
+
+// Size new buffers start at, in vertices and indices, so small meshes don't each grow them
+static const size_t MINIMUM_CAPACITY = 4096;
+
+GeometryArena &GeometryArena::get(const VertexLayout &layout, GLenum indexType)
+{
+    uint64_t key = fnv1a((const char *) &layout.stride, sizeof(layout.stride));
+    key = fnv1a((const char *) &indexType, sizeof(indexType), key);
+    for(const VertexAttribute &attribute : layout.attributes)
+    {
+        uint32_t fields[6] = {attribute.location, (uint32_t) attribute.size, attribute.type, attribute.offset,
+                attribute.normalized, attribute.divisor};
+        key = fnv1a((const char *) fields, sizeof(fields), key);
+    }
+
+    std::unique_ptr<GeometryArena> &arena = arenas[key];
+    if(!arena) arena.reset(new GeometryArena(layout, indexType));
+    return *arena;
+}
+
+void GeometryArena::report()
+{
+    for(const auto &entry : arenas)
+    {
+        const GeometryArena &arena = *entry.second;
+        Stats stats = arena.getStats();
+        std::cout << "INFO::GEOMETRY_ARENA " << arena.layout.stride << " byte vertices, "
+                  << (arena.indexType == GL_UNSIGNED_SHORT ? 16 : 32) << " bit indices: " << stats.allocations
+                  << " meshes, vertices " << stats.vertexBytesUsed << "/" << stats.vertexBytesCapacity
+                  << " bytes (" << stats.vertexFragmentation * 100 << "% fragmented), indices "
+                  << stats.indexBytesUsed << "/" << stats.indexBytesCapacity
+                  << " bytes (" << stats.indexFragmentation * 100 << "% fragmented)" << std::endl;
+    }
+}
+
+void GeometryArena::deleteAll()
+{
+    arenas.clear();
+}
+
+GeometryArena::GeometryArena(const VertexLayout &layout, GLenum indexType)
+        : layout(layout), indexType(indexType), indexSize(indexType == GL_UNSIGNED_SHORT ? 2 : 4)
+{
+    glGenVertexArrays(1, &VAO);
+    glGenBuffers(1, &instanceTransforms);
+    glGenBuffers(1, &instanceColours);
+    glBindVertexArray(VAO);
+
+    // Each column of the transform is its own attribute, advancing once per instance
+    for(unsigned int column = 0; column < 4; column++)
+    {
+        VertexAttribute attribute{INSTANCE_TRANSFORM_LOCATION + column, 4, GL_FLOAT,
+                (unsigned int) (column * sizeof(glm::vec4)), false, 1};
+        glVertexAttribDivisor(attribute.location, 1);
+        glEnableVertexAttribArray(attribute.location);
+        this->layout.attributes.push_back(attribute);
+    }
+    glVertexAttribDivisor(INSTANCE_COLOUR_LOCATION, 1);
+    this->layout.attributes.push_back(VertexAttribute{INSTANCE_COLOUR_LOCATION, 4, GL_FLOAT, 0, false, 1});
+    setInstanceLayout(instanceTransforms, 0, instanceColours, 0);
+
+    glBindVertexArray(0);
+}
+
+GeometryArena::~GeometryArena()
+{
+    glDeleteVertexArrays(1, &VAO);
+    glDeleteBuffers(1, &VBO);
+    glDeleteBuffers(1, &EBO);
+    glDeleteBuffers(1, &instanceTransforms);
+    glDeleteBuffers(1, &instanceColours);
+}
+
+unsigned int GeometryArena::allocate(const void *vertices, size_t vertexCount, const void *indices, size_t indexCount)
+{
+    size_t firstVertex, firstIndex;
+    bool vertexFits = vertexRanges.allocate(vertexCount, &firstVertex);
+    bool indexFits = indexRanges.allocate(indexCount, &firstIndex);
+    if(!vertexFits || !indexFits)
+    {
+        if(vertexFits) vertexRanges.free(firstVertex, vertexCount);
+        if(indexFits) indexRanges.free(firstIndex, indexCount);
+
+        // Compacting is enough if the free space is only too split up, otherwise the buffers double until it fits
+        size_t vertexCapacity = vertexRanges.getCapacity();
+        size_t indexCapacity = indexRanges.getCapacity();
+        bool pack = vertexCapacity - vertexRanges.getUsed() >= vertexCount &&
+                indexCapacity - indexRanges.getUsed() >= indexCount;
+        if(!pack)
+        {
+            vertexCapacity = std::max(vertexCapacity, MINIMUM_CAPACITY);
+            indexCapacity = std::max(indexCapacity, MINIMUM_CAPACITY);
+            while(vertexCapacity < vertexRanges.getUsed() + vertexCount) vertexCapacity *= 2;
+            while(indexCapacity < indexRanges.getUsed() + indexCount) indexCapacity *= 2;
+            // Packing while growing means the new space is one range whatever was freed before
+            pack = vertexRanges.getFragmentation() > 0 || indexRanges.getFragmentation() > 0;
+        }
+        rebuild(vertexCapacity, indexCapacity, pack);
+        vertexRanges.allocate(vertexCount, &firstVertex);
+        indexRanges.allocate(indexCount, &firstIndex);
+    }
+
+    // An empty mesh fits a new arena without its buffers ever being made, so there's nothing to write to
+    if(vertexCount)
+    {
+        glBindBuffer(GL_ARRAY_BUFFER, VBO);
+        glBufferSubData(GL_ARRAY_BUFFER, firstVertex * layout.stride, vertexCount * layout.stride, vertices);
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+    }
+    if(indexCount)
+    {
+        // The element buffer binding belongs to the VAO, so it's bound to write the indices
+        glBindVertexArray(VAO);
+        glBufferSubData(GL_ELEMENT_ARRAY_BUFFER, firstIndex * indexSize, indexCount * indexSize, indices);
+        glBindVertexArray(0);
+    }
+
+    unsigned int handle;
+    if(freeHandles.empty())
+    {
+        handle = (unsigned int) allocations.size();
+        allocations.emplace_back();
+    }
+    else
+    {
+        handle = freeHandles.back();
+        freeHandles.pop_back();
+    }
+    allocations[handle] = Allocation{firstVertex, vertexCount, firstIndex, indexCount, true};
+    return handle;
+}
+
+void GeometryArena::free(unsigned int allocation)
+{
+    Allocation &freed = allocations[allocation];
+    if(!freed.live) return;
+    vertexRanges.free(freed.firstVertex, freed.vertexCount);
+    indexRanges.free(freed.firstIndex, freed.indexCount);
+    freed.live = false;
+    freeHandles.push_back(allocation);
+}
+
+void GeometryArena::compact()
+{
+    rebuild(vertexRanges.getCapacity(), indexRanges.getCapacity(), true);
+}
+
+void GeometryArena::rebuild(size_t vertexCapacity, size_t indexCapacity, bool pack)
+{
+    unsigned int vertexBuffer, indexBuffer;
+    glGenBuffers(1, &vertexBuffer);
+    glGenBuffers(1, &indexBuffer);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, vertexBuffer);
+    glBufferData(GL_COPY_WRITE_BUFFER, vertexCapacity * layout.stride, nullptr, GL_STATIC_DRAW);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, indexBuffer);
+    glBufferData(GL_COPY_WRITE_BUFFER, indexCapacity * indexSize, nullptr, GL_STATIC_DRAW);
+
+    if(pack)
+    {
+        // Meshes keep their order, so each is copied to a lower or equal offset
+        std::vector<Allocation *> live;
+        for(Allocation &allocation : allocations)
+        {
+            if(allocation.live) live.push_back(&allocation);
+        }
+        std::sort(live.begin(), live.end(), [](const Allocation *a, const Allocation *b) { return a->firstVertex < b->firstVertex; });
+
+        size_t vertexEnd = 0, indexEnd = 0;
+        for(Allocation *allocation : live)
+        {
+            if(allocation->vertexCount)
+            {
+                glBindBuffer(GL_COPY_READ_BUFFER, VBO);
+                glBindBuffer(GL_COPY_WRITE_BUFFER, vertexBuffer);
+                glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, allocation->firstVertex * layout.stride,
+                        vertexEnd * layout.stride, allocation->vertexCount * layout.stride);
+            }
+            if(allocation->indexCount)
+            {
+                glBindBuffer(GL_COPY_READ_BUFFER, EBO);
+                glBindBuffer(GL_COPY_WRITE_BUFFER, indexBuffer);
+                glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, allocation->firstIndex * indexSize,
+                        indexEnd * indexSize, allocation->indexCount * indexSize);
+            }
+            allocation->firstVertex = vertexEnd;
+            allocation->firstIndex = indexEnd;
+            vertexEnd += allocation->vertexCount;
+            indexEnd += allocation->indexCount;
+        }
+        vertexRanges.reset(vertexEnd, vertexCapacity);
+        indexRanges.reset(indexEnd, indexCapacity);
+    }
+    else
+    {
+        if(vertexRanges.getCapacity())
+        {
+            glBindBuffer(GL_COPY_READ_BUFFER, VBO);
+            glBindBuffer(GL_COPY_WRITE_BUFFER, vertexBuffer);
+            glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0, vertexRanges.getCapacity() * layout.stride);
+        }
+        if(indexRanges.getCapacity())
+        {
+            glBindBuffer(GL_COPY_READ_BUFFER, EBO);
+            glBindBuffer(GL_COPY_WRITE_BUFFER, indexBuffer);
+            glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0, indexRanges.getCapacity() * indexSize);
+        }
+        vertexRanges.grow(vertexCapacity);
+        indexRanges.grow(indexCapacity);
+    }
+    glBindBuffer(GL_COPY_READ_BUFFER, 0);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+
+    glDeleteBuffers(1, &VBO);
+    glDeleteBuffers(1, &EBO);
+    VBO = vertexBuffer;
+    EBO = indexBuffer;
+
+    glBindVertexArray(VAO);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
+    glBindBuffer(GL_ARRAY_BUFFER, VBO);
+    setVertexLayout();
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    glBindVertexArray(0);
+}
+
+void GeometryArena::setVertexLayout() const
+{
+    for(const VertexAttribute &attribute : layout.attributes)
+    {
+        // The per-instance attributes read from their own buffers
+        if(attribute.divisor) continue;
+        // Tells OpenGL how to interpret the vertex buffer data
+        // Index, Size, Type, Normalized, Stride, Pointer
+        glVertexAttribPointer(attribute.location, attribute.size, attribute.type, attribute.normalized ? GL_TRUE : GL_FALSE,
+                layout.stride, (void *) (size_t) attribute.offset);
+        // Enables a generic vertex attribute at the given index
+        glEnableVertexAttribArray(attribute.location);
+    }
+}
+
+void GeometryArena::setInstanceLayout(unsigned int transformBuffer, size_t transformOffset, unsigned int colourBuffer,
+        size_t colourOffset) const
+{
+    glBindBuffer(GL_ARRAY_BUFFER, transformBuffer);
+    for(unsigned int column = 0; column < 4; column++)
+    {
+        glVertexAttribPointer(INSTANCE_TRANSFORM_LOCATION + column, 4, GL_FLOAT, GL_FALSE, sizeof(glm::mat4),
+                (void *) (transformOffset + column * sizeof(glm::vec4)));
+    }
+    glBindBuffer(GL_ARRAY_BUFFER, colourBuffer);
+    glVertexAttribPointer(INSTANCE_COLOUR_LOCATION, 4, GL_FLOAT, GL_FALSE, sizeof(glm::vec4), (void *) colourOffset);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+int GeometryArena::getBaseVertex(unsigned int allocation) const
+{
+    return (int) allocations[allocation].firstVertex;
+}
+
+size_t GeometryArena::getIndexOffset(unsigned int allocation) const
+{
+    return allocations[allocation].firstIndex * indexSize;
+}
+
+size_t GeometryArena::getFirstIndex(unsigned int allocation) const
+{
+    return allocations[allocation].firstIndex;
+}
+
+void GeometryArena::bind() const
+{
+    glBindVertexArray(VAO);
+}
+
+void GeometryArena::setInstances(const glm::mat4 *transforms, size_t count, const glm::vec4 *colours)
+{
+    glBindVertexArray(VAO);
+    size_t transformBytes = count * sizeof(glm::mat4);
+    size_t colourBytes = colours ? count * sizeof(glm::vec4) : 0;
+    if(StreamBuffer::active)
+    {
+        // Both go in one write, so a resize can't leave the transforms in a replaced buffer
+        size_t offset;
+        auto *data = (unsigned char *) StreamBuffer::active->map(transformBytes + colourBytes, sizeof(glm::vec4), &offset);
+        memcpy(data, transforms, transformBytes);
+        if(colours) memcpy(data + transformBytes, colours, colourBytes);
+        StreamBuffer::active->unmap();
+        unsigned int buffer = StreamBuffer::active->getBuffer();
+        setInstanceLayout(buffer, offset, buffer, offset + transformBytes);
+    }
+    else
+    {
+        // Orphans the previous contents, so the driver needn't wait for draws still reading them
+        glBindBuffer(GL_ARRAY_BUFFER, instanceTransforms);
+        glBufferData(GL_ARRAY_BUFFER, transformBytes, nullptr, GL_STREAM_DRAW);
+        glBufferSubData(GL_ARRAY_BUFFER, 0, transformBytes, transforms);
+        if(colours)
+        {
+            glBindBuffer(GL_ARRAY_BUFFER, instanceColours);
+            glBufferData(GL_ARRAY_BUFFER, colourBytes, nullptr, GL_STREAM_DRAW);
+            glBufferSubData(GL_ARRAY_BUFFER, 0, colourBytes, colours);
+        }
+        setInstanceLayout(instanceTransforms, 0, instanceColours, 0);
+    }
+    if(colours)
+    {
+        glEnableVertexAttribArray(INSTANCE_COLOUR_LOCATION);
+    }
+    else
+    {
+        // A disabled attribute reads the current value instead, which isn't part of the VAO so is set every draw
+        glDisableVertexAttribArray(INSTANCE_COLOUR_LOCATION);
+        glVertexAttrib4f(INSTANCE_COLOUR_LOCATION, 1.0f, 1.0f, 1.0f, 1.0f);
+    }
+}
+
+const VertexLayout &GeometryArena::getLayout() const
+{
+    return layout;
+}
+
+GLenum GeometryArena::getIndexType() const
+{
+    return indexType;
+}
+
+GeometryArena::Stats GeometryArena::getStats() const
+{
+    return Stats{allocations.size() - freeHandles.size(),
+            vertexRanges.getUsed() * layout.stride, vertexRanges.getCapacity() * layout.stride,
+            indexRanges.getUsed() * indexSize, indexRanges.getCapacity() * indexSize,
+            vertexRanges.getFragmentation(), indexRanges.getFragmentation()};
+}
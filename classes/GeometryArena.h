@@ -0,0 +1,178 @@
+#ifndef OPENGLPROJECT_GEOMETRYARENA_H
+#define OPENGLPROJECT_GEOMETRYARENA_H
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include <map>
+#include <memory>
+#include <vector>
+#include "RangeAllocator.h"
+#include "VertexLayout.h"
+
+// Locations of the per-instance attributes read by shaders built with INSTANCED. The transform is a mat4, so takes
+// four locations
+const unsigned int INSTANCE_TRANSFORM_LOCATION = 3;
+const unsigned int INSTANCE_COLOUR_LOCATION = 7;
+
+/**
+ * One vertex buffer and one index buffer shared by every mesh of a vertex format, read through one VAO
+ *
+ * Meshes are sub-allocated from the buffers and drawn by their base vertex and first index, so drawing different
+ * meshes of the same format needs no VAO or buffer changes. The buffers grow as needed, and are compacted when
+ * freed meshes leave the free space too split up to use
+ */
+class GeometryArena {
+public:
+    /**
+     * How full an arena is
+     */
+    struct Stats {
+        size_t allocations;
+        size_t vertexBytesUsed;
+        size_t vertexBytesCapacity;
+        size_t indexBytesUsed;
+        size_t indexBytesCapacity;
+        // Fraction of the free space not in the largest free range, for each buffer
+        double vertexFragmentation;
+        double indexFragmentation;
+    };
+
+    /**
+     * Gets the arena for a vertex format, creating it if none has been used yet
+     * @param layout Layout of each vertex
+     * @param indexType GL_UNSIGNED_SHORT or GL_UNSIGNED_INT
+     * @return Arena holding meshes of that format
+     */
+    static GeometryArena &get(const VertexLayout &layout, GLenum indexType);
+    /**
+     * Prints how much of each arena is used and how fragmented it is
+     */
+    static void report();
+    /**
+     * Deletes every arena. Models using them must be deleted first
+     */
+    static void deleteAll();
+
+    GeometryArena(const GeometryArena &) = delete;
+    GeometryArena &operator=(const GeometryArena &) = delete;
+    ~GeometryArena();
+
+    /**
+     * Copies a mesh into the arena, growing or compacting it if there's no free range large enough
+     * @param vertices Vertex data, in the arena's layout
+     * @param vertexCount Number of vertices
+     * @param indices Index data, of the arena's index type and relative to the first vertex of the mesh
+     * @param indexCount Number of indices
+     * @return Handle to the allocation
+     */
+    unsigned int allocate(const void *vertices, size_t vertexCount, const void *indices, size_t indexCount);
+    /**
+     * Frees the space of a mesh for reuse
+     * @param allocation Handle from allocate
+     */
+    void free(unsigned int allocation);
+    /**
+     * Moves every mesh to the start of the buffers, merging the free space into one range
+     */
+    void compact();
+
+    /**
+     * Gets where a mesh's vertices start, to pass as the base vertex when drawing
+     * @param allocation Handle from allocate
+     * @return Index of the mesh's first vertex in the vertex buffer
+     */
+    int getBaseVertex(unsigned int allocation) const;
+    /**
+     * Gets where a mesh's indices start in the index buffer
+     * @param allocation Handle from allocate
+     * @return Offset of the mesh's first index in bytes
+     */
+    size_t getIndexOffset(unsigned int allocation) const;
+    /**
+     * Gets where a mesh's indices start, to pass as the first index of an indirect draw
+     * @param allocation Handle from allocate
+     * @return Index of the mesh's first index in the index buffer
+     */
+    size_t getFirstIndex(unsigned int allocation) const;
+    /**
+     * Binds the VAO
+     */
+    void bind() const;
+    /**
+     * Replaces the per-instance attributes read by instanced draws, writing them to the active StreamBuffer if there
+     * is one. Binds the VAO
+     * @param transforms Model matrix of each instance
+     * @param count Number of instances
+     * @param colours Colour of each instance, or nullptr for every instance to be white
+     */
+    void setInstances(const glm::mat4 *transforms, size_t count, const glm::vec4 *colours);
+
+    /**
+     * Gets the layout of each vertex, including the per-instance attributes
+     * @return Vertex layout
+     */
+    const VertexLayout &getLayout() const;
+    GLenum getIndexType() const;
+    Stats getStats() const;
+
+private:
+    /**
+     * Where a mesh is in the buffers
+     */
+    struct Allocation {
+        size_t firstVertex;
+        size_t vertexCount;
+        size_t firstIndex;
+        size_t indexCount;
+        bool live;
+    };
+
+    // Arenas by a hash of their vertex layout and index type
+    static std::map<uint64_t, std::unique_ptr<GeometryArena>> arenas;
+
+    VertexLayout layout;
+    GLenum indexType;
+    size_t indexSize;
+    unsigned int VAO = 0;
+    unsigned int VBO = 0;
+    unsigned int EBO = 0;
+    unsigned int instanceTransforms = 0;
+    unsigned int instanceColours = 0;
+    // Free ranges of each buffer, in vertices and indices
+    RangeAllocator vertexRanges;
+    RangeAllocator indexRanges;
+    std::vector<Allocation> allocations;
+    // Handles no longer in use, to reuse
+    std::vector<unsigned int> freeHandles;
+
+    /**
+     * Creates an empty arena with its VAO
+     * @param layout Layout of each vertex
+     * @param indexType GL_UNSIGNED_SHORT or GL_UNSIGNED_INT
+     */
+    GeometryArena(const VertexLayout &layout, GLenum indexType);
+    /**
+     * Replaces the buffers with new ones, copying the meshes across and pointing the VAO at them
+     * @param vertexCapacity Size of the new vertex buffer in vertices
+     * @param indexCapacity Size of the new index buffer in indices
+     * @param pack Whether to move every mesh to the start of the buffers rather than keep their offsets
+     */
+    void rebuild(size_t vertexCapacity, size_t indexCapacity, bool pack);
+    /**
+     * Points the VAO's vertex attributes at the vertex buffer. The VAO must be bound
+     */
+    void setVertexLayout() const;
+    /**
+     * Points the VAO's per-instance attributes at where their data was written. The VAO must be bound
+     * @param transformBuffer Buffer holding the transforms
+     * @param transformOffset Offset of the first transform in bytes
+     * @param colourBuffer Buffer holding the colours
+     * @param colourOffset Offset of the first colour in bytes
+     */
+    void setInstanceLayout(unsigned int transformBuffer, size_t transformOffset, unsigned int colourBuffer,
+            size_t colourOffset) const;
+};
+
+
+#endif //OPENGLPROJECT_GEOMETRYARENA_H
@@ -0,0 +1,673 @@
+#include <algorithm>
+#include <cstdint>
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/quaternion.hpp>
+#include <glm/gtc/type_ptr.hpp>
+#include "GltfLoader.h"
+#include "MappedFile.h"
+
+// Identifies a binary glTF file, "glTF" read as a little endian integer
+static const uint32_t GLB_MAGIC = 0x46546C67;
+// Types of the chunks of a binary glTF file, "JSON" and "BIN"
+static const uint32_t GLB_JSON = 0x4E4F534A;
+static const uint32_t GLB_BIN = 0x004E4942;
+// Deepest nesting of JSON values and nodes followed, so a malicious file can't overflow the stack
+static const int GLTF_MAX_DEPTH = 64;
+
+/**
+ * A value of the file's JSON. Objects keep their keys beside their values, in the order written
+ */
+struct JsonValue {
+    enum Type {NONE, BOOLEAN, NUMBER, STRING, ARRAY, OBJECT};
+    Type type = NONE;
+    double number = 0;
+    std::string string;
+    std::vector<std::string> keys;
+    std::vector<JsonValue> elements;
+
+    /**
+     * Gets a member of an object
+     * @param key Name of the member
+     * @return The member, or a value of type NONE if this isn't an object or has no such member
+     */
+    const JsonValue &operator[](const char *key) const;
+    /**
+     * Gets an element of an array
+     * @param index Index of the element
+     * @return The element, or a value of type NONE if this isn't an array or is too short
+     */
+    const JsonValue &operator[](size_t index) const;
+    /**
+     * Gets the number of elements of an array
+     * @return Number of elements, 0 if this isn't an array
+     */
+    size_t size() const;
+    /**
+     * Gets the value as a number
+     * @param fallback Number to use if this isn't one
+     * @return The number or fallback
+     */
+    double numberOr(double fallback) const;
+    /**
+     * Gets the value as a count, index or offset
+     * @param fallback Size to use if this isn't a number
+     * @return The number, fallback, or SIZE_MAX if the number is negative or too large, so it fails any range check
+     */
+    size_t sizeOr(size_t fallback) const;
+};
+
+static const JsonValue JSON_NONE;
+
+const JsonValue &JsonValue::operator[](const char *key) const
+{
+    if(type != OBJECT) return JSON_NONE;
+    for(size_t i = 0; i < keys.size(); i++)
+    {
+        if(keys[i] == key) return elements[i];
+    }
+    return JSON_NONE;
+}
+
+const JsonValue &JsonValue::operator[](size_t index) const
+{
+    return type == ARRAY && index < elements.size() ? elements[index] : JSON_NONE;
+}
+
+size_t JsonValue::size() const
+{
+    return type == ARRAY ? elements.size() : 0;
+}
+
+double JsonValue::numberOr(double fallback) const
+{
+    return type == NUMBER ? number : fallback;
+}
+
+size_t JsonValue::sizeOr(size_t fallback) const
+{
+    if(type != NUMBER) return fallback;
+    // Beyond 2^53 a double no longer holds every integer
+    return number >= 0 && number <= 9007199254740992.0 ? (size_t) number : SIZE_MAX;
+}
+
+/**
+ * Skips JSON whitespace
+ * @param text Current position
+ * @return First character that isn't whitespace
+ */
+static const char *skipWhitespace(const char *text)
+{
+    while(*text == ' ' || *text == '\t' || *text == '\n' || *text == '\r') text++;
+    return text;
+}
+
+/**
+ * Reads a JSON string, decoding its escapes
+ * @param text Opening quote, moved past the closing quote
+ * @param string Location to store the string
+ * @return True if the string was closed
+ */
+static bool parseString(const char *&text, std::string &string)
+{
+    const char *cursor = text + 1;
+    for(; *cursor && *cursor != '"'; cursor++)
+    {
+        if(*cursor != '\\')
+        {
+            string += *cursor;
+            continue;
+        }
+        cursor++;
+        switch(*cursor)
+        {
+            case 'b': string += '\b'; break;
+            case 'f': string += '\f'; break;
+            case 'n': string += '\n'; break;
+            case 'r': string += '\r'; break;
+            case 't': string += '\t'; break;
+            case 'u':
+            {
+                // Written as UTF-8. Surrogate pairs are left as two characters, as names are all that's read
+                char digits[5] = {};
+                for(int i = 0; i < 4; i++)
+                {
+                    if(!isxdigit((unsigned char) cursor[1])) return false;
+                    digits[i] = *++cursor;
+                }
+                auto code = (unsigned) strtoul(digits, nullptr, 16);
+                if(code < 0x80) string += (char) code;
+                else if(code < 0x800) string += {(char) (0xC0 | code >> 6), (char) (0x80 | (code & 0x3F))};
+                else string += {(char) (0xE0 | code >> 12), (char) (0x80 | (code >> 6 & 0x3F)),
+                            (char) (0x80 | (code & 0x3F))};
+                break;
+            }
+            case '\0': return false;
+            default: string += *cursor;
+        }
+    }
+    if(*cursor != '"') return false;
+    text = cursor + 1;
+    return true;
+}
+
+/**
+ * Reads a JSON value
+ * @param text Current position, within a null terminated string, moved past the value
+ * @param value Location to store the value
+ * @param depth Number of arrays and objects the value is within
+ * @return True if the value was valid
+ */
+static bool parseValue(const char *&text, JsonValue &value, int depth)
+{
+    text = skipWhitespace(text);
+    if(*text == '{' || *text == '[')
+    {
+        if(depth >= GLTF_MAX_DEPTH) return false;
+        bool object = *text == '{';
+        char close = object ? '}' : ']';
+        value.type = object ? JsonValue::OBJECT : JsonValue::ARRAY;
+        text = skipWhitespace(text + 1);
+        if(*text == close)
+        {
+            text++;
+            return true;
+        }
+        while(true)
+        {
+            if(object)
+            {
+                value.keys.emplace_back();
+                if(*text != '"' || !parseString(text, value.keys.back())) return false;
+                text = skipWhitespace(text);
+                if(*text++ != ':') return false;
+            }
+            value.elements.emplace_back();
+            if(!parseValue(text, value.elements.back(), depth + 1)) return false;
+            text = skipWhitespace(text);
+            if(*text == close)
+            {
+                text++;
+                return true;
+            }
+            if(*text++ != ',') return false;
+            text = skipWhitespace(text);
+        }
+    }
+    if(*text == '"')
+    {
+        value.type = JsonValue::STRING;
+        return parseString(text, value.string);
+    }
+    for(const char *word : {"true", "false", "null"})
+    {
+        if(strncmp(text, word, strlen(word)) == 0)
+        {
+            value.type = word[0] == 'n' ? JsonValue::NONE : JsonValue::BOOLEAN;
+            value.number = word[0] == 't';
+            text += strlen(word);
+            return true;
+        }
+    }
+    char *after;
+    value.number = strtod(text, &after);
+    value.type = JsonValue::NUMBER;
+    if(after == text) return false;
+    text = after;
+    return true;
+}
+
+/**
+ * Data of an accessor, within the file's binary chunk
+ */
+struct GltfAccessor {
+    const unsigned char *data = nullptr;
+    size_t count = 0;
+    // Bytes between the starts of consecutive elements
+    size_t stride = 0;
+    int components = 0;
+    int componentType = 0;
+    bool normalised = false;
+};
+
+/**
+ * Gets the size of a component
+ * @param componentType glTF component type, which are the GL type enums
+ * @return Size in bytes, 0 if it isn't a type glTF allows
+ */
+static size_t componentSize(int componentType)
+{
+    switch(componentType)
+    {
+        case GL_BYTE: case GL_UNSIGNED_BYTE: return 1;
+        case GL_SHORT: case GL_UNSIGNED_SHORT: return 2;
+        case GL_UNSIGNED_INT: case GL_FLOAT: return 4;
+        default: return 0;
+    }
+}
+
+/**
+ * Finds an accessor's data, checking it lies within the binary chunk
+ * @param gltf Root of the JSON
+ * @param index Index of the accessor
+ * @param components Number of components each element must have
+ * @param bin Binary chunk
+ * @param binSize Size of the binary chunk
+ * @param accessor Location to store the accessor
+ * @return True if the accessor can be read
+ */
+static bool findAccessor(const JsonValue &gltf, const JsonValue &index, int components, const unsigned char *bin,
+        size_t binSize, GltfAccessor &accessor)
+{
+    const JsonValue &json = gltf["accessors"][index.sizeOr(SIZE_MAX)];
+    const JsonValue &view = gltf["bufferViews"][json["bufferView"].sizeOr(SIZE_MAX)];
+    const char *types[] = {"SCALAR", "VEC2", "VEC3", "VEC4"};
+    // Data outside the file, or only sparse, isn't read
+    if(json.type != JsonValue::OBJECT || view.type != JsonValue::OBJECT || json["sparse"].type != JsonValue::NONE ||
+            view["buffer"].numberOr(0) != 0 || gltf["buffers"][(size_t) 0]["uri"].type != JsonValue::NONE ||
+            json["type"].string != types[components - 1])
+    {
+        return false;
+    }
+
+    accessor.count = json["count"].sizeOr(0);
+    accessor.components = components;
+    accessor.componentType = (int) json["componentType"].numberOr(0);
+    accessor.normalised = json["normalized"].type == JsonValue::BOOLEAN && json["normalized"].number != 0;
+    size_t elementSize = componentSize(accessor.componentType) * components;
+    accessor.stride = view["byteStride"].sizeOr(elementSize);
+    auto viewOffset = view["byteOffset"].sizeOr(0);
+    auto viewLength = view["byteLength"].sizeOr(0);
+    auto offset = json["byteOffset"].sizeOr(0);
+    // Each range is checked against what's left before it, so a corrupt count can't overflow the sum
+    bool fits = elementSize != 0 && accessor.stride >= elementSize && viewOffset <= binSize &&
+            viewLength <= binSize - viewOffset && offset <= viewLength && elementSize <= viewLength - offset &&
+            (accessor.count == 0 || accessor.count - 1 <= (viewLength - offset - elementSize) / accessor.stride);
+    accessor.data = bin + viewOffset + offset;
+    return fits && accessor.count != 0;
+}
+
+/**
+ * Reads a component of an element, converting normalised integers to their range
+ * @param accessor Accessor to read
+ * @param element Index of the element
+ * @param component Index of the component
+ * @return Component's value
+ */
+static float readComponent(const GltfAccessor &accessor, size_t element, int component)
+{
+    const unsigned char *data = accessor.data + element * accessor.stride;
+    switch(accessor.componentType)
+    {
+        case GL_FLOAT:
+        {
+            float value;
+            memcpy(&value, data + component * 4, 4);
+            return value;
+        }
+        case GL_UNSIGNED_BYTE:
+            return accessor.normalised ? data[component] / 255.0f : data[component];
+        case GL_BYTE:
+        {
+            auto value = (float) (int8_t) data[component];
+            return accessor.normalised ? std::max(value / 127.0f, -1.0f) : value;
+        }
+        case GL_UNSIGNED_SHORT:
+        {
+            uint16_t value;
+            memcpy(&value, data + component * 2, 2);
+            return accessor.normalised ? value / 65535.0f : value;
+        }
+        case GL_SHORT:
+        {
+            int16_t value;
+            memcpy(&value, data + component * 2, 2);
+            return accessor.normalised ? std::max(value / 32767.0f, -1.0f) : value;
+        }
+        default:
+            return 0;
+    }
+}
+
+/**
+ * Reads an index
+ * @param accessor Accessor of unsigned integers to read
+ * @param element Index of the element
+ * @return The index
+ */
+static uint32_t readIndex(const GltfAccessor &accessor, size_t element)
+{
+    const unsigned char *data = accessor.data + element * accessor.stride;
+    if(accessor.componentType == GL_UNSIGNED_BYTE) return data[0];
+    uint32_t value = 0;
+    memcpy(&value, data, accessor.componentType == GL_UNSIGNED_SHORT ? 2 : 4);
+    return value;
+}
+
+/**
+ * A triangle primitive to read, placed by its node
+ */
+struct GltfPrimitive {
+    GltfAccessor positions, normals, textures, indices;
+    glm::mat4 transform;
+    glm::mat3 normalTransform;
+    // Set when the transform mirrors the primitive, so its triangles are wound the other way
+    bool mirrored;
+    size_t triangleCount;
+    // Cleared if the primitive isn't a triangle list or its data can't be read
+    bool readable = false;
+    // Set by the jobs checking the indices if one is out of range
+    std::atomic<bool> invalid{false};
+    // Where the primitive's vertices and indices start in the mesh
+    size_t vertexBase = 0, indexBase = 0;
+
+    /**
+     * Gets the index of a triangle's corner
+     * @param corner Index of the corner, three per triangle
+     * @return Index of its vertex, with the winding reversed if the primitive is mirrored
+     */
+    uint32_t corner(size_t corner) const
+    {
+        size_t within = corner % 3;
+        if(mirrored && within == 1) corner++;
+        else if(mirrored && within == 2) corner--;
+        return indices.data ? readIndex(indices, corner) : (uint32_t) corner;
+    }
+    /**
+     * Reads a vertex, placed by the primitive's transform
+     * @param vertex Index of the vertex
+     * @param out Location to store the vertex's 8 floats. Its normal is only stored if the primitive has normals
+     */
+    void read(uint32_t vertex, float *out) const
+    {
+        glm::vec4 position(readComponent(positions, vertex, 0), readComponent(positions, vertex, 1),
+                readComponent(positions, vertex, 2), 1.0f);
+        position = transform * position;
+        out[0] = position.x, out[1] = position.y, out[2] = position.z;
+        if(normals.data)
+        {
+            glm::vec3 normal = normalTransform * glm::vec3(readComponent(normals, vertex, 0),
+                    readComponent(normals, vertex, 1), readComponent(normals, vertex, 2));
+            if(glm::length(normal) > 0) normal = glm::normalize(normal);
+            out[3] = normal.x, out[4] = normal.y, out[5] = normal.z;
+        }
+        out[6] = textures.data ? readComponent(textures, vertex, 0) : 0.0f;
+        out[7] = textures.data ? 1.0f - readComponent(textures, vertex, 1) : 0.0f;
+    }
+};
+
+/**
+ * A share of a primitive's indices or vertices, run on one thread
+ */
+struct GltfJob {
+    GltfPrimitive *primitive;
+    size_t begin;
+    size_t end;
+};
+
+/**
+ * Gets the transform of a node relative to its parent
+ * @param node Node in the JSON
+ * @return Its matrix, or its translation, rotation and scale combined
+ */
+static glm::mat4 nodeTransform(const JsonValue &node)
+{
+    const JsonValue &matrix = node["matrix"];
+    if(matrix.size() == 16)
+    {
+        float values[16];
+        for(size_t i = 0; i < 16; i++) values[i] = (float) matrix[i].numberOr(0);
+        // glTF matrices are column major, as glm's are
+        return glm::make_mat4(values);
+    }
+    const JsonValue &t = node["translation"], &r = node["rotation"], &s = node["scale"];
+    glm::vec3 translation(t[(size_t) 0].numberOr(0), t[1].numberOr(0), t[2].numberOr(0));
+    glm::quat rotation((float) r[3].numberOr(1), (float) r[(size_t) 0].numberOr(0), (float) r[1].numberOr(0),
+            (float) r[2].numberOr(0));
+    glm::vec3 scale(s[(size_t) 0].numberOr(1), s[1].numberOr(1), s[2].numberOr(1));
+    glm::mat4 transform = glm::translate(glm::mat4(1.0f), translation) * glm::mat4_cast(rotation);
+    return glm::scale(transform, scale);
+}
+
+/**
+ * Collects the triangle primitives of a node and its children
+ * @param gltf Root of the JSON
+ * @param index Index of the node
+ * @param parent Transform of the node's parent
+ * @param depth Number of nodes above the node
+ * @param visited Whether each node has been collected already
+ * @param found Location to add the primitives' meshes and transforms to
+ */
+static void collectNode(const JsonValue &gltf, const JsonValue &index, const glm::mat4 &parent, int depth,
+        std::vector<bool> &visited, std::vector<std::pair<const JsonValue *, glm::mat4>> &found)
+{
+    size_t nodeIndex = index.sizeOr(SIZE_MAX);
+    const JsonValue &node = gltf["nodes"][nodeIndex];
+    // Nodes form trees, so one reached again is only ever from a malformed file
+    if(node.type != JsonValue::OBJECT || depth >= GLTF_MAX_DEPTH || visited[nodeIndex]) return;
+    visited[nodeIndex] = true;
+    glm::mat4 transform = parent * nodeTransform(node);
+    const JsonValue &mesh = gltf["meshes"][node["mesh"].sizeOr(SIZE_MAX)];
+    if(mesh.type == JsonValue::OBJECT) found.emplace_back(&mesh, transform);
+    const JsonValue &children = node["children"];
+    for(size_t i = 0; i < children.size(); i++)
+    {
+        collectNode(gltf, children[i], transform, depth + 1, visited, found);
+    }
+}
+
+bool GltfLoader::load(const std::string &path, const std::string &name, Mesh *mesh, ThreadPool *pool)
+{
+    MappedFile file(path, false);
+    if(!file.isOpen())
+    {
+        std::cerr << "ERROR::GLTF::FILE_NOT_SUCCESSFULLY_READ " << path << std::endl;
+        return false;
+    }
+    ThreadPool serial(1);
+    ThreadPool &threads = pool ? *pool : serial;
+
+    // A header, then a JSON chunk and an optional binary chunk, each led by its length and type
+    const unsigned char *data = file.getData();
+    size_t size = file.getSize();
+    uint32_t header[5] = {};
+    if(size >= sizeof(header)) memcpy(header, data, sizeof(header));
+    bool valid = size >= sizeof(header) && header[0] == GLB_MAGIC && header[1] == 2 && header[2] <= size &&
+            header[2] >= sizeof(header) && header[4] == GLB_JSON && header[3] <= header[2] - sizeof(header);
+    size_t binOffset = sizeof(header) + ((size_t) header[3] + 3) / 4 * 4;
+    const unsigned char *bin = nullptr;
+    size_t binSize = 0;
+    if(valid && binOffset + 8 <= header[2])
+    {
+        uint32_t chunk[2];
+        memcpy(chunk, data + binOffset, sizeof(chunk));
+        if(chunk[1] == GLB_BIN && chunk[0] <= header[2] - binOffset - 8)
+        {
+            bin = data + binOffset + 8;
+            binSize = chunk[0];
+        }
+    }
+    if(!valid)
+    {
+        std::cerr << "ERROR::GLTF::NOT_A_GLB_FILE " << path << std::endl;
+        return false;
+    }
+
+    // The JSON is copied out of the mapping so it's null terminated
+    std::string text((const char *) data + sizeof(header), header[3]);
+    JsonValue gltf;
+    const char *cursor = text.c_str();
+    if(!parseValue(cursor, gltf, 0) || gltf.type != JsonValue::OBJECT)
+    {
+        std::cerr << "ERROR::GLTF::INVALID_JSON " << path << " at byte " << cursor - text.c_str() << std::endl;
+        return false;
+    }
+
+    // Meshes are placed by the nodes of the default scene, or drawn where they are if there isn't one
+    std::vector<std::pair<const JsonValue *, glm::mat4>> found;
+    const JsonValue &scene = gltf["scenes"][gltf["scene"].sizeOr(0)];
+    if(scene.type == JsonValue::OBJECT)
+    {
+        std::vector<bool> visited(gltf["nodes"].size(), false);
+        for(size_t i = 0; i < scene["nodes"].size(); i++)
+        {
+            collectNode(gltf, scene["nodes"][i], glm::mat4(1.0f), 0, visited, found);
+        }
+    }
+    else
+    {
+        for(size_t i = 0; i < gltf["meshes"].size(); i++) found.emplace_back(&gltf["meshes"][i], glm::mat4(1.0f));
+    }
+
+    size_t total = 0, count = 0, skipped = 0;
+    for(auto &instance : found) total += (*instance.first)["primitives"].size();
+    std::vector<GltfPrimitive> primitives(total);
+    for(auto &instance : found)
+    {
+        const JsonValue &list = (*instance.first)["primitives"];
+        for(size_t i = 0; i < list.size(); i++)
+        {
+            const JsonValue &json = list[i];
+            const JsonValue &attributes = json["attributes"];
+            GltfPrimitive &primitive = primitives[count++];
+            // Only triangle lists are drawn. Positions must be floats, as normals must be, while texture coordinates
+            // may also be normalised integers
+            bool readable = json["mode"].numberOr(GL_TRIANGLES) == GL_TRIANGLES &&
+                    findAccessor(gltf, attributes["POSITION"], 3, bin, binSize, primitive.positions) &&
+                    primitive.positions.componentType == GL_FLOAT;
+            if(readable && attributes["NORMAL"].type != JsonValue::NONE)
+            {
+                readable = findAccessor(gltf, attributes["NORMAL"], 3, bin, binSize, primitive.normals) &&
+                        primitive.normals.componentType == GL_FLOAT &&
+                        primitive.normals.count == primitive.positions.count;
+            }
+            if(readable && attributes["TEXCOORD_0"].type != JsonValue::NONE)
+            {
+                readable = findAccessor(gltf, attributes["TEXCOORD_0"], 2, bin, binSize, primitive.textures) &&
+                        primitive.textures.count == primitive.positions.count;
+            }
+            if(readable && json["indices"].type != JsonValue::NONE)
+            {
+                readable = findAccessor(gltf, json["indices"], 1, bin, binSize, primitive.indices) &&
+                        (primitive.indices.componentType == GL_UNSIGNED_BYTE ||
+                         primitive.indices.componentType == GL_UNSIGNED_SHORT ||
+                         primitive.indices.componentType == GL_UNSIGNED_INT);
+            }
+            primitive.readable = readable;
+            if(!readable)
+            {
+                skipped++;
+                continue;
+            }
+            primitive.transform = instance.second;
+            primitive.normalTransform = glm::transpose(glm::inverse(glm::mat3(instance.second)));
+            primitive.mirrored = glm::determinant(glm::mat3(instance.second)) < 0;
+            primitive.triangleCount = (primitive.indices.data ? primitive.indices.count :
+                    primitive.positions.count) / 3;
+        }
+    }
+
+    // Splits each primitive's triangles or vertices into jobs small enough to share between the threads
+    auto split = [&primitives](bool vertices) {
+        std::vector<GltfJob> jobs;
+        for(GltfPrimitive &primitive : primitives)
+        {
+            if(!primitive.readable || primitive.invalid) continue;
+            // Primitives with normals keep their vertices, while the others have their own for each triangle
+            size_t length = vertices && primitive.normals.data ? primitive.positions.count : primitive.triangleCount;
+            for(size_t begin = 0; begin < length; begin += GLTF_JOB_SIZE)
+            {
+                jobs.push_back({&primitive, begin, std::min(begin + GLTF_JOB_SIZE, length)});
+            }
+        }
+        return jobs;
+    };
+
+    // Every index is checked before any is used, so a primitive reading outside its vertices is skipped whole
+    std::vector<GltfJob> jobs = split(false);
+    threads.run(jobs.size(), [&jobs](size_t i) {
+        GltfJob &job = jobs[i];
+        if(!job.primitive->indices.data) return;
+        for(size_t corner = job.begin * 3; corner < job.end * 3; corner++)
+        {
+            if(readIndex(job.primitive->indices, corner) >= job.primitive->positions.count)
+            {
+                job.primitive->invalid = true;
+                return;
+            }
+        }
+    });
+
+    size_t vertexCount = 0, indexCount = 0, primitivesRead = 0;
+    for(GltfPrimitive &primitive : primitives)
+    {
+        if(!primitive.readable) continue;
+        if(primitive.invalid)
+        {
+            skipped++;
+            continue;
+        }
+        primitive.vertexBase = vertexCount;
+        primitive.indexBase = indexCount;
+        vertexCount += primitive.normals.data ? primitive.positions.count : primitive.triangleCount * 3;
+        indexCount += primitive.triangleCount * 3;
+        primitivesRead++;
+    }
+
+    Mesh result;
+    result.floatsPerVertex = 8;
+    result.vertices.resize(vertexCount * 8);
+    result.indices.resize(indexCount);
+    // Vertices of primitives with normals are read as they are, while the others are read per triangle
+    jobs = split(true);
+    std::vector<GltfJob> indexJobs = split(false);
+    jobs.insert(jobs.end(), indexJobs.begin(), indexJobs.end());
+    size_t vertexJobs = jobs.size() - indexJobs.size();
+    threads.run(jobs.size(), [&](size_t i) {
+        GltfJob &job = jobs[i];
+        const GltfPrimitive &primitive = *job.primitive;
+        if(i >= vertexJobs)
+        {
+            if(!primitive.normals.data) return;
+            for(size_t corner = job.begin * 3; corner < job.end * 3; corner++)
+            {
+                result.indices[primitive.indexBase + corner] = (uint32_t) primitive.vertexBase + primitive.corner(corner);
+            }
+        }
+        else if(primitive.normals.data)
+        {
+            for(size_t vertex = job.begin; vertex < job.end; vertex++)
+            {
+                primitive.read((uint32_t) vertex, &result.vertices[(primitive.vertexBase + vertex) * 8]);
+            }
+        }
+        else
+        {
+            for(size_t triangle = job.begin; triangle < job.end; triangle++)
+            {
+                size_t first = primitive.vertexBase + triangle * 3;
+                float *out = &result.vertices[first * 8];
+                for(int corner = 0; corner < 3; corner++)
+                {
+                    primitive.read(primitive.corner(triangle * 3 + corner), out + corner * 8);
+                    result.indices[primitive.indexBase + triangle * 3 + corner] = (uint32_t) (first + corner);
+                }
+                glm::vec3 a = glm::make_vec3(out), b = glm::make_vec3(out + 8), c = glm::make_vec3(out + 16);
+                glm::vec3 normal = glm::cross(b - a, c - a);
+                if(glm::length(normal) > 0) normal = glm::normalize(normal);
+                for(int corner = 0; corner < 3; corner++) memcpy(out + corner * 8 + 3, &normal, sizeof(normal));
+            }
+        }
+    });
+
+    *mesh = std::move(result);
+    std::cout << "INFO::GLTF::LOADED " << name << " " << size << " bytes, " << primitivesRead << " primitives to "
+              << mesh->vertexCount() << " vertices and " << mesh->indices.size() / 3 << " triangles";
+    if(skipped) std::cout << ", skipping " << skipped << " primitives that couldn't be read";
+    std::cout << std::endl;
+    return true;
+}
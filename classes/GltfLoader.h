@@ -0,0 +1,37 @@
+#ifndef OPENGLPROJECT_GLTFLOADER_H
+#define OPENGLPROJECT_GLTFLOADER_H
+
+#include <string>
+#include "MeshBuilder.h"
+#include "ThreadPool.h"
+
+// Most vertices or triangles of a primitive converted as one job
+const size_t GLTF_JOB_SIZE = 1 << 16;
+
+/**
+ * Reads binary glTF 2.0 files (.glb) into a Mesh of positions, normals and texture coordinates, 8 floats per vertex as
+ * ObjLoader's are
+ *
+ * Every triangle primitive of every mesh in the default scene is read and placed by its node's transform, then merged
+ * into the one mesh. Primitives without normals are given the normal of each triangle, as glTF asks, and those
+ * without texture coordinates take 0. Texture coordinates are flipped, as glTF's start at the top of the image.
+ * Materials, animation and any other attribute are skipped, as are buffers outside the file and sparse accessors
+ *
+ * The file is memory mapped and only its JSON is parsed on the calling thread. The binary chunk is already indexed,
+ * so the vertices and indices are converted in place from the mapping in jobs spread across a ThreadPool
+ */
+class GltfLoader {
+public:
+    /**
+     * Reads a binary glTF file, printing its size
+     * @param path Path of the file
+     * @param name Name to print the size under
+     * @param mesh Location to store the mesh
+     * @param pool Threads to convert the data on, or nullptr to convert it on the calling thread
+     * @return True if the file was read. Primitives that can't be read are skipped without failing
+     */
+    static bool load(const std::string &path, const std::string &name, Mesh *mesh, ThreadPool *pool = nullptr);
+};
+
+
+#endif //OPENGLPROJECT_GLTFLOADER_H
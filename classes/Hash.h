@@ -0,0 +1,30 @@
+#ifndef OPENGLPROJECT_HASH_H
+#define OPENGLPROJECT_HASH_H
+
+#include <cstddef>
+#include <cstdint>
+
+// Starting value of a 64 bit FNV-1a hash
+constexpr uint64_t FNV_OFFSET = 14695981039346656037ull;
+// Multiplier of a 64 bit FNV-1a hash
+constexpr uint64_t FNV_PRIME = 1099511628211ull;
+
+/**
+ * Hashes data using 64 bit FNV-1a
+ * @param data Data to hash
+ * @param length Number of bytes to hash
+ * @param hash Hash to continue from
+ * @return New hash
+ */
+constexpr uint64_t fnv1a(const char *data, size_t length, uint64_t hash = FNV_OFFSET)
+{
+    for(size_t i = 0; i < length; i++)
+    {
+        hash ^= (unsigned char) data[i];
+        hash *= FNV_PRIME;
+    }
+    return hash;
+}
+
+
+#endif //OPENGLPROJECT_HASH_H
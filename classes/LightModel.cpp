@@ -1,36 +1,19 @@
 #include "LightModel.h"
 
-LightModel::LightModel() : Model((float*) l_vertices, 180)
+LightModel::LightModel() : Model(MeshSimplifier::generateLods(MeshOptimiser::optimise(
+        MeshBuilder::weld(l_vertices, sizeof(l_vertices) / sizeof(float), 5, "LightModel"), 3, "LightModel"), 3, "LightModel"), {
+        // Position. The texture coordinates in the buffer aren't used, so aren't kept
+        {0, 3, 0, VertexPacking::QUANTISED_SHORT}
+}, "LightModel")
 {
-    // Position
-    // Tells OpenGL how to interpret the vertex buffer data
-    // Index, Size, Type, Normalized, Stride, Pointer
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (void *) 0);
-    // Enables a generic vertex attribute at the given index
-    glEnableVertexAttribArray(0);
-
-    // Location
-    // Tells OpenGL how to interpret the vertex buffer data
-    // Index, Size, Type, Normalized, Stride, Pointer
-    //glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (void *) (3 * sizeof(float)));
-    // Enables a generic vertex attribute at the given index
-    //glEnableVertexAttribArray(1);
-
-    // Note that this is allowed, the call to glVertexAttribPointer registered VBO as the vertex attribute's bound vertex buffer object so afterwards we can safely unbind
-    // Unbinds the buffer
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
-
-    // You can unbind the VAO afterwards so other VAO calls won't accidentally modify this VAO, but this rarely happens. Modifying other
-    // VAOs requires a call to glBindVertexArray anyways so we generally don't unbind VAOs (nor VBOs) when it's not directly necessary.
-    glBindVertexArray(0);
 }
 
-void LightModel::draw(glm::vec3 position, Shader shader)
+void LightModel::draw(glm::vec3 position, const Shader &shader)
 {
     Model::draw(position, shader, 36);
 }
 
-void LightModel::drawS(glm::vec3 position, Shader shader, float size)
+void LightModel::drawS(glm::vec3 position, const Shader &shader, float size)
 {
     Model::drawS(position, shader, 36, size);
 }
\ No newline at end of file
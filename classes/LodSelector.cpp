@@ -0,0 +1,64 @@
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include "LodSelector.h"
+
+void LodSelector::beginFrame(const Camera &camera, unsigned int screenHeight)
+{
+    cameraPos = camera.cameraPos;
+    // Half the screen covers tan(fov / 2) units one unit away
+    pixelsPerUnit = screenHeight * 0.5f / std::tan(glm::radians(camera.fov) * 0.5f);
+    frame = Frame();
+}
+
+const MeshLod &LodSelector::select(const Model &model, const glm::mat4 &transform, int &level, bool count)
+{
+    const std::vector<MeshLod> &lods = model.getLods();
+    const glm::vec4 &bounds = model.getBounds();
+    glm::vec3 centre = glm::vec3(transform * glm::vec4(glm::vec3(bounds), 1.0f));
+    float scale = std::max({glm::length(glm::vec3(transform[0])), glm::length(glm::vec3(transform[1])),
+            glm::length(glm::vec3(transform[2]))});
+    // Measured to the nearest point of the bounds, so a large object close by isn't treated as far away
+    float distance = std::max(glm::length(centre - cameraPos) - bounds.w * scale, MIN_DISTANCE);
+    float pixels = scale * pixelsPerUnit / distance;
+
+    // Coarsest levels under the threshold moved each way by the hysteresis, levels coarsening with the index
+    int tight = 0, loose = 0;
+    for(int i = 1; i < (int) lods.size(); i++)
+    {
+        float error = lods[i].error * pixels;
+        if(error <= pixelError * (1.0f - hysteresis)) tight = i;
+        if(error <= pixelError * (1.0f + hysteresis)) loose = i;
+    }
+    level = std::min(std::max(level, tight), loose);
+
+    if(count)
+    {
+        frame.objects++;
+        frame.triangles += lods[level].indexCount / 3;
+        frame.fullTriangles += lods[0].indexCount / 3;
+    }
+    return lods[level];
+}
+
+void LodSelector::endFrame()
+{
+    frame.frames = 1;
+    total.frames++;
+    total.objects += frame.objects;
+    total.triangles += frame.triangles;
+    total.fullTriangles += frame.fullTriangles;
+}
+
+const LodSelector::Frame &LodSelector::getFrame() const
+{
+    return frame;
+}
+
+void LodSelector::report() const
+{
+    if(total.frames == 0) return;
+    std::cout << "INFO::LOD " << total.objects / total.frames << " objects, " << total.triangles / total.frames
+              << " triangles per frame with levels of detail, " << total.fullTriangles / total.frames << " without"
+              << std::endl;
+}
@@ -0,0 +1,74 @@
+#ifndef OPENGLPROJECT_LODSELECTOR_H
+#define OPENGLPROJECT_LODSELECTOR_H
+
+#include <glm/glm.hpp>
+#include "Camera.h"
+#include "Model.h"
+
+/**
+ * Picks each object's level of detail from how large its simplification error would be on screen
+ *
+ * An object's bounding sphere gives its nearest distance to the camera, and the level's error in the model's units is
+ * projected to pixels at that distance with the camera's vertical field of view. The coarsest level within the allowed
+ * error is drawn. So objects near the threshold don't pop between levels every frame, a level is kept until its error
+ * leaves a band around the threshold, which needs the level drawn last frame
+ */
+class LodSelector {
+public:
+    /**
+     * Triangles submitted over one or more frames
+     */
+    struct Frame {
+        int frames = 0;
+        int objects = 0;
+        // Triangles of the levels drawn
+        size_t triangles = 0;
+        // Triangles there would have been drawing every object in full
+        size_t fullTriangles = 0;
+    };
+
+    // Largest error in pixels a level may have on screen
+    float pixelError = 1.0f;
+    // Fraction of pixelError the error may move past it before a drawn level is changed
+    float hysteresis = 0.25f;
+
+    /**
+     * Starts counting a frame seen from a camera
+     * @param camera Camera the frame is drawn from
+     * @param screenHeight Height of the viewport in pixels
+     */
+    void beginFrame(const Camera &camera, unsigned int screenHeight);
+    /**
+     * Picks the level of detail to draw a model with, counting its triangles in the frame if asked
+     * @param model Model to draw
+     * @param transform Model matrix of the object
+     * @param level Level drawn last frame, or 0 at first. Updated to the level picked
+     * @param count Whether to count the object in the frame. Passes such as shadows drawing it again leave it out
+     * @return Level to draw
+     */
+    const MeshLod &select(const Model &model, const glm::mat4 &transform, int &level, bool count = true);
+    /**
+     * Adds the frame to the totals
+     */
+    void endFrame();
+
+    /**
+     * Gets the triangles counted since the last beginFrame
+     * @return Counts of the frame
+     */
+    const Frame &getFrame() const;
+    /**
+     * Prints the average triangles submitted per frame with and without levels of detail
+     */
+    void report() const;
+
+private:
+    glm::vec3 cameraPos = glm::vec3(0.0f);
+    // Pixels per unit of error one unit away from the camera
+    float pixelsPerUnit = 0;
+    Frame frame;
+    Frame total;
+};
+
+
+#endif //OPENGLPROJECT_LODSELECTOR_H
@@ -0,0 +1,57 @@
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "MappedFile.h"
+
+MappedFile::MappedFile(const std::string &path, bool sequential)
+{
+    int descriptor = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    struct stat status{};
+    if(descriptor == -1 || fstat(descriptor, &status) == -1)
+    {
+        if(descriptor != -1) ::close(descriptor);
+        return;
+    }
+    size = (size_t) status.st_size;
+    // The mapping keeps the file open, so the descriptor isn't needed once it's made
+    void *mapping = size ? mmap(nullptr, size, PROT_READ, MAP_PRIVATE, descriptor, 0) : nullptr;
+    ::close(descriptor);
+    if(mapping == MAP_FAILED)
+    {
+        size = 0;
+        return;
+    }
+    if(mapping) madvise(mapping, size, sequential ? MADV_SEQUENTIAL : MADV_WILLNEED);
+    data = (const unsigned char *) mapping;
+    open = true;
+}
+
+MappedFile::~MappedFile()
+{
+    close();
+}
+
+bool MappedFile::isOpen() const
+{
+    return open;
+}
+
+const unsigned char *MappedFile::getData() const
+{
+    return data;
+}
+
+size_t MappedFile::getSize() const
+{
+    return size;
+}
+
+void MappedFile::close()
+{
+    if(data) munmap((void *) data, size);
+    data = nullptr;
+    size = 0;
+    open = false;
+}
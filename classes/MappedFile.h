@@ -0,0 +1,53 @@
+#ifndef OPENGLPROJECT_MAPPEDFILE_H
+#define OPENGLPROJECT_MAPPEDFILE_H
+
+#include <cstddef>
+#include <string>
+
+/**
+ * A file mapped read only into memory, so it's read straight from the page cache without copying it into a buffer
+ */
+class MappedFile {
+public:
+    /**
+     * Maps a whole file. An empty file opens with no data
+     * @param path Path of the file
+     * @param sequential Whether the file is read once from start to end, so the kernel reads ahead and drops pages
+     * behind. Otherwise the whole file is read ahead, for several threads reading their own parts at once
+     */
+    explicit MappedFile(const std::string &path, bool sequential = true);
+    /**
+     * Unmaps the file
+     */
+    ~MappedFile();
+    MappedFile(const MappedFile &) = delete;
+    MappedFile &operator=(const MappedFile &) = delete;
+
+    /**
+     * Checks whether the file was opened and mapped
+     * @return True if the file can be read
+     */
+    bool isOpen() const;
+    /**
+     * Gets the contents of the file, which last until it's closed
+     * @return Start of the file, or nullptr if it's empty or not open
+     */
+    const unsigned char *getData() const;
+    /**
+     * Gets the size of the file
+     * @return Size in bytes, 0 if it's not open
+     */
+    size_t getSize() const;
+    /**
+     * Unmaps the file early, once it's no longer needed
+     */
+    void close();
+
+private:
+    const unsigned char *data = nullptr;
+    size_t size = 0;
+    bool open = false;
+};
+
+
+#endif //OPENGLPROJECT_MAPPEDFILE_H
@@ -0,0 +1,109 @@
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+#include "MeshBuilder.h"
+#include "Hash.h"
+
+size_t Mesh::vertexCount() const
+{
+    return floatsPerVertex ? vertices.size() / floatsPerVertex : 0;
+}
+
+GLenum Mesh::indexType() const
+{
+    return vertexCount() <= 65536 ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT;
+}
+
+size_t Mesh::indexSize() const
+{
+    return indexType() == GL_UNSIGNED_SHORT ? sizeof(uint16_t) : sizeof(uint32_t);
+}
+
+glm::vec4 Mesh::bounds(int positionSize) const
+{
+    auto positionOf = [this, positionSize](size_t vertex) {
+        glm::vec3 position(0.0f);
+        for(int i = 0; i < std::min(positionSize, 3); i++)
+        {
+            position[i] = vertices[vertex * floatsPerVertex + i];
+        }
+        return position;
+    };
+    glm::vec3 minimum(0.0f), maximum(0.0f);
+    for(size_t v = 0; v < vertexCount(); v++)
+    {
+        minimum = v ? glm::min(minimum, positionOf(v)) : positionOf(v);
+        maximum = v ? glm::max(maximum, positionOf(v)) : positionOf(v);
+    }
+    glm::vec3 centre = (minimum + maximum) * 0.5f;
+    float radius = 0;
+    for(size_t v = 0; v < vertexCount(); v++)
+    {
+        radius = std::max(radius, glm::length(positionOf(v) - centre));
+    }
+    return glm::vec4(centre, radius);
+}
+
+std::vector<unsigned char> Mesh::indexData() const
+{
+    std::vector<unsigned char> data(indices.size() * indexSize());
+    if(indexType() == GL_UNSIGNED_INT)
+    {
+        memcpy(data.data(), indices.data(), data.size());
+        return data;
+    }
+    auto *shorts = (uint16_t *) data.data();
+    for(size_t i = 0; i < indices.size(); i++)
+    {
+        shorts[i] = (uint16_t) indices[i];
+    }
+    return data;
+}
+
+MeshBuilder::MeshBuilder(int floatsPerVertex)
+{
+    mesh.floatsPerVertex = floatsPerVertex;
+}
+
+uint32_t MeshBuilder::add(const float *vertex)
+{
+    size_t size = mesh.floatsPerVertex * sizeof(float);
+    // Compared bit for bit, so vertices only weld if they are exactly the same
+    std::vector<uint32_t> &candidates = welded[fnv1a((const char *) vertex, size)];
+    for(uint32_t index : candidates)
+    {
+        if(memcmp(&mesh.vertices[index * mesh.floatsPerVertex], vertex, size) == 0)
+        {
+            mesh.indices.push_back(index);
+            return index;
+        }
+    }
+
+    auto index = (uint32_t) mesh.vertexCount();
+    mesh.vertices.insert(mesh.vertices.end(), vertex, vertex + mesh.floatsPerVertex);
+    mesh.indices.push_back(index);
+    candidates.push_back(index);
+    return index;
+}
+
+const Mesh &MeshBuilder::getMesh() const
+{
+    return mesh;
+}
+
+Mesh MeshBuilder::weld(const float *vertices, int length, int floatsPerVertex, const std::string &name)
+{
+    MeshBuilder builder(floatsPerVertex);
+    for(int i = 0; i + floatsPerVertex <= length; i += floatsPerVertex)
+    {
+        builder.add(vertices + i);
+    }
+
+    const Mesh &mesh = builder.getMesh();
+    size_t before = length * sizeof(float);
+    size_t after = mesh.vertices.size() * sizeof(float) + mesh.indices.size() * mesh.indexSize();
+    std::cout << "INFO::MESH::WELDED " << name << " " << length / floatsPerVertex << " vertices (" << before
+              << " bytes) to " << mesh.vertexCount() << " vertices and " << mesh.indices.size() << " "
+              << mesh.indexSize() * 8 << " bit indices (" << after << " bytes)" << std::endl;
+    return mesh;
+}
@@ -0,0 +1,124 @@
+#ifndef OPENGLPROJECT_MESHBUILDER_H
+#define OPENGLPROJECT_MESHBUILDER_H
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * A level of detail of a Mesh, drawing its vertices with some of its indices
+ */
+struct MeshLod {
+    // Range of the mesh's indices drawing the level
+    size_t firstIndex;
+    size_t indexCount;
+    // How far the level's surface strays from the full mesh, in the mesh's units
+    float error;
+    // Range of the mesh's meshlets covering the level, if it was split into them
+    size_t firstMeshlet = 0;
+    size_t meshletCount = 0;
+};
+
+/**
+ * A small cluster of a Mesh's triangles, with the bounds to cull it by
+ */
+struct Meshlet {
+    // Range of the mesh's indices drawing the cluster
+    size_t firstIndex;
+    size_t indexCount;
+    // Sphere around the cluster's vertices, its centre and its radius as w
+    glm::vec4 bounds;
+    // Average direction the triangles face, and the sine of the largest angle between it and any triangle's normal,
+    // or 1 where the triangles face too many ways to ever all face away
+    glm::vec3 coneAxis;
+    float coneCutoff;
+};
+
+/**
+ * Indexed triangles with interleaved float vertices
+ */
+struct Mesh {
+    // Number of floats in each vertex
+    int floatsPerVertex = 0;
+    std::vector<float> vertices;
+    // Three indices into vertices per triangle
+    std::vector<uint32_t> indices;
+    // Levels of detail, finest first, if any were generated. The first is the full mesh at the start of indices, and
+    // each coarser level has its own range of indices after it
+    std::vector<MeshLod> lods;
+    // Clusters each level of detail was split into, if any
+    std::vector<Meshlet> meshlets;
+
+    /**
+     * Gets the number of vertices
+     * @return Number of vertices
+     */
+    size_t vertexCount() const;
+    /**
+     * Gets the smallest index type that can address every vertex
+     * @return GL_UNSIGNED_SHORT or GL_UNSIGNED_INT
+     */
+    GLenum indexType() const;
+    /**
+     * Gets the size of an index of indexType
+     * @return 2 or 4 bytes
+     */
+    size_t indexSize() const;
+    /**
+     * Converts the indices to indexType, ready to upload to an element buffer
+     * @return Index data
+     */
+    std::vector<unsigned char> indexData() const;
+    /**
+     * Gets a sphere around every vertex
+     * @param positionSize Number of floats in the position, which is at the start of each vertex
+     * @return Centre of the sphere, and its radius as w
+     */
+    glm::vec4 bounds(int positionSize) const;
+};
+
+/**
+ * Builds a Mesh from vertices, welding those identical in every component into one so they're shared between
+ * triangles, and transformed once while they remain in the post-transform cache
+ */
+class MeshBuilder {
+public:
+    /**
+     * Starts an empty mesh
+     * @param floatsPerVertex Number of floats in each vertex
+     */
+    explicit MeshBuilder(int floatsPerVertex);
+    /**
+     * Adds the next vertex of the triangle list, reusing an identical vertex if one was added before
+     * @param vertex Vertex of floatsPerVertex floats
+     * @return Index of the vertex
+     */
+    uint32_t add(const float *vertex);
+    /**
+     * Gets the mesh built so far
+     * @return Welded vertices and their indices
+     */
+    const Mesh &getMesh() const;
+
+    /**
+     * Welds a triangle list of expanded vertices, printing how much smaller it became
+     * @param vertices Vertices, three per triangle
+     * @param length Length of the vertex array
+     * @param floatsPerVertex Number of floats in each vertex
+     * @param name Name to print the reduction under
+     * @return Welded mesh, drawing the same triangles in the same order
+     */
+    static Mesh weld(const float *vertices, int length, int floatsPerVertex, const std::string &name);
+
+private:
+    Mesh mesh;
+    // Indices of the vertices added by their hash. Vertices of the same hash are told apart by comparing them
+    std::unordered_map<uint64_t, std::vector<uint32_t>> welded;
+};
+
+
+#endif //OPENGLPROJECT_MESHBUILDER_H
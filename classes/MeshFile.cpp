@@ -0,0 +1,367 @@
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <glm/gtc/type_ptr.hpp>
+#include "MeshFile.h"
+
+// Identifies a mesh file, "OGPM" read as a little endian integer
+static const uint32_t MESH_FILE_MAGIC = 0x4D50474F;
+// Attribute locations a mesh file may use, as every OpenGL implementation has at least this many
+static const uint32_t MESH_FILE_MAX_LOCATIONS = 16;
+
+/**
+ * Start of a mesh file
+ */
+struct MeshFileHeader {
+    uint32_t magic;
+    uint32_t version;
+    // Size of a vertex in bytes
+    uint32_t stride;
+    uint32_t indexType;
+    uint64_t vertexCount;
+    uint64_t indexCount;
+    uint32_t attributeCount;
+    uint32_t lodCount;
+    uint64_t meshletCount;
+    // Offsets of each array from the start of the file in bytes
+    uint64_t attributeOffset;
+    uint64_t lodOffset;
+    uint64_t meshletOffset;
+    uint64_t vertexOffset;
+    uint64_t indexOffset;
+    float bounds[4];
+    float dequantisation[16];
+};
+
+/**
+ * A VertexAttribute as stored, with every field a fixed size
+ */
+struct MeshFileAttribute {
+    uint32_t location;
+    int32_t size;
+    uint32_t type;
+    uint32_t offset;
+    uint32_t normalized;
+    uint32_t divisor;
+};
+
+/**
+ * A MeshLod as stored
+ */
+struct MeshFileLod {
+    uint64_t firstIndex;
+    uint64_t indexCount;
+    uint64_t firstMeshlet;
+    uint64_t meshletCount;
+    float error;
+    uint32_t padding;
+};
+
+/**
+ * A Meshlet as stored
+ */
+struct MeshFileMeshlet {
+    uint64_t firstIndex;
+    uint64_t indexCount;
+    float bounds[4];
+    float coneAxis[3];
+    float coneCutoff;
+};
+
+// Every array is read in place, so the layout mustn't depend on the compiler
+static_assert(sizeof(MeshFileHeader) == 168, "MeshFileHeader must have no padding");
+static_assert(sizeof(MeshFileAttribute) == 24, "MeshFileAttribute must have no padding");
+static_assert(sizeof(MeshFileLod) == 40, "MeshFileLod must have no padding");
+static_assert(sizeof(MeshFileMeshlet) == 48, "MeshFileMeshlet must have no padding");
+
+/**
+ * Rounds an offset up to the alignment of the vertex and index data
+ * @param offset Offset in bytes
+ * @return Aligned offset
+ */
+static uint64_t align(uint64_t offset)
+{
+    return (offset + MESH_FILE_ALIGNMENT - 1) / MESH_FILE_ALIGNMENT * MESH_FILE_ALIGNMENT;
+}
+
+/**
+ * Works out how many bytes of each vertex a stored attribute reads
+ * @param attribute Attribute as stored
+ * @return Size in bytes, or 0 if OpenGL can't read the attribute
+ */
+static uint64_t attributeBytes(const MeshFileAttribute &attribute)
+{
+    if(attribute.size < 1 || attribute.size > 4) return 0;
+    switch(attribute.type)
+    {
+        case GL_BYTE: case GL_UNSIGNED_BYTE: return attribute.size;
+        case GL_SHORT: case GL_UNSIGNED_SHORT: case GL_HALF_FLOAT: return attribute.size * 2;
+        case GL_INT: case GL_UNSIGNED_INT: case GL_FLOAT: return attribute.size * 4;
+        // Packed types are read as 4 components from a single 32 bit value
+        case GL_INT_2_10_10_10_REV: case GL_UNSIGNED_INT_2_10_10_10_REV: return attribute.size == 4 ? 4 : 0;
+        default: return 0;
+    }
+}
+
+/**
+ * Finds the largest of a run of indices
+ * @param indices Index data
+ * @param count Number of indices
+ * @param indexSize Size of each index, 2 or 4 bytes
+ * @return Largest index, or 0 if there are none
+ */
+static uint64_t largestIndex(const unsigned char *indices, uint64_t count, size_t indexSize)
+{
+    uint64_t largest = 0;
+    if(indexSize == 2)
+    {
+        const auto *values = (const uint16_t *) indices;
+        for(uint64_t i = 0; i < count; i++) largest = std::max<uint64_t>(largest, values[i]);
+    }
+    else
+    {
+        const auto *values = (const uint32_t *) indices;
+        for(uint64_t i = 0; i < count; i++) largest = std::max<uint64_t>(largest, values[i]);
+    }
+    return largest;
+}
+
+bool MeshFile::write(const std::string &path, const Mesh &mesh, const std::vector<PackedAttribute> &format,
+        const std::string &name)
+{
+    PackedVertices packed = VertexPacker::pack(mesh, format, name);
+    std::vector<unsigned char> indices = mesh.indexData();
+    int positionSize = 0;
+    for(const PackedAttribute &attribute : format)
+    {
+        if(attribute.location == 0) positionSize = attribute.size;
+    }
+
+    std::vector<MeshFileAttribute> attributes;
+    for(const VertexAttribute &attribute : packed.layout.attributes)
+    {
+        attributes.push_back(MeshFileAttribute{attribute.location, attribute.size, attribute.type, attribute.offset,
+                attribute.normalized, attribute.divisor});
+    }
+    std::vector<MeshFileLod> lods;
+    for(const MeshLod &lod : mesh.lods)
+    {
+        lods.push_back(MeshFileLod{lod.firstIndex, lod.indexCount, lod.firstMeshlet, lod.meshletCount, lod.error, 0});
+    }
+    if(lods.empty()) lods.push_back(MeshFileLod{0, mesh.indices.size(), 0, 0, 0.0f, 0});
+    std::vector<MeshFileMeshlet> meshlets;
+    for(const Meshlet &meshlet : mesh.meshlets)
+    {
+        meshlets.push_back(MeshFileMeshlet{meshlet.firstIndex, meshlet.indexCount,
+                {meshlet.bounds.x, meshlet.bounds.y, meshlet.bounds.z, meshlet.bounds.w},
+                {meshlet.coneAxis.x, meshlet.coneAxis.y, meshlet.coneAxis.z}, meshlet.coneCutoff});
+    }
+
+    MeshFileHeader header{};
+    header.magic = MESH_FILE_MAGIC;
+    header.version = MESH_FILE_VERSION;
+    header.stride = packed.layout.stride;
+    header.indexType = mesh.indexType();
+    header.vertexCount = mesh.vertexCount();
+    header.indexCount = mesh.indices.size();
+    header.attributeCount = (uint32_t) attributes.size();
+    header.lodCount = (uint32_t) lods.size();
+    header.meshletCount = meshlets.size();
+    header.attributeOffset = sizeof(MeshFileHeader);
+    header.lodOffset = header.attributeOffset + attributes.size() * sizeof(MeshFileAttribute);
+    header.meshletOffset = header.lodOffset + lods.size() * sizeof(MeshFileLod);
+    header.vertexOffset = align(header.meshletOffset + meshlets.size() * sizeof(MeshFileMeshlet));
+    header.indexOffset = align(header.vertexOffset + packed.data.size());
+    glm::vec4 bounds = mesh.bounds(positionSize);
+    memcpy(header.bounds, glm::value_ptr(bounds), sizeof(header.bounds));
+    memcpy(header.dequantisation, glm::value_ptr(packed.dequantisation), sizeof(header.dequantisation));
+
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    const char padding[MESH_FILE_ALIGNMENT] = {};
+    file.write((const char *) &header, sizeof(header));
+    file.write((const char *) attributes.data(), attributes.size() * sizeof(MeshFileAttribute));
+    file.write((const char *) lods.data(), lods.size() * sizeof(MeshFileLod));
+    file.write((const char *) meshlets.data(), meshlets.size() * sizeof(MeshFileMeshlet));
+    file.write(padding, header.vertexOffset - header.meshletOffset - meshlets.size() * sizeof(MeshFileMeshlet));
+    file.write((const char *) packed.data.data(), packed.data.size());
+    file.write(padding, header.indexOffset - header.vertexOffset - packed.data.size());
+    file.write((const char *) indices.data(), indices.size());
+    if(!file)
+    {
+        std::cerr << "ERROR::MESH_FILE::WRITE_FAILED " << path << std::endl;
+        return false;
+    }
+    std::cout << "INFO::MESH_FILE::WRITTEN " << name << " " << header.vertexCount << " vertices and "
+              << header.indexCount << " indices in " << lods.size() << " levels to "
+              << header.indexOffset + indices.size() << " bytes" << std::endl;
+    return true;
+}
+
+MeshFile::MeshFile(const std::string &path) : file(path)
+{
+    if(!file.isOpen())
+    {
+        std::cerr << "ERROR::MESH_FILE::FILE_NOT_SUCCESSFULLY_READ " << path << std::endl;
+        return;
+    }
+    data = file.getData();
+    size = file.getSize();
+    header = (const MeshFileHeader *) data;
+
+    if(!validate(path))
+    {
+        file.close();
+        data = nullptr;
+        header = nullptr;
+        size = 0;
+    }
+}
+
+bool MeshFile::validate(const std::string &path) const
+{
+    if(size < sizeof(MeshFileHeader) || header->magic != MESH_FILE_MAGIC)
+    {
+        std::cerr << "ERROR::MESH_FILE::NOT_A_MESH_FILE " << path << std::endl;
+        return false;
+    }
+    if(header->version != MESH_FILE_VERSION)
+    {
+        std::cerr << "ERROR::MESH_FILE::UNSUPPORTED_VERSION " << path << " is version " << header->version
+                  << ", expected " << MESH_FILE_VERSION << std::endl;
+        return false;
+    }
+
+    size_t indexSize = header->indexType == GL_UNSIGNED_SHORT ? 2 : header->indexType == GL_UNSIGNED_INT ? 4 : 0;
+    // Each range is checked against what's left after its offset, so a corrupt count can't overflow the sum
+    auto fits = [this](uint64_t offset, uint64_t count, uint64_t elementSize) {
+        return offset <= size && (elementSize == 0 || count <= (size - offset) / elementSize);
+    };
+    bool valid = indexSize != 0 && header->stride != 0 &&
+            fits(header->attributeOffset, header->attributeCount, sizeof(MeshFileAttribute)) &&
+            fits(header->lodOffset, header->lodCount, sizeof(MeshFileLod)) &&
+            fits(header->meshletOffset, header->meshletCount, sizeof(MeshFileMeshlet)) &&
+            fits(header->vertexOffset, header->vertexCount, header->stride) &&
+            fits(header->indexOffset, header->indexCount, indexSize) &&
+            header->vertexOffset % MESH_FILE_ALIGNMENT == 0 && header->indexOffset % MESH_FILE_ALIGNMENT == 0 &&
+            header->attributeOffset % alignof(MeshFileAttribute) == 0 && header->lodOffset % alignof(MeshFileLod) == 0 &&
+            header->meshletOffset % alignof(MeshFileMeshlet) == 0;
+
+    // Draws read the ranges of the levels and meshlets, so they must lie within the indices
+    const auto *lods = (const MeshFileLod *) (data + header->lodOffset);
+    for(uint32_t i = 0; valid && i < header->lodCount; i++)
+    {
+        valid = lods[i].firstIndex <= header->indexCount && lods[i].indexCount <= header->indexCount - lods[i].firstIndex &&
+                lods[i].firstMeshlet <= header->meshletCount &&
+                lods[i].meshletCount <= header->meshletCount - lods[i].firstMeshlet;
+    }
+    const auto *meshlets = (const MeshFileMeshlet *) (data + header->meshletOffset);
+    for(uint64_t i = 0; valid && i < header->meshletCount; i++)
+    {
+        valid = meshlets[i].firstIndex <= header->indexCount &&
+                meshlets[i].indexCount <= header->indexCount - meshlets[i].firstIndex;
+    }
+    // Every attribute is read from every vertex, so each must be one OpenGL can read lying within the stride
+    const auto *attributes = (const MeshFileAttribute *) (data + header->attributeOffset);
+    for(uint32_t i = 0; valid && i < header->attributeCount; i++)
+    {
+        uint64_t bytes = attributeBytes(attributes[i]);
+        valid = bytes != 0 && attributes[i].location < MESH_FILE_MAX_LOCATIONS && attributes[i].divisor == 0 &&
+                attributes[i].offset <= header->stride && bytes <= header->stride - attributes[i].offset;
+    }
+    // Without robust buffer access an index past the vertices reads outside the buffer, so every index is checked
+    // once here rather than trusting the file
+    if(valid && header->indexCount > 0)
+    {
+        valid = largestIndex(data + header->indexOffset, header->indexCount, indexSize) < header->vertexCount;
+    }
+    if(!valid)
+    {
+        std::cerr << "ERROR::MESH_FILE::CORRUPT " << path << std::endl;
+        return false;
+    }
+    return true;
+}
+
+bool MeshFile::isOpen() const
+{
+    return data != nullptr;
+}
+
+size_t MeshFile::getSize() const
+{
+    return size;
+}
+
+VertexLayout MeshFile::getLayout() const
+{
+    VertexLayout layout{header->stride, {}};
+    const auto *attributes = (const MeshFileAttribute *) (data + header->attributeOffset);
+    for(uint32_t i = 0; i < header->attributeCount; i++)
+    {
+        const MeshFileAttribute &attribute = attributes[i];
+        layout.attributes.push_back(VertexAttribute{attribute.location, attribute.size, attribute.type,
+                attribute.offset, attribute.normalized != 0, attribute.divisor});
+    }
+    return layout;
+}
+
+const void *MeshFile::getVertices() const
+{
+    return data + header->vertexOffset;
+}
+
+size_t MeshFile::getVertexCount() const
+{
+    return header->vertexCount;
+}
+
+const void *MeshFile::getIndices() const
+{
+    return data + header->indexOffset;
+}
+
+size_t MeshFile::getIndexCount() const
+{
+    return header->indexCount;
+}
+
+GLenum MeshFile::getIndexType() const
+{
+    return header->indexType;
+}
+
+std::vector<MeshLod> MeshFile::getLods() const
+{
+    std::vector<MeshLod> lods;
+    const auto *stored = (const MeshFileLod *) (data + header->lodOffset);
+    for(uint32_t i = 0; i < header->lodCount; i++)
+    {
+        lods.push_back(MeshLod{stored[i].firstIndex, stored[i].indexCount, stored[i].error, stored[i].firstMeshlet,
+                stored[i].meshletCount});
+    }
+    if(lods.empty()) lods.push_back(MeshLod{0, header->indexCount, 0.0f});
+    return lods;
+}
+
+std::vector<Meshlet> MeshFile::getMeshlets() const
+{
+    std::vector<Meshlet> meshlets;
+    const auto *stored = (const MeshFileMeshlet *) (data + header->meshletOffset);
+    for(uint64_t i = 0; i < header->meshletCount; i++)
+    {
+        meshlets.push_back(Meshlet{stored[i].firstIndex, stored[i].indexCount, glm::make_vec4(stored[i].bounds),
+                glm::make_vec3(stored[i].coneAxis), stored[i].coneCutoff});
+    }
+    return meshlets;
+}
+
+glm::vec4 MeshFile::getBounds() const
+{
+    return glm::make_vec4(header->bounds);
+}
+
+glm::mat4 MeshFile::getDequantisation() const
+{
+    return glm::make_mat4(header->dequantisation);
+}
@@ -0,0 +1,128 @@
+#ifndef OPENGLPROJECT_MESHFILE_H
+#define OPENGLPROJECT_MESHFILE_H
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include <string>
+#include <vector>
+#include "MappedFile.h"
+#include "MeshBuilder.h"
+#include "VertexLayout.h"
+#include "VertexPacker.h"
+
+// Version of the mesh file format written. Files of any other version are rejected
+const uint32_t MESH_FILE_VERSION = 1;
+// Alignment of the vertex and index data within a mesh file, in bytes
+const size_t MESH_FILE_ALIGNMENT = 64;
+
+struct MeshFileHeader;
+
+/**
+ * A mesh baked into a binary file, memory mapped so its vertices and indices are uploaded straight from the file
+ *
+ * The file holds a header, the vertex layout, the levels of detail and meshlets, then the packed vertices and the
+ * indices, each aligned to MESH_FILE_ALIGNMENT, exactly as they are uploaded to the GeometryArena. Nothing is parsed
+ * or copied on the CPU when it's loaded. The indices are only read once, to check them, and the vertices only as the
+ * upload reaches them. Files are little endian, as every platform the program runs on is
+ */
+class MeshFile {
+public:
+    /**
+     * Packs a mesh and writes it to a file, printing its size
+     * @param path Path of the file to write
+     * @param mesh Mesh to write, with any levels of detail and meshlets
+     * @param format Attributes to keep and how to store each. The position must be at location 0
+     * @param name Name to print the packing and size under
+     * @return True if the file was written
+     */
+    static bool write(const std::string &path, const Mesh &mesh, const std::vector<PackedAttribute> &format,
+            const std::string &name);
+
+    /**
+     * Maps a mesh file, checking its header, that every range it gives lies within the file, that each attribute
+     * lies within a vertex and that every index refers to a vertex. So no draw can read outside the buffers, but a
+     * corrupt file can still get past with wrong vertex values, bounds or meshlet cones, drawing or culling wrongly
+     * @param path Path of the file
+     */
+    explicit MeshFile(const std::string &path);
+
+    /**
+     * Checks whether the file was mapped and is a valid mesh file. Every other getter but getSize needs it to be
+     * @return True if the mesh can be read
+     */
+    bool isOpen() const;
+    /**
+     * Gets the size of the file
+     * @return Size in bytes
+     */
+    size_t getSize() const;
+
+    /**
+     * Gets the layout of each vertex
+     * @return Layout of the vertex data
+     */
+    VertexLayout getLayout() const;
+    /**
+     * Gets the vertex data, within the mapped file
+     * @return Packed vertices
+     */
+    const void *getVertices() const;
+    /**
+     * Gets the number of vertices
+     * @return Number of vertices
+     */
+    size_t getVertexCount() const;
+    /**
+     * Gets the index data, within the mapped file
+     * @return Indices of getIndexType
+     */
+    const void *getIndices() const;
+    /**
+     * Gets the number of indices
+     * @return Number of indices
+     */
+    size_t getIndexCount() const;
+    /**
+     * Gets the type of each index
+     * @return GL_UNSIGNED_SHORT or GL_UNSIGNED_INT
+     */
+    GLenum getIndexType() const;
+    /**
+     * Gets the mesh's levels of detail, finest first. There is always at least the full mesh
+     * @return Range of the indices, error and meshlets of each level
+     */
+    std::vector<MeshLod> getLods() const;
+    /**
+     * Gets the meshlets the levels of detail were split into
+     * @return Meshlets, empty if the mesh wasn't split
+     */
+    std::vector<Meshlet> getMeshlets() const;
+    /**
+     * Gets a sphere around every vertex, before any model matrix
+     * @return Centre of the sphere, and its radius as w
+     */
+    glm::vec4 getBounds() const;
+    /**
+     * Gets the transform restoring quantised positions to where they were built
+     * @return Dequantisation matrix, the identity unless positions were quantised
+     */
+    glm::mat4 getDequantisation() const;
+
+private:
+    MappedFile file;
+    // Start of the mapping, or nullptr if the file couldn't be opened or isn't valid
+    const unsigned char *data = nullptr;
+    size_t size = 0;
+    const MeshFileHeader *header = nullptr;
+
+    /**
+     * Checks the header, the ranges it gives, the attributes and the indices against the file
+     * @param path Path of the file, to print with any error
+     * @return True if the file is valid
+     */
+    bool validate(const std::string &path) const;
+};
+
+
+#endif //OPENGLPROJECT_MESHFILE_H
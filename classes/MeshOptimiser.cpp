@@ -0,0 +1,459 @@
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <limits>
+#include <glm/glm.hpp>
+#include "MeshOptimiser.h"
+
+// Size of the LRU cache Forsyth's scores model. Larger than real caches, so the order suits any of them
+static const int FORSYTH_CACHE_SIZE = 32;
+
+/**
+ * Scores how much drawing a triangle of a vertex next would help, by Forsyth's weights
+ * @param cachePosition Position of the vertex in the modelled cache, most recent first, or -1 if not in it
+ * @param remaining Number of the vertex's triangles not yet drawn
+ * @return Score of the vertex, -1 if it has no triangles left
+ */
+static float vertexScore(int cachePosition, uint32_t remaining)
+{
+    if(remaining == 0) return -1.0f;
+    float score = 0.0f;
+    if(cachePosition >= 0)
+    {
+        // The last triangle's vertices score the same, so using them again doesn't favour any order of them
+        if(cachePosition < 3) score = 0.75f;
+        else score = std::pow(1.0f - (cachePosition - 3) / (float) (FORSYTH_CACHE_SIZE - 3), 1.5f);
+    }
+    // Vertices with few triangles left are finished off, so they don't need transforming again later
+    return score + 2.0f / std::sqrt((float) remaining);
+}
+
+/**
+ * Reads the position of a vertex
+ * @param mesh Mesh holding the vertex
+ * @param positionSize Number of floats in the position, which is at the start of each vertex
+ * @param index Index of the vertex
+ * @return Position, with missing components 0
+ */
+static glm::vec3 positionOf(const Mesh &mesh, int positionSize, uint32_t index)
+{
+    glm::vec3 position(0.0f);
+    const float *vertex = mesh.vertices.data() + (size_t) index * mesh.floatsPerVertex;
+    for(int i = 0; i < std::min(positionSize, 3); i++)
+    {
+        position[i] = vertex[i];
+    }
+    return position;
+}
+
+/**
+ * A FIFO post-transform cache, tracked by when each vertex was last transformed rather than by a queue
+ */
+class FifoCache {
+public:
+    FifoCache(size_t vertexCount, int size) : transformed(vertexCount, 0), size(size), time(size + 1) {}
+
+    /**
+     * Draws a triangle
+     * @param triangle Its three indices
+     * @return Number of its vertices that had to be transformed
+     */
+    int draw(const uint32_t *triangle)
+    {
+        int misses = 0;
+        for(int corner = 0; corner < 3; corner++)
+        {
+            // A vertex is still cached if fewer than size vertices were transformed since it was
+            if(time - transformed[triangle[corner]] > (unsigned int) size)
+            {
+                transformed[triangle[corner]] = time++;
+                misses++;
+            }
+        }
+        return misses;
+    }
+
+    /**
+     * Empties the cache
+     */
+    void clear()
+    {
+        time += size + 1;
+    }
+
+private:
+    std::vector<unsigned int> transformed;
+    int size;
+    unsigned int time;
+};
+
+Mesh MeshOptimiser::optimise(const Mesh &mesh, int positionSize, const std::string &name,
+        const std::vector<size_t> &boundaries)
+{
+    Mesh optimised = mesh;
+    std::vector<size_t> ends = boundaries;
+    ends.push_back(mesh.indices.size());
+    size_t start = 0;
+    for(size_t end : ends)
+    {
+        end = std::min(end, mesh.indices.size());
+        if(end <= start) continue;
+        optimiseVertexCache(optimised.indices.data() + start, end - start, mesh.vertexCount());
+        optimiseOverdraw(optimised.indices.data() + start, end - start, optimised, positionSize);
+        start = end;
+    }
+    optimiseVertexFetch(optimised);
+
+    MeshStats before = analyse(mesh, positionSize);
+    MeshStats after = analyse(optimised, positionSize);
+    std::cout << "INFO::MESH::OPTIMISED " << name << " ACMR " << before.acmr << " to " << after.acmr << ", ATVR "
+              << before.atvr << " to " << after.atvr << ", overdraw " << before.overdraw << " to " << after.overdraw
+              << std::endl;
+    return optimised;
+}
+
+void MeshOptimiser::optimiseVertexCache(uint32_t *indices, size_t indexCount, size_t vertexCount)
+{
+    size_t triangleCount = indexCount / 3;
+    if(triangleCount == 0) return;
+
+    // The triangles not yet drawn of each vertex, packed into one array, the first remaining[v] from offsets[v]
+    std::vector<uint32_t> remaining(vertexCount, 0);
+    for(size_t i = 0; i < triangleCount * 3; i++)
+    {
+        remaining[indices[i]]++;
+    }
+    std::vector<size_t> offsets(vertexCount + 1, 0);
+    for(size_t v = 0; v < vertexCount; v++)
+    {
+        offsets[v + 1] = offsets[v] + remaining[v];
+    }
+    std::vector<uint32_t> adjacency(triangleCount * 3);
+    std::vector<size_t> filled(offsets.begin(), offsets.end() - 1);
+    for(size_t i = 0; i < triangleCount * 3; i++)
+    {
+        adjacency[filled[indices[i]]++] = (uint32_t) (i / 3);
+    }
+
+    std::vector<int> cachePositions(vertexCount, -1);
+    std::vector<float> vertexScores(vertexCount);
+    for(size_t v = 0; v < vertexCount; v++)
+    {
+        vertexScores[v] = vertexScore(-1, remaining[v]);
+    }
+    std::vector<float> triangleScores(triangleCount);
+    for(size_t t = 0; t < triangleCount; t++)
+    {
+        const uint32_t *triangle = indices + t * 3;
+        triangleScores[t] = vertexScores[triangle[0]] + vertexScores[triangle[1]] + vertexScores[triangle[2]];
+    }
+
+    std::vector<uint32_t> output;
+    output.reserve(triangleCount * 3);
+    std::vector<bool> drawn(triangleCount, false);
+    std::vector<uint32_t> cache, nextCache;
+    // When each vertex's score was last updated, so a vertex in both caches is only updated once
+    std::vector<size_t> updated(vertexCount, 0);
+    size_t step = 0;
+    // Next triangle to check when nothing in the cache has triangles left
+    size_t cursor = 0;
+
+    long best = (long) (std::max_element(triangleScores.begin(), triangleScores.end()) - triangleScores.begin());
+    while(output.size() < triangleCount * 3)
+    {
+        if(best < 0)
+        {
+            while(drawn[cursor]) cursor++;
+            best = (long) cursor;
+        }
+        drawn[best] = true;
+        const uint32_t *triangle = indices + best * 3;
+        output.insert(output.end(), triangle, triangle + 3);
+
+        // The triangle's vertices move to the front of the cache, pushing the oldest out
+        nextCache.clear();
+        for(int corner = 0; corner < 3; corner++)
+        {
+            uint32_t vertex = triangle[corner];
+            if(std::find(nextCache.begin(), nextCache.end(), vertex) == nextCache.end()) nextCache.push_back(vertex);
+
+            uint32_t *first = adjacency.data() + offsets[vertex];
+            uint32_t *last = first + remaining[vertex];
+            uint32_t *found = std::find(first, last, (uint32_t) best);
+            std::swap(*found, *(last - 1));
+            remaining[vertex]--;
+        }
+        size_t drawnVertices = nextCache.size();
+        for(uint32_t vertex : cache)
+        {
+            if(nextCache.size() == FORSYTH_CACHE_SIZE) break;
+            auto end = nextCache.begin() + drawnVertices;
+            if(std::find(nextCache.begin(), end, vertex) == end) nextCache.push_back(vertex);
+        }
+
+        // Rescores every vertex that moved in or out of the cache, and the triangles left of each
+        step++;
+        for(uint32_t vertex : cache)
+        {
+            cachePositions[vertex] = -1;
+        }
+        for(size_t i = 0; i < nextCache.size(); i++)
+        {
+            cachePositions[nextCache[i]] = (int) i;
+        }
+        for(const std::vector<uint32_t> *vertices : {&cache, &nextCache})
+        {
+            for(uint32_t vertex : *vertices)
+            {
+                if(updated[vertex] == step) continue;
+                updated[vertex] = step;
+                float score = vertexScore(cachePositions[vertex], remaining[vertex]);
+                float change = score - vertexScores[vertex];
+                vertexScores[vertex] = score;
+                for(size_t i = offsets[vertex]; i < offsets[vertex] + remaining[vertex]; i++)
+                {
+                    triangleScores[adjacency[i]] += change;
+                }
+            }
+        }
+        cache.swap(nextCache);
+
+        // Only triangles of cached vertices can have improved, so the best is found among them
+        best = -1;
+        float bestScore = -1.0f;
+        for(uint32_t vertex : cache)
+        {
+            for(size_t i = offsets[vertex]; i < offsets[vertex] + remaining[vertex]; i++)
+            {
+                if(triangleScores[adjacency[i]] > bestScore)
+                {
+                    bestScore = triangleScores[adjacency[i]];
+                    best = adjacency[i];
+                }
+            }
+        }
+    }
+
+    std::copy(output.begin(), output.end(), indices);
+}
+
+void MeshOptimiser::optimiseOverdraw(uint32_t *indices, size_t indexCount, const Mesh &mesh, int positionSize,
+        double threshold)
+{
+    size_t triangleCount = indexCount / 3;
+    if(triangleCount < 2) return;
+
+    // Hard boundaries are where a triangle misses on every vertex, so the cache is as cold as at a cluster's start
+    std::vector<size_t> hard;
+    std::vector<int> misses(triangleCount);
+    FifoCache cache(mesh.vertexCount(), SIMULATED_CACHE_SIZE);
+    for(size_t t = 0; t < triangleCount; t++)
+    {
+        misses[t] = cache.draw(indices + t * 3);
+        if(t == 0 || misses[t] == 3) hard.push_back(t);
+    }
+    hard.push_back(triangleCount);
+
+    // Soft boundaries split a hard cluster once it has reused vertices nearly as well as the whole cluster does
+    std::vector<size_t> clusters;
+    for(size_t c = 0; c + 1 < hard.size(); c++)
+    {
+        size_t clusterMisses = 0;
+        for(size_t t = hard[c]; t < hard[c + 1]; t++)
+        {
+            clusterMisses += misses[t];
+        }
+        double acmr = clusterMisses / (double) (hard[c + 1] - hard[c]);
+
+        clusters.push_back(hard[c]);
+        cache.clear();
+        size_t softMisses = 0, softTriangles = 0;
+        for(size_t t = hard[c]; t < hard[c + 1]; t++)
+        {
+            softMisses += cache.draw(indices + t * 3);
+            softTriangles++;
+            if(t + 1 < hard[c + 1] && softMisses <= threshold * acmr * softTriangles)
+            {
+                clusters.push_back(t + 1);
+                cache.clear();
+                softMisses = softTriangles = 0;
+            }
+        }
+    }
+    clusters.push_back(triangleCount);
+
+    // Clusters are sorted by how far out they face from the mesh's centre, as those facing out hide those behind
+    glm::vec3 meshCentre(0.0f);
+    double meshArea = 0;
+    std::vector<glm::vec3> centres(clusters.size() - 1, glm::vec3(0.0f)), normals(clusters.size() - 1, glm::vec3(0.0f));
+    std::vector<double> areas(clusters.size() - 1, 0);
+    for(size_t c = 0; c + 1 < clusters.size(); c++)
+    {
+        for(size_t t = clusters[c]; t < clusters[c + 1]; t++)
+        {
+            glm::vec3 a = positionOf(mesh, positionSize, indices[t * 3]);
+            glm::vec3 b = positionOf(mesh, positionSize, indices[t * 3 + 1]);
+            glm::vec3 d = positionOf(mesh, positionSize, indices[t * 3 + 2]);
+            // Twice the area weighted normal
+            glm::vec3 normal = glm::cross(b - a, d - a);
+            float area = glm::length(normal);
+            centres[c] += (a + b + d) / 3.0f * area;
+            normals[c] += normal;
+            areas[c] += area;
+        }
+        meshCentre += centres[c];
+        meshArea += areas[c];
+        if(areas[c] > 0) centres[c] /= (float) areas[c];
+    }
+    if(meshArea > 0) meshCentre /= (float) meshArea;
+
+    std::vector<float> keys(clusters.size() - 1);
+    std::vector<size_t> order(clusters.size() - 1);
+    for(size_t c = 0; c < order.size(); c++)
+    {
+        float length = glm::length(normals[c]);
+        keys[c] = length > 0 ? glm::dot(centres[c] - meshCentre, normals[c] / length) : 0.0f;
+        order[c] = c;
+    }
+    std::stable_sort(order.begin(), order.end(), [&keys](size_t a, size_t b) { return keys[a] > keys[b]; });
+
+    std::vector<uint32_t> sorted;
+    sorted.reserve(triangleCount * 3);
+    for(size_t c : order)
+    {
+        sorted.insert(sorted.end(), indices + clusters[c] * 3, indices + clusters[c + 1] * 3);
+    }
+    std::copy(sorted.begin(), sorted.end(), indices);
+}
+
+void MeshOptimiser::optimiseVertexFetch(Mesh &mesh)
+{
+    size_t vertexCount = mesh.vertexCount();
+    const uint32_t unused = std::numeric_limits<uint32_t>::max();
+    std::vector<uint32_t> remap(vertexCount, unused);
+    uint32_t next = 0;
+    for(uint32_t index : mesh.indices)
+    {
+        if(remap[index] == unused) remap[index] = next++;
+    }
+    for(uint32_t &target : remap)
+    {
+        if(target == unused) target = next++;
+    }
+
+    std::vector<float> vertices(mesh.vertices.size());
+    for(size_t v = 0; v < vertexCount; v++)
+    {
+        std::copy(mesh.vertices.begin() + v * mesh.floatsPerVertex, mesh.vertices.begin() + (v + 1) * mesh.floatsPerVertex,
+                vertices.begin() + (size_t) remap[v] * mesh.floatsPerVertex);
+    }
+    mesh.vertices.swap(vertices);
+    for(uint32_t &index : mesh.indices)
+    {
+        index = remap[index];
+    }
+}
+
+MeshStats MeshOptimiser::analyse(const Mesh &mesh, int positionSize)
+{
+    size_t triangleCount = mesh.indices.size() / 3;
+    size_t misses = simulateVertexCache(mesh.indices.data(), triangleCount * 3, mesh.vertexCount());
+    std::vector<bool> used(mesh.vertexCount(), false);
+    size_t usedCount = 0;
+    for(uint32_t index : mesh.indices)
+    {
+        if(!used[index]) usedCount++;
+        used[index] = true;
+    }
+
+    MeshStats stats{};
+    stats.acmr = triangleCount ? misses / (double) triangleCount : 0;
+    stats.atvr = usedCount ? misses / (double) usedCount : 0;
+    stats.overdraw = simulateOverdraw(mesh, positionSize);
+    return stats;
+}
+
+size_t MeshOptimiser::simulateVertexCache(const uint32_t *indices, size_t indexCount, size_t vertexCount, int cacheSize)
+{
+    FifoCache cache(vertexCount, cacheSize);
+    size_t misses = 0;
+    for(size_t i = 0; i + 3 <= indexCount; i += 3)
+    {
+        misses += cache.draw(indices + i);
+    }
+    return misses;
+}
+
+double MeshOptimiser::simulateOverdraw(const Mesh &mesh, int positionSize)
+{
+    size_t triangleCount = mesh.indices.size() / 3;
+    if(triangleCount == 0) return 0;
+
+    // The mesh is scaled uniformly to fit the grid, so every view has the same pixel size
+    glm::vec3 minimum(std::numeric_limits<float>::max()), maximum(-std::numeric_limits<float>::max());
+    for(uint32_t index : mesh.indices)
+    {
+        glm::vec3 position = positionOf(mesh, positionSize, index);
+        minimum = glm::min(minimum, position);
+        maximum = glm::max(maximum, position);
+    }
+    glm::vec3 extent = maximum - minimum;
+    float scale = std::max(extent.x, std::max(extent.y, extent.z));
+    if(scale <= 0) return 0;
+    scale = OVERDRAW_RESOLUTION / scale;
+
+    const int size = OVERDRAW_RESOLUTION;
+    std::vector<float> depths(size * size);
+    long shaded = 0, covered = 0;
+    for(int axis = 0; axis < 3; axis++)
+    {
+        for(float direction : {1.0f, -1.0f})
+        {
+            std::fill(depths.begin(), depths.end(), std::numeric_limits<float>::max());
+            for(size_t t = 0; t < triangleCount; t++)
+            {
+                // Projected along the axis, x and y in pixels and z the depth towards the viewer
+                glm::vec3 corners[3];
+                for(int corner = 0; corner < 3; corner++)
+                {
+                    glm::vec3 position = (positionOf(mesh, positionSize, mesh.indices[t * 3 + corner]) - minimum) * scale;
+                    corners[corner] = glm::vec3(position[(axis + 1) % 3], position[(axis + 2) % 3], position[axis] * direction);
+                }
+                float area = (corners[1].x - corners[0].x) * (corners[2].y - corners[0].y)
+                        - (corners[2].x - corners[0].x) * (corners[1].y - corners[0].y);
+                // Edge on triangles cover no pixels. Both windings are drawn, as the renderer doesn't cull
+                if(area == 0) continue;
+
+                int left = std::max(0, (int) std::floor(std::min(corners[0].x, std::min(corners[1].x, corners[2].x))));
+                int right = std::min(size - 1, (int) std::ceil(std::max(corners[0].x, std::max(corners[1].x, corners[2].x))));
+                int bottom = std::max(0, (int) std::floor(std::min(corners[0].y, std::min(corners[1].y, corners[2].y))));
+                int top = std::min(size - 1, (int) std::ceil(std::max(corners[0].y, std::max(corners[1].y, corners[2].y))));
+                for(int y = bottom; y <= top; y++)
+                {
+                    for(int x = left; x <= right; x++)
+                    {
+                        // Barycentric weights of the pixel's centre, all positive inside whichever the winding
+                        float px = x + 0.5f, py = y + 0.5f;
+                        float w0 = ((corners[1].x - px) * (corners[2].y - py) - (corners[2].x - px) * (corners[1].y - py)) / area;
+                        float w1 = ((corners[2].x - px) * (corners[0].y - py) - (corners[0].x - px) * (corners[2].y - py)) / area;
+                        float w2 = 1.0f - w0 - w1;
+                        if(w0 < 0 || w1 < 0 || w2 < 0) continue;
+
+                        float depth = w0 * corners[0].z + w1 * corners[1].z + w2 * corners[2].z;
+                        float &stored = depths[y * size + x];
+                        if(depth < stored)
+                        {
+                            stored = depth;
+                            shaded++;
+                        }
+                    }
+                }
+            }
+            for(float depth : depths)
+            {
+                if(depth != std::numeric_limits<float>::max()) covered++;
+            }
+        }
+    }
+    return covered ? shaded / (double) covered : 0;
+}
@@ -0,0 +1,100 @@
+#ifndef OPENGLPROJECT_MESHOPTIMISER_H
+#define OPENGLPROJECT_MESHOPTIMISER_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "MeshBuilder.h"
+
+// Size of the FIFO post-transform cache simulated to measure meshes, typical of desktop GPUs
+const int SIMULATED_CACHE_SIZE = 16;
+// Width and height of the grid each view is rasterised to when measuring overdraw
+const int OVERDRAW_RESOLUTION = 256;
+
+/**
+ * How well a mesh's order suits the GPU, measured on the CPU
+ */
+struct MeshStats {
+    // Average cache miss ratio, vertices transformed per triangle. 0.5 is ideal for a large grid, 3 the worst
+    double acmr;
+    // Average transformed to vertex ratio, vertices transformed per vertex. 1 is ideal
+    double atvr;
+    // Fragments shaded per pixel covered, averaged over views along each axis. 1 is ideal
+    double overdraw;
+};
+
+/**
+ * Reorders a Mesh's triangles and vertices to draw faster, without changing what is drawn
+ *
+ * Triangles are put in an order that reuses vertices still in the post-transform cache, then grouped into clusters
+ * that are sorted so those facing outwards are drawn first and hide more of the rest. Vertices are then put in the
+ * order they are first used, so they are fetched from memory in sequence
+ */
+class MeshOptimiser {
+public:
+    /**
+     * Optimises a mesh for the vertex cache, overdraw and vertex fetch, printing its stats before and after
+     * @param mesh Mesh to optimise
+     * @param positionSize Number of floats in the position, which is at the start of each vertex
+     * @param name Name to print the stats under
+     * @param boundaries Index counts drawn on their own, such as the floor drawn from CubeModel's first 6 indices.
+     * Triangles are never moved across them
+     * @return Optimised mesh
+     */
+    static Mesh optimise(const Mesh &mesh, int positionSize, const std::string &name,
+            const std::vector<size_t> &boundaries = {});
+
+    /**
+     * Reorders triangles to reuse vertices still in the post-transform cache, by Forsyth's scoring of each vertex on
+     * how recently it was used and how many of its triangles are left
+     * @param indices Three indices per triangle
+     * @param indexCount Number of indices
+     * @param vertexCount Number of vertices the indices refer to
+     */
+    static void optimiseVertexCache(uint32_t *indices, size_t indexCount, size_t vertexCount);
+    /**
+     * Splits triangles already ordered for the cache into clusters, where the cache would be cold anyway or the order
+     * reuses vertices well enough, then draws the clusters facing furthest out first. Triangles are taken to wind
+     * anticlockwise seen from outside, as OpenGL's front faces do
+     * @param indices Three indices per triangle
+     * @param indexCount Number of indices
+     * @param mesh Mesh the indices refer to
+     * @param positionSize Number of floats in the position, which is at the start of each vertex
+     * @param threshold How much worse than the cache order's ACMR a cluster may be, so how finely it's split
+     */
+    static void optimiseOverdraw(uint32_t *indices, size_t indexCount, const Mesh &mesh, int positionSize,
+            double threshold = 1.05);
+    /**
+     * Reorders vertices into the order they are first used, updating the indices. Unused vertices go last
+     * @param mesh Mesh to reorder
+     */
+    static void optimiseVertexFetch(Mesh &mesh);
+
+    /**
+     * Measures a mesh with a simulated vertex cache and a software rasteriser
+     * @param mesh Mesh to measure
+     * @param positionSize Number of floats in the position, which is at the start of each vertex
+     * @return Stats of the mesh
+     */
+    static MeshStats analyse(const Mesh &mesh, int positionSize);
+    /**
+     * Counts the vertices a FIFO post-transform cache would transform drawing triangles in order
+     * @param indices Three indices per triangle
+     * @param indexCount Number of indices
+     * @param vertexCount Number of vertices the indices refer to
+     * @param cacheSize Number of vertices the cache holds
+     * @return Number of cache misses
+     */
+    static size_t simulateVertexCache(const uint32_t *indices, size_t indexCount, size_t vertexCount,
+            int cacheSize = SIMULATED_CACHE_SIZE);
+    /**
+     * Rasterises a mesh along each axis in both directions with a depth test, counting the fragments that pass
+     * @param mesh Mesh to draw
+     * @param positionSize Number of floats in the position, which is at the start of each vertex
+     * @return Fragments shaded per pixel covered
+     */
+    static double simulateOverdraw(const Mesh &mesh, int positionSize);
+};
+
+
+#endif //OPENGLPROJECT_MESHOPTIMISER_H
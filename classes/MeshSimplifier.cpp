@@ -0,0 +1,276 @@
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <map>
+#include <tuple>
+#include <glm/glm.hpp>
+#include "MeshSimplifier.h"
+#include "MeshOptimiser.h"
+
+/**
+ * Sum of squared distances to a set of planes, as the symmetric matrix of Garland and Heckbert's quadric error
+ */
+struct Quadric {
+    double xx = 0, xy = 0, xz = 0, xw = 0, yy = 0, yz = 0, yw = 0, zz = 0, zw = 0, ww = 0;
+    // Total weight of the planes, to turn the sum into an average
+    double weight = 0;
+
+    /**
+     * Adds a plane
+     * @param normal Unit normal of the plane
+     * @param distance Signed distance of the plane from the origin along the normal
+     * @param weight Weight of the plane, such as the area of its triangle
+     */
+    void addPlane(glm::dvec3 normal, double distance, double weight)
+    {
+        xx += normal.x * normal.x * weight; xy += normal.x * normal.y * weight; xz += normal.x * normal.z * weight;
+        xw += normal.x * distance * weight; yy += normal.y * normal.y * weight; yz += normal.y * normal.z * weight;
+        yw += normal.y * distance * weight; zz += normal.z * normal.z * weight; zw += normal.z * distance * weight;
+        ww += distance * distance * weight;
+        this->weight += weight;
+    }
+
+    void add(const Quadric &other)
+    {
+        xx += other.xx; xy += other.xy; xz += other.xz; xw += other.xw; yy += other.yy;
+        yz += other.yz; yw += other.yw; zz += other.zz; zw += other.zw; ww += other.ww;
+        weight += other.weight;
+    }
+
+    /**
+     * Evaluates the weighted sum of squared distances from a point to the planes
+     * @param p Point
+     * @return Error of the point
+     */
+    double error(glm::dvec3 p) const
+    {
+        double e = xx * p.x * p.x + 2 * xy * p.x * p.y + 2 * xz * p.x * p.z + 2 * xw * p.x
+                + yy * p.y * p.y + 2 * yz * p.y * p.z + 2 * yw * p.y
+                + zz * p.z * p.z + 2 * zw * p.z + ww;
+        return std::max(e, 0.0);
+    }
+};
+
+/**
+ * Moving one vertex onto another, removing the triangles between them
+ */
+struct Collapse {
+    uint32_t from;
+    uint32_t to;
+    double cost;
+};
+
+/**
+ * Reads the position of a vertex
+ * @param mesh Mesh holding the vertex
+ * @param positionSize Number of floats in the position, which is at the start of each vertex
+ * @param index Index of the vertex
+ * @return Position, with missing components 0
+ */
+static glm::dvec3 positionOf(const Mesh &mesh, int positionSize, uint32_t index)
+{
+    glm::dvec3 position(0.0);
+    const float *vertex = mesh.vertices.data() + (size_t) index * mesh.floatsPerVertex;
+    for(int i = 0; i < std::min(positionSize, 3); i++)
+    {
+        position[i] = vertex[i];
+    }
+    return position;
+}
+
+std::vector<uint32_t> MeshSimplifier::simplify(const Mesh &mesh, const uint32_t *indices, size_t indexCount,
+        int positionSize, size_t targetIndexCount, float *error)
+{
+    size_t vertexCount = mesh.vertexCount();
+    std::vector<uint32_t> result(indices, indices + indexCount / 3 * 3);
+    std::vector<glm::dvec3> positions(vertexCount);
+    for(uint32_t v = 0; v < vertexCount; v++)
+    {
+        positions[v] = positionOf(mesh, positionSize, v);
+    }
+
+    // Vertices sharing a position are at a seam, and vertices on an edge of only one triangle are on the border
+    std::vector<bool> locked(vertexCount, false);
+    std::map<std::tuple<double, double, double>, uint32_t> firstAtPosition;
+    for(uint32_t v = 0; v < vertexCount; v++)
+    {
+        auto inserted = firstAtPosition.emplace(std::make_tuple(positions[v].x, positions[v].y, positions[v].z), v);
+        if(!inserted.second)
+        {
+            locked[v] = true;
+            locked[inserted.first->second] = true;
+        }
+    }
+    std::map<std::pair<uint32_t, uint32_t>, int> edgeUses;
+    for(size_t i = 0; i < result.size(); i += 3)
+    {
+        for(int corner = 0; corner < 3; corner++)
+        {
+            uint32_t a = result[i + corner], b = result[i + (corner + 1) % 3];
+            edgeUses[std::make_pair(std::min(a, b), std::max(a, b))]++;
+        }
+    }
+    for(const auto &edge : edgeUses)
+    {
+        if(edge.second == 1)
+        {
+            locked[edge.first.first] = true;
+            locked[edge.first.second] = true;
+        }
+    }
+
+    // Each vertex starts with the planes of its triangles, weighted by their area
+    std::vector<Quadric> quadrics(vertexCount);
+    for(size_t i = 0; i < result.size(); i += 3)
+    {
+        glm::dvec3 a = positions[result[i]], b = positions[result[i + 1]], c = positions[result[i + 2]];
+        glm::dvec3 normal = glm::cross(b - a, c - a);
+        double length = glm::length(normal);
+        if(length == 0) continue;
+        normal /= length;
+        for(int corner = 0; corner < 3; corner++)
+        {
+            quadrics[result[i + corner]].addPlane(normal, -glm::dot(normal, a), length / 2);
+        }
+    }
+
+    double worst = 0;
+    std::vector<Collapse> collapses;
+    std::vector<uint32_t> remap(vertexCount);
+    std::vector<bool> touched(vertexCount);
+    std::vector<size_t> offsets(vertexCount + 1), filled(vertexCount);
+    std::vector<uint32_t> adjacency;
+    // Collapses are made in passes, each taking the cheapest that don't share any triangles
+    while(result.size() > targetIndexCount)
+    {
+        collapses.clear();
+        for(size_t i = 0; i < result.size(); i += 3)
+        {
+            for(int corner = 0; corner < 3; corner++)
+            {
+                uint32_t a = result[i + corner], b = result[i + (corner + 1) % 3];
+                for(int direction = 0; direction < 2; direction++)
+                {
+                    if(!locked[a])
+                    {
+                        Quadric sum = quadrics[a];
+                        sum.add(quadrics[b]);
+                        collapses.push_back(Collapse{a, b, sum.error(positions[b]) / std::max(sum.weight, 1e-12)});
+                    }
+                    std::swap(a, b);
+                }
+            }
+        }
+        std::sort(collapses.begin(), collapses.end(), [](const Collapse &a, const Collapse &b) { return a.cost < b.cost; });
+
+        // The triangles of each vertex, to check a collapse doesn't fold any over
+        std::fill(offsets.begin(), offsets.end(), 0);
+        for(uint32_t index : result)
+        {
+            offsets[index + 1]++;
+        }
+        for(size_t v = 0; v < vertexCount; v++)
+        {
+            offsets[v + 1] += offsets[v];
+        }
+        adjacency.resize(result.size());
+        std::copy(offsets.begin(), offsets.end() - 1, filled.begin());
+        for(size_t i = 0; i < result.size(); i++)
+        {
+            adjacency[filled[result[i]]++] = (uint32_t) (i / 3);
+        }
+
+        for(uint32_t v = 0; v < vertexCount; v++)
+        {
+            remap[v] = v;
+        }
+        std::fill(touched.begin(), touched.end(), false);
+        size_t toRemove = (result.size() - targetIndexCount) / 3;
+        size_t removed = 0;
+        for(const Collapse &collapse : collapses)
+        {
+            if(removed >= std::max(toRemove, (size_t) 1)) break;
+            if(touched[collapse.from] || touched[collapse.to]) continue;
+
+            bool folds = false;
+            size_t shared = 0;
+            for(size_t i = offsets[collapse.from]; i < offsets[collapse.from + 1] && !folds; i++)
+            {
+                const uint32_t *triangle = result.data() + adjacency[i] * 3;
+                if(triangle[0] == collapse.to || triangle[1] == collapse.to || triangle[2] == collapse.to)
+                {
+                    shared++;
+                    continue;
+                }
+                glm::dvec3 before[3], after[3];
+                for(int corner = 0; corner < 3; corner++)
+                {
+                    before[corner] = positions[triangle[corner]];
+                    after[corner] = triangle[corner] == collapse.from ? positions[collapse.to] : before[corner];
+                }
+                glm::dvec3 normalBefore = glm::cross(before[1] - before[0], before[2] - before[0]);
+                glm::dvec3 normalAfter = glm::cross(after[1] - after[0], after[2] - after[0]);
+                folds = glm::dot(normalBefore, normalAfter) <= 0;
+            }
+            if(folds) continue;
+
+            remap[collapse.from] = collapse.to;
+            quadrics[collapse.to].add(quadrics[collapse.from]);
+            worst = std::max(worst, collapse.cost);
+            removed += shared;
+            // Every vertex whose triangles changed waits for the next pass, when its costs are up to date
+            for(size_t i = offsets[collapse.from]; i < offsets[collapse.from + 1]; i++)
+            {
+                const uint32_t *triangle = result.data() + adjacency[i] * 3;
+                for(int corner = 0; corner < 3; corner++)
+                {
+                    touched[triangle[corner]] = true;
+                }
+            }
+        }
+        if(removed == 0) break;
+
+        // Triangles between collapsed vertices are left with two corners the same, so are dropped
+        size_t kept = 0;
+        for(size_t i = 0; i < result.size(); i += 3)
+        {
+            uint32_t a = remap[result[i]], b = remap[result[i + 1]], c = remap[result[i + 2]];
+            if(a == b || b == c || a == c) continue;
+            result[kept++] = a;
+            result[kept++] = b;
+            result[kept++] = c;
+        }
+        result.resize(kept);
+    }
+
+    *error = (float) std::sqrt(worst);
+    return result;
+}
+
+Mesh MeshSimplifier::generateLods(const Mesh &mesh, int positionSize, const std::string &name, int levels,
+        float reduction)
+{
+    Mesh result = mesh;
+    size_t fullCount = mesh.indices.size();
+    result.lods = {MeshLod{0, fullCount, 0.0f}};
+
+    std::cout << "INFO::MESH::LODS " << name << " " << fullCount / 3;
+    size_t target = fullCount;
+    for(int level = 1; level < levels; level++)
+    {
+        target = (size_t) (target * reduction) / 3 * 3;
+        float error;
+        // Each level is simplified from the full mesh, so its error is measured against the real surface
+        std::vector<uint32_t> indices = MeshSimplifier::simplify(mesh, mesh.indices.data(), fullCount, positionSize,
+                target, &error);
+        const MeshLod &previous = result.lods.back();
+        if(indices.empty() || indices.size() > previous.indexCount * 0.9) break;
+
+        MeshOptimiser::optimiseVertexCache(indices.data(), indices.size(), mesh.vertexCount());
+        result.lods.push_back(MeshLod{result.indices.size(), indices.size(), error});
+        result.indices.insert(result.indices.end(), indices.begin(), indices.end());
+        std::cout << ", " << indices.size() / 3 << " (error " << error << ")";
+    }
+    std::cout << " triangles" << std::endl;
+    return result;
+}
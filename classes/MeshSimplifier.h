@@ -0,0 +1,47 @@
+#ifndef OPENGLPROJECT_MESHSIMPLIFIER_H
+#define OPENGLPROJECT_MESHSIMPLIFIER_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "MeshBuilder.h"
+
+/**
+ * Simplifies meshes by collapsing edges in order of the quadric error each collapse adds, and builds chains of
+ * levels of detail from them
+ *
+ * Each vertex collapses onto a neighbour, so the simplified triangles still draw the mesh's own vertices and a level
+ * of detail needs only its own indices. Vertices on the border of the mesh, and those sharing their position with
+ * another vertex as at a seam in the normals or texture coordinates, never move, so the outline and seams are kept
+ */
+class MeshSimplifier {
+public:
+    /**
+     * Removes triangles until there are at most a target number left, or no collapse is left that keeps the surface
+     * from folding over
+     * @param mesh Mesh holding the vertices
+     * @param indices Three indices per triangle
+     * @param indexCount Number of indices
+     * @param positionSize Number of floats in the position, which is at the start of each vertex
+     * @param targetIndexCount Number of indices to reduce to
+     * @param error Location to store how far the result strays from the original surface, in the mesh's units
+     * @return Indices of the simplified triangles
+     */
+    static std::vector<uint32_t> simplify(const Mesh &mesh, const uint32_t *indices, size_t indexCount,
+            int positionSize, size_t targetIndexCount, float *error);
+    /**
+     * Adds levels of detail to a mesh, each with a fraction of the triangles of the one before, printing their sizes.
+     * The chain stops early once the mesh can't be simplified much further
+     * @param mesh Mesh to simplify. Its indices must be only the full mesh
+     * @param positionSize Number of floats in the position, which is at the start of each vertex
+     * @param name Name to print the levels under
+     * @param levels Most levels to make, including the full mesh
+     * @param reduction Fraction of the triangles each level keeps of the one before
+     * @return Mesh with the coarser levels' indices after its own, and every level in lods
+     */
+    static Mesh generateLods(const Mesh &mesh, int positionSize, const std::string &name, int levels = 4,
+            float reduction = 0.5f);
+};
+
+
+#endif //OPENGLPROJECT_MESHSIMPLIFIER_H
@@ -0,0 +1,218 @@
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <limits>
+#include "MeshletBuilder.h"
+
+/**
+ * Reads the position of a vertex
+ * @param mesh Mesh holding the vertex
+ * @param positionSize Number of floats in the position, which is at the start of each vertex
+ * @param index Index of the vertex
+ * @return Position, with missing components 0
+ */
+static glm::vec3 positionOf(const Mesh &mesh, int positionSize, uint32_t index)
+{
+    glm::vec3 position(0.0f);
+    const float *vertex = mesh.vertices.data() + (size_t) index * mesh.floatsPerVertex;
+    for(int i = 0; i < std::min(positionSize, 3); i++)
+    {
+        position[i] = vertex[i];
+    }
+    return position;
+}
+
+Mesh MeshletBuilder::build(const Mesh &mesh, int positionSize, const std::string &name, int maxVertices,
+        int maxTriangles)
+{
+    Mesh result = mesh;
+    result.meshlets.clear();
+    if(result.lods.empty()) result.lods.push_back(MeshLod{0, result.indices.size(), 0.0f});
+
+    std::cout << "INFO::MESH::MESHLETS " << name << " ";
+    for(MeshLod &lod : result.lods)
+    {
+        std::vector<Meshlet> meshlets = split(result.indices.data() + lod.firstIndex, lod.indexCount, result,
+                positionSize, maxVertices, maxTriangles, lod.firstIndex);
+        lod.firstMeshlet = result.meshlets.size();
+        lod.meshletCount = meshlets.size();
+        result.meshlets.insert(result.meshlets.end(), meshlets.begin(), meshlets.end());
+        std::cout << (&lod == &result.lods.front() ? "" : ", ") << meshlets.size();
+    }
+
+    size_t triangles = 0, cones = 0;
+    for(const Meshlet &meshlet : result.meshlets)
+    {
+        triangles += meshlet.indexCount / 3;
+        if(meshlet.coneCutoff < 1.0f) cones++;
+    }
+    std::cout << " meshlets averaging " << triangles / std::max(result.meshlets.size(), (size_t) 1)
+              << " triangles, " << cones << " of " << result.meshlets.size() << " able to be culled facing away"
+              << std::endl;
+    return result;
+}
+
+std::vector<Meshlet> MeshletBuilder::split(uint32_t *indices, size_t indexCount, const Mesh &mesh, int positionSize,
+        int maxVertices, int maxTriangles, size_t firstIndex)
+{
+    size_t triangleCount = indexCount / 3;
+    size_t vertexCount = mesh.vertexCount();
+
+    std::vector<glm::vec3> normals(triangleCount);
+    for(size_t t = 0; t < triangleCount; t++)
+    {
+        glm::vec3 a = positionOf(mesh, positionSize, indices[t * 3]);
+        glm::vec3 b = positionOf(mesh, positionSize, indices[t * 3 + 1]);
+        glm::vec3 c = positionOf(mesh, positionSize, indices[t * 3 + 2]);
+        glm::vec3 normal = glm::cross(b - a, c - a);
+        float length = glm::length(normal);
+        // Degenerate triangles face nowhere, so never narrow a cone
+        normals[t] = length > 0 ? normal / length : glm::vec3(0.0f);
+    }
+
+    // The triangles of each vertex, to find a meshlet's neighbours
+    std::vector<size_t> offsets(vertexCount + 1, 0);
+    for(size_t i = 0; i < triangleCount * 3; i++)
+    {
+        offsets[indices[i] + 1]++;
+    }
+    for(size_t v = 0; v < vertexCount; v++)
+    {
+        offsets[v + 1] += offsets[v];
+    }
+    std::vector<uint32_t> adjacency(triangleCount * 3);
+    std::vector<size_t> filled(offsets.begin(), offsets.end() - 1);
+    for(size_t i = 0; i < triangleCount * 3; i++)
+    {
+        adjacency[filled[indices[i]]++] = (uint32_t) (i / 3);
+    }
+
+    std::vector<Meshlet> meshlets;
+    std::vector<uint32_t> ordered;
+    ordered.reserve(triangleCount * 3);
+    std::vector<bool> emitted(triangleCount, false);
+    // Number of the meshlet each vertex was last added to
+    std::vector<uint32_t> meshletOf(vertexCount, std::numeric_limits<uint32_t>::max());
+    std::vector<uint32_t> vertices, triangles, candidates;
+    glm::vec3 normalSum(0.0f);
+    size_t remaining = triangleCount, next = 0;
+
+    auto add = [&](uint32_t triangle) {
+        emitted[triangle] = true;
+        remaining--;
+        triangles.push_back(triangle);
+        normalSum += normals[triangle];
+        for(int corner = 0; corner < 3; corner++)
+        {
+            uint32_t vertex = indices[triangle * 3 + corner];
+            if(meshletOf[vertex] == meshlets.size()) continue;
+            meshletOf[vertex] = (uint32_t) meshlets.size();
+            vertices.push_back(vertex);
+            for(size_t i = offsets[vertex]; i < offsets[vertex + 1]; i++)
+            {
+                if(!emitted[adjacency[i]]) candidates.push_back(adjacency[i]);
+            }
+        }
+    };
+    auto finish = [&]() {
+        Meshlet meshlet{};
+        meshlet.firstIndex = firstIndex + ordered.size();
+        meshlet.indexCount = triangles.size() * 3;
+        for(uint32_t triangle : triangles)
+        {
+            ordered.insert(ordered.end(), indices + triangle * 3, indices + triangle * 3 + 3);
+        }
+
+        glm::vec3 minimum = positionOf(mesh, positionSize, vertices[0]), maximum = minimum;
+        for(uint32_t vertex : vertices)
+        {
+            minimum = glm::min(minimum, positionOf(mesh, positionSize, vertex));
+            maximum = glm::max(maximum, positionOf(mesh, positionSize, vertex));
+        }
+        glm::vec3 centre = (minimum + maximum) * 0.5f;
+        float radius = 0;
+        for(uint32_t vertex : vertices)
+        {
+            radius = std::max(radius, glm::length(positionOf(mesh, positionSize, vertex) - centre));
+        }
+        meshlet.bounds = glm::vec4(centre, radius);
+
+        // The cone holds every normal, and is only worth testing if it's narrower than a hemisphere
+        float length = glm::length(normalSum);
+        meshlet.coneAxis = length > 1e-6f ? normalSum / length : glm::vec3(0.0f);
+        float minimumDot = length > 1e-6f ? 1.0f : -1.0f;
+        for(uint32_t triangle : triangles)
+        {
+            if(normals[triangle] != glm::vec3(0.0f)) minimumDot = std::min(minimumDot, glm::dot(meshlet.coneAxis, normals[triangle]));
+        }
+        meshlet.coneCutoff = minimumDot > 0 ? std::sqrt(1.0f - minimumDot * minimumDot) : 1.0f;
+        meshlets.push_back(meshlet);
+
+        vertices.clear();
+        triangles.clear();
+        normalSum = glm::vec3(0.0f);
+    };
+
+    while(remaining > 0)
+    {
+        // The best neighbour shares the most vertices, then faces most like the meshlet
+        glm::vec3 axis = glm::length(normalSum) > 1e-6f ? glm::normalize(normalSum) : glm::vec3(0.0f);
+        long best = -1;
+        float bestScore = std::numeric_limits<float>::max();
+        size_t kept = 0;
+        if((int) triangles.size() < maxTriangles)
+        {
+            for(uint32_t triangle : candidates)
+            {
+                if(emitted[triangle]) continue;
+                candidates[kept++] = triangle;
+                int added = 0;
+                for(int corner = 0; corner < 3; corner++)
+                {
+                    if(meshletOf[indices[triangle * 3 + corner]] != meshlets.size()) added++;
+                }
+                if((int) vertices.size() + added > maxVertices) continue;
+                float score = added + (1.0f - glm::dot(normals[triangle], axis));
+                if(score < bestScore)
+                {
+                    best = triangle;
+                    bestScore = score;
+                }
+            }
+            candidates.resize(kept);
+        }
+        if(best >= 0)
+        {
+            add((uint32_t) best);
+            continue;
+        }
+
+        // A full meshlet's neighbours seed the next, so it starts beside it rather than anywhere left
+        uint32_t seed = 0;
+        bool seeded = false;
+        if(!triangles.empty())
+        {
+            finish();
+            for(uint32_t triangle : candidates)
+            {
+                if(!emitted[triangle])
+                {
+                    seed = triangle;
+                    seeded = true;
+                    break;
+                }
+            }
+        }
+        candidates.clear();
+        if(!seeded)
+        {
+            while(emitted[next]) next++;
+            seed = (uint32_t) next;
+        }
+        add(seed);
+    }
+    if(!triangles.empty()) finish();
+
+    std::copy(ordered.begin(), ordered.end(), indices);
+    return meshlets;
+}
@@ -0,0 +1,54 @@
+#ifndef OPENGLPROJECT_MESHLETBUILDER_H
+#define OPENGLPROJECT_MESHLETBUILDER_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "MeshBuilder.h"
+
+// Most vertices a meshlet may use
+const int MESHLET_MAX_VERTICES = 64;
+// Most triangles a meshlet may hold
+const int MESHLET_MAX_TRIANGLES = 124;
+
+/**
+ * Splits dense meshes into meshlets, small clusters of neighbouring triangles that can each be culled on their own
+ *
+ * A meshlet grows from a triangle by adding the neighbour that uses the fewest new vertices and faces most like the
+ * triangles already in it, so meshlets are compact and their normals close together. Each level of detail is split
+ * separately, and its triangles are reordered so each meshlet's indices are one range, which is drawn by itself or
+ * with the meshlets on either side
+ */
+class MeshletBuilder {
+public:
+    /**
+     * Splits every level of detail of a mesh into meshlets, printing how full they are and how many could be culled
+     * by their normals. Triangles are reordered within each level, so a mesh drawn from some of its indices, such as
+     * CubeModel for the floor, shouldn't be split
+     * @param mesh Mesh to split. Triangles are taken to wind anticlockwise seen from outside, as OpenGL's front faces do
+     * @param positionSize Number of floats in the position, which is at the start of each vertex
+     * @param name Name to print the meshlets under
+     * @param maxVertices Most vertices a meshlet may use
+     * @param maxTriangles Most triangles a meshlet may hold
+     * @return Mesh with its meshlets, and the range of them covering each level in lods
+     */
+    static Mesh build(const Mesh &mesh, int positionSize, const std::string &name,
+            int maxVertices = MESHLET_MAX_VERTICES, int maxTriangles = MESHLET_MAX_TRIANGLES);
+
+    /**
+     * Splits triangles into meshlets, reordering them so each meshlet is a range of the indices
+     * @param indices Three indices per triangle
+     * @param indexCount Number of indices
+     * @param mesh Mesh the indices refer to
+     * @param positionSize Number of floats in the position, which is at the start of each vertex
+     * @param maxVertices Most vertices a meshlet may use
+     * @param maxTriangles Most triangles a meshlet may hold
+     * @param firstIndex Index of indices in the mesh, which the meshlets' ranges start from
+     * @return Meshlets, in the order of their ranges
+     */
+    static std::vector<Meshlet> split(uint32_t *indices, size_t indexCount, const Mesh &mesh, int positionSize,
+            int maxVertices, int maxTriangles, size_t firstIndex);
+};
+
+
+#endif //OPENGLPROJECT_MESHLETBUILDER_H
@@ -0,0 +1,111 @@
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include "MeshletCuller.h"
+
+void MeshletCuller::setView(const glm::mat4 &viewProjection, glm::vec3 viewPos)
+{
+    this->viewPos = viewPos;
+    // Each plane is the last row of the matrix plus or minus another, as clip space is bounded by -w and w
+    glm::vec4 rows[4];
+    for(int i = 0; i < 4; i++)
+    {
+        rows[i] = glm::vec4(viewProjection[0][i], viewProjection[1][i], viewProjection[2][i], viewProjection[3][i]);
+    }
+    for(int i = 0; i < 3; i++)
+    {
+        planes[i * 2] = rows[3] + rows[i];
+        planes[i * 2 + 1] = rows[3] - rows[i];
+    }
+    for(glm::vec4 &plane : planes)
+    {
+        plane /= glm::length(glm::vec3(plane));
+    }
+}
+
+void MeshletCuller::cull(const Model &model, const MeshLod &lod, const glm::mat4 &transform,
+        std::vector<MeshLod> &visible)
+{
+    auto start = std::chrono::steady_clock::now();
+    visible.clear();
+    const Meshlet *meshlets = model.getMeshlets().data() + lod.firstMeshlet;
+    float scale = std::max({glm::length(glm::vec3(transform[0])), glm::length(glm::vec3(transform[1])),
+            glm::length(glm::vec3(transform[2]))});
+    stats.meshlets += lod.meshletCount;
+    stats.triangles += lod.indexCount / 3;
+
+    // A model wholly outside the frustum needn't have its meshlets tested
+    const glm::vec4 &bounds = model.getBounds();
+    if(outside(glm::vec3(transform * glm::vec4(glm::vec3(bounds), 1.0f)), bounds.w * scale))
+    {
+        stats.frustumCulled += lod.meshletCount;
+        stats.trianglesCulled += lod.indexCount / 3;
+        stats.milliseconds += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        return;
+    }
+
+    // Cones are tested in the model's space, where its transform can't skew them. A mirroring transform turns
+    // triangles to face the other way, so their cones can't be trusted
+    bool cones = coneCulling && glm::determinant(glm::mat3(transform)) > 0;
+    glm::vec3 eye = glm::vec3(glm::inverse(transform) * glm::vec4(viewPos, 1.0f));
+    for(size_t i = 0; i < lod.meshletCount; i++)
+    {
+        const Meshlet &meshlet = meshlets[i];
+        glm::vec3 centre = glm::vec3(meshlet.bounds);
+        bool culled = false;
+        if(outside(glm::vec3(transform * glm::vec4(centre, 1.0f)), meshlet.bounds.w * scale))
+        {
+            stats.frustumCulled++;
+            culled = true;
+        }
+        else if(cones && meshlet.coneCutoff < 1.0f)
+        {
+            // Seen from the viewer, every point of the bounds lies within the directions every triangle faces away from
+            glm::vec3 toCentre = centre - eye;
+            if(glm::dot(toCentre, meshlet.coneAxis) - meshlet.bounds.w
+                    > meshlet.coneCutoff * (glm::length(toCentre) + meshlet.bounds.w))
+            {
+                stats.coneCulled++;
+                culled = true;
+            }
+        }
+        if(culled)
+        {
+            stats.trianglesCulled += meshlet.indexCount / 3;
+            continue;
+        }
+
+        if(!visible.empty() && visible.back().firstIndex + visible.back().indexCount == meshlet.firstIndex)
+        {
+            visible.back().indexCount += meshlet.indexCount;
+        }
+        else
+        {
+            visible.push_back(MeshLod{meshlet.firstIndex, meshlet.indexCount, lod.error});
+        }
+    }
+    stats.milliseconds += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+bool MeshletCuller::outside(glm::vec3 centre, float radius) const
+{
+    for(const glm::vec4 &plane : planes)
+    {
+        if(glm::dot(glm::vec3(plane), centre) + plane.w < -radius) return true;
+    }
+    return false;
+}
+
+const MeshletCuller::Stats &MeshletCuller::getStats() const
+{
+    return stats;
+}
+
+void MeshletCuller::report() const
+{
+    if(stats.meshlets == 0) return;
+    std::cout << "INFO::MESHLETS " << stats.meshlets << " tested, " << stats.frustumCulled << " outside the view and "
+              << stats.coneCulled << " facing away, " << stats.trianglesCulled << " of " << stats.triangles
+              << " triangles rejected in " << stats.milliseconds << "ms, "
+              << stats.milliseconds * 1000000 / stats.triangles << "ms per million triangles" << std::endl;
+}
@@ -0,0 +1,76 @@
+#ifndef OPENGLPROJECT_MESHLETCULLER_H
+#define OPENGLPROJECT_MESHLETCULLER_H
+
+#include <glm/glm.hpp>
+#include <vector>
+#include "Model.h"
+
+/**
+ * Rejects the meshlets of a model that can't be seen from a view, before their draws are built
+ *
+ * A meshlet is rejected if its bounding sphere is outside any plane of the view's frustum, or if its normal cone
+ * shows every triangle faces away from the viewer. Facing away only hides a meshlet behind the rest of the mesh, so
+ * models are only split into meshlets where they are closed and opaque
+ */
+class MeshletCuller {
+public:
+    /**
+     * Meshlets and triangles tested and rejected
+     */
+    struct Stats {
+        size_t meshlets = 0;
+        size_t frustumCulled = 0;
+        size_t coneCulled = 0;
+        size_t triangles = 0;
+        size_t trianglesCulled = 0;
+        // Time spent testing
+        double milliseconds = 0;
+    };
+
+    // Whether meshlets facing away from the viewer are rejected
+    bool coneCulling = true;
+
+    /**
+     * Sets the view to cull against, such as the camera's or, for the shadow pass, the light's
+     * @param viewProjection Transform from world space to the view's clip space
+     * @param viewPos Position of the viewer in world space
+     */
+    void setView(const glm::mat4 &viewProjection, glm::vec3 viewPos);
+    /**
+     * Finds the meshlets of a level of detail that can be seen
+     * @param model Model to draw
+     * @param lod One of the model's levels of detail, which must have been split into meshlets
+     * @param transform Model matrix of the object
+     * @param visible Location to store the ranges of the level's indices to draw, consecutive visible meshlets merged
+     * into one range
+     */
+    void cull(const Model &model, const MeshLod &lod, const glm::mat4 &transform, std::vector<MeshLod> &visible);
+
+    /**
+     * Gets the totals since the culler was created
+     * @return Meshlets and triangles tested and rejected
+     */
+    const Stats &getStats() const;
+    /**
+     * Prints the share of triangles rejected and the time taken per million tested
+     */
+    void report() const;
+
+private:
+    // Planes of the frustum in world space, facing inwards with unit normals. Until a view is set, nothing is outside
+    glm::vec4 planes[6] = {glm::vec4(0, 0, 0, 1), glm::vec4(0, 0, 0, 1), glm::vec4(0, 0, 0, 1),
+            glm::vec4(0, 0, 0, 1), glm::vec4(0, 0, 0, 1), glm::vec4(0, 0, 0, 1)};
+    glm::vec3 viewPos = glm::vec3(0.0f);
+    Stats stats;
+
+    /**
+     * Checks whether a sphere is entirely outside the frustum
+     * @param centre Centre of the sphere in world space
+     * @param radius Radius of the sphere
+     * @return Whether the sphere can't be seen
+     */
+    bool outside(glm::vec3 centre, float radius) const;
+};
+
+
+#endif //OPENGLPROJECT_MESHLETCULLER_H
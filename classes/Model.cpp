@@ -1,61 +1,177 @@
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtc/type_ptr.hpp>
 #include "Model.h"
+#include "ShaderProfiler.h"
 
-Model::Model(float vertices[], int length)
+Model::Model(const Mesh &mesh, const VertexLayout &layout)
 {
-    // Generates a Vertex Array Object
-    glGenVertexArrays(1, &VAO);
-    // Generates the Vertex Buffer Objects
-    glGenBuffers(1, &VBO);
+    upload(mesh.vertices.data(), layout, mesh);
+}
+
+Model::Model(const Mesh &mesh, const std::vector<PackedAttribute> &format, const std::string &name)
+{
+    PackedVertices packed = VertexPacker::pack(mesh, format, name);
+    upload(packed.data.data(), packed.layout, mesh);
+    dequantisation = packed.dequantisation;
+}
+
+Model::Model(const MeshFile &file)
+{
+    // A file that failed to load leaves the model empty, drawing nothing, as every getter of the file needs its header
+    if(!file.isOpen())
+    {
+        std::cerr << "ERROR::MODEL::MESH_FILE_NOT_OPEN" << std::endl;
+        upload(nullptr, VertexLayout{3 * sizeof(float), {{0, 3, GL_FLOAT, 0}}}, Mesh());
+        return;
+    }
+    // The vertices and indices are uploaded straight from the mapped file
+    arena = &GeometryArena::get(file.getLayout(), file.getIndexType());
+    allocation = arena->allocate(file.getVertices(), file.getVertexCount(), file.getIndices(), file.getIndexCount());
+    dequantisation = file.getDequantisation();
+    lods = file.getLods();
+    meshlets = file.getMeshlets();
+    bounds = file.getBounds();
+}
+
+void Model::upload(const void *vertices, const VertexLayout &layout, const Mesh &mesh)
+{
+    arena = &GeometryArena::get(layout, mesh.indexType());
+    std::vector<unsigned char> indices = mesh.indexData();
+    allocation = arena->allocate(vertices, mesh.vertexCount(), indices.data(), mesh.indices.size());
 
-    // Bind the Vertex Array Object first, then bind and set vertex buffer(s), and then configure vertex attributes(s).
-    // Binds the VAO so glVertexAttribPointer and glEnableVertexAttribArray work on this VAO
-    glBindVertexArray(VAO);
+    lods = mesh.lods;
+    if(lods.empty()) lods.push_back(MeshLod{0, mesh.indices.size(), 0.0f});
+    meshlets = mesh.meshlets;
 
-    // Binds the buffer to the buffer type so glBufferData works on this
-    glBindBuffer(GL_ARRAY_BUFFER, VBO);
-    // Allocates memory for and stores the vertices data
-    glBufferData(GL_ARRAY_BUFFER, length * sizeof(*vertices), vertices, GL_STATIC_DRAW);
+    // The mesh's floats are the positions before any packing, which the model matrix applies to
+    int positionSize = 0;
+    for(const VertexAttribute &attribute : layout.attributes)
+    {
+        if(attribute.location == 0) positionSize = attribute.size;
+    }
+    bounds = mesh.bounds(positionSize);
 }
 
 Model::~Model()
 {
-    // Deletes VAO and VBO data from memory
-    glDeleteVertexArrays(1, &VAO);
-    glDeleteBuffers(1, &VBO);
+    if(arena) arena->free(allocation);
+}
+
+Model::Model(Model &&other) noexcept : arena(other.arena), allocation(other.allocation),
+        dequantisation(other.dequantisation), lods(std::move(other.lods)), meshlets(std::move(other.meshlets)),
+        bounds(other.bounds)
+{
+    other.arena = nullptr;
 }
 
-void Model::draw(glm::vec3 position, Shader shader, int vertices)
+Model &Model::operator=(Model &&other) noexcept
+{
+    if(this == &other) return *this;
+    if(arena) arena->free(allocation);
+    arena = other.arena;
+    allocation = other.allocation;
+    dequantisation = other.dequantisation;
+    lods = std::move(other.lods);
+    meshlets = std::move(other.meshlets);
+    bounds = other.bounds;
+    other.arena = nullptr;
+    return *this;
+}
+
+void Model::draw(glm::vec3 position, const Shader &shader, int vertices)
 {
     // Creates the model matrix by translating by coordinates
     glm::mat4 model = glm::mat4(1.0f);
     model = glm::translate(model, position);
-    int modelLoc = glGetUniformLocation(shader.ID, "model");
 
-    // Sets the relative shader3d uniform
-    glUniformMatrix4fv(modelLoc, 1, GL_FALSE, glm::value_ptr(model));
+    // Sets the relative shader3d uniform, restoring quantised positions first
+    shader.setMat4("model"_u, model * dequantisation);
 
     // Draws the model
-    glDrawArrays(GL_TRIANGLES, 0, vertices);
+    drawMesh(vertices);
 }
 
-void Model::drawS(glm::vec3 position, Shader shader, int vertices, float size)
+void Model::drawS(glm::vec3 position, const Shader &shader, int vertices, float size)
 {
     // Creates the model matrix by translating by coordinates
     glm::mat4 model = glm::mat4(1.0f);
     model = glm::translate(model, position);
     model = glm::scale(model, glm::vec3(size));
-    int modelLoc = glGetUniformLocation(shader.ID, "model");
 
-    // Sets the relative shader3d uniform
-    glUniformMatrix4fv(modelLoc, 1, GL_FALSE, glm::value_ptr(model));
+    // Sets the relative shader3d uniform, restoring quantised positions first
+    shader.setMat4("model"_u, model * dequantisation);
 
     // Draws the model
-    glDrawArrays(GL_TRIANGLES, 0, vertices);
+    drawMesh(vertices);
 }
 
 void Model::bind()
 {
-    glBindVertexArray(VAO);
-}
\ No newline at end of file
+    arena->bind();
+}
+
+const glm::mat4 &Model::getDequantisation() const
+{
+    return dequantisation;
+}
+
+GeometryArena &Model::getArena() const
+{
+    return *arena;
+}
+
+int Model::getBaseVertex() const
+{
+    return arena->getBaseVertex(allocation);
+}
+
+size_t Model::getFirstIndex() const
+{
+    return arena->getFirstIndex(allocation);
+}
+
+const std::vector<MeshLod> &Model::getLods() const
+{
+    return lods;
+}
+
+const std::vector<Meshlet> &Model::getMeshlets() const
+{
+    return meshlets;
+}
+
+const glm::vec4 &Model::getBounds() const
+{
+    return bounds;
+}
+
+void Model::drawMesh(int vertices) const
+{
+    ShaderProfiler::drawElements(GL_TRIANGLES, vertices, arena->getIndexType(), arena->getIndexOffset(allocation),
+            arena->getBaseVertex(allocation));
+}
+
+void Model::drawInstanced(int vertices, const glm::mat4 *transforms, size_t count, const glm::vec4 *colours)
+{
+    if(count == 0) return;
+
+    // Quantised positions are restored by each transform, as the shader has no separate matrix for it
+    if(dequantisation != glm::mat4(1.0f))
+    {
+        dequantised.resize(count);
+        for(size_t i = 0; i < count; i++)
+        {
+            dequantised[i] = transforms[i] * dequantisation;
+        }
+        transforms = dequantised.data();
+    }
+
+    arena->setInstances(transforms, count, colours);
+    ShaderProfiler::drawElementsInstanced(GL_TRIANGLES, vertices, arena->getIndexType(),
+            arena->getIndexOffset(allocation), (int) count, arena->getBaseVertex(allocation));
+}
+
+const VertexLayout &Model::getLayout() const
+{
+    return arena->getLayout();
+}
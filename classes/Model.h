@@ -3,24 +3,50 @@
 
 #include <glm/glm.hpp>
 #include "Shader.h"
+#include "VertexLayout.h"
+#include "MeshBuilder.h"
+#include "MeshOptimiser.h"
+#include "MeshSimplifier.h"
+#include "MeshletBuilder.h"
+#include "VertexPacker.h"
+#include "GeometryArena.h"
+#include "MeshFile.h"
 
 /**
  * Represents a specific shape type
  *
- * Holds reused information to make copies of the same shape with different positions
+ * Holds reused information to make copies of the same shape with different positions. The geometry is kept in the
+ * GeometryArena for its vertex format, shared with every other model of that format
  */
 class Model {
 public:
     /**
-     * Builds a model with the given Vertices
-     * @param vertices Vertices of the points
-     * @param length Length of the vertex array
+     * Builds a model from float vertices
+     * @param mesh Vertices and the indices of each triangle
+     * @param layout Layout of each vertex of the mesh
      */
-    Model(float vertices[], int length);
+    Model(const Mesh &mesh, const VertexLayout &layout);
     /**
-     * Deletes saved resources
+     * Builds a model, packing its vertices into a smaller format
+     * @param mesh Vertices and the indices of each triangle
+     * @param format Attributes to keep and how to store each
+     * @param name Name to print the reduction under
      */
-    ~Model();
+    Model(const Mesh &mesh, const std::vector<PackedAttribute> &format, const std::string &name);
+    /**
+     * Loads a model from a mesh file, uploading its vertices and indices without copying them
+     * @param file Mesh file, which needn't outlive the model. The model is left empty if the file isn't open
+     */
+    explicit Model(const MeshFile &file);
+    /**
+     * Frees the model's space in the arena
+     */
+    virtual ~Model();
+    // A Model owns its space in the arena, so is moved rather than copied. A moved from Model owns nothing
+    Model(const Model &) = delete;
+    Model &operator=(const Model &) = delete;
+    Model(Model &&other) noexcept;
+    Model &operator=(Model &&other) noexcept;
 
     /**
      * Draws the model to the screen at the given position
@@ -28,16 +54,16 @@ public:
      * @param shader Shader to draw using
      * @param vertices Number of vertices to draw
      */
-    void draw(glm::vec3 position, Shader shader, int vertices);
+    void draw(glm::vec3 position, const Shader &shader, int vertices);
 
-    void drawS(glm::vec3 position, Shader shader, int vertices, float size);
+    void drawS(glm::vec3 position, const Shader &shader, int vertices, float size);
 
     /**
      * Draws the model to the screen at the given position
      * @param position Position to draw to the screen
      * @param shader Shader to draw using
      */
-    virtual void draw(glm::vec3 position, Shader shader) = 0;
+    virtual void draw(glm::vec3 position, const Shader &shader) = 0;
 
     /**
      * Draws the model to the screen at the given position
@@ -46,18 +72,91 @@ public:
      * @param size Size of shape
      * @param shader Shader to draw using
      */
-    virtual void draw(glm::vec2 position, glm::vec2 screen, glm::vec2 size, Shader shader) = 0;
+    virtual void draw(glm::vec2 position, glm::vec2 screen, glm::vec2 size, const Shader &shader) = 0;
 
-    virtual void drawS(glm::vec3 position, Shader shader, float size) = 0;
+    virtual void drawS(glm::vec3 position, const Shader &shader, float size) = 0;
 
     /**
-     * Binds the VAO
+     * Binds the VAO of the model's arena, shared with every model of the same vertex format
      */
     void bind();
+    /**
+     * Draws the model with the shader in use. The VAO must be bound
+     * @param vertices Number of vertices to draw from the start of the triangle list
+     */
+    void drawMesh(int vertices) const;
+    /**
+     * Draws many copies of the model in one draw call with the shader in use, which must read its transform from
+     * the per-instance attributes. Shaders built with INSTANCED defined do so. Binds the VAO
+     * @param vertices Number of vertices to draw of each copy, from the start of the triangle list
+     * @param transforms Model matrix of each copy, contiguous
+     * @param count Number of copies
+     * @param colours Colour of each copy, contiguous, or nullptr to draw every copy white
+     */
+    void drawInstanced(int vertices, const glm::mat4 *transforms, size_t count, const glm::vec4 *colours = nullptr);
+
+    /**
+     * Gets how the VAO reads the vertex buffer, including the per-instance attributes, to check shaders against
+     * @return Vertex layout
+     */
+    const VertexLayout &getLayout() const;
+    /**
+     * Gets the transform restoring quantised positions to where they were built. Model matrices set without draw
+     * must be multiplied by it
+     * @return Dequantisation matrix, the identity if positions aren't quantised
+     */
+    const glm::mat4 &getDequantisation() const;
+    /**
+     * Gets the arena holding the model, shared with every model of the same vertex format
+     * @return Arena of the model
+     */
+    GeometryArena &getArena() const;
+    /**
+     * Gets where the model's vertices start in its arena
+     * @return Base vertex to draw the model with
+     */
+    int getBaseVertex() const;
+    /**
+     * Gets where the model's indices start in its arena
+     * @return Index of the model's first index
+     */
+    size_t getFirstIndex() const;
+    /**
+     * Gets the model's levels of detail, finest first. There is always at least the full mesh
+     * @return Range of the model's indices and error of each level
+     */
+    const std::vector<MeshLod> &getLods() const;
+    /**
+     * Gets the meshlets the model's levels of detail were split into, which each level gives the range of
+     * @return Meshlets of the model, empty if it wasn't split
+     */
+    const std::vector<Meshlet> &getMeshlets() const;
+    /**
+     * Gets a sphere around every vertex of the model, before any model matrix
+     * @return Centre of the sphere, and its radius as w
+     */
+    const glm::vec4 &getBounds() const;
 
 protected:
-    unsigned int VAO;
-    unsigned int VBO;
+    // Arena holding the model's vertices and indices, or nullptr if moved from
+    GeometryArena *arena = nullptr;
+    unsigned int allocation = 0;
+    glm::mat4 dequantisation = glm::mat4(1.0f);
+    std::vector<MeshLod> lods;
+    std::vector<Meshlet> meshlets;
+    glm::vec4 bounds = glm::vec4(0.0f);
+    // Transforms with the dequantisation applied, kept to avoid allocating each draw
+    std::vector<glm::mat4> dequantised;
+
+private:
+    /**
+     * Copies the model's vertices and indices into the arena for their format, and keeps its levels of detail,
+     * meshlets and bounds
+     * @param vertices Vertex data
+     * @param layout Layout of each vertex, whose position is at location 0
+     * @param mesh Mesh to take the indices and positions from
+     */
+    void upload(const void *vertices, const VertexLayout &layout, const Mesh &mesh);
 };
 
 
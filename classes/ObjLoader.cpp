@@ -0,0 +1,477 @@
+#include <algorithm>
+#include <climits>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+#include <glm/glm.hpp>
+#include "Hash.h"
+#include "MappedFile.h"
+#include "ObjLoader.h"
+
+// Powers of ten exactly representable as doubles, so scaling by one rounds once
+static const double POWERS_OF_TEN[] = {1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11, 1e12, 1e13, 1e14,
+        1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+// Marks a corner with no texture coordinate or normal, or a corner to drop
+static const int32_t MISSING = INT32_MIN;
+// Marks a corner that isn't welded to an earlier one
+static const uint32_t UNWELDED = UINT32_MAX;
+
+/**
+ * A corner of a triangle as written, by its indices of position, texture coordinate and normal
+ */
+struct ObjCorner {
+    int32_t index[3];
+    // Bit per index set when it counted back from the end, so it's relative to the start of its chunk
+    uint32_t relative;
+};
+
+/**
+ * A share of the file, parsed on its own
+ */
+struct ObjChunk {
+    const char *begin;
+    const char *end;
+    std::vector<glm::vec3> positions;
+    std::vector<glm::vec2> textures;
+    std::vector<glm::vec3> normals;
+    // Three per triangle
+    std::vector<ObjCorner> corners;
+    // First triangle of each polygon
+    std::vector<uint32_t> polygons;
+    // Corners of the polygon being read, kept between lines so it's only allocated once
+    std::vector<ObjCorner> polygon;
+    // Faces skipped for being unreadable or having under three corners, and for referring to missing vertices
+    size_t malformed = 0, unresolved = 0;
+
+    // Where the chunk's elements start in the whole file, once every chunk is parsed
+    size_t positionBase = 0, textureBase = 0, normalBase = 0, cornerBase = 0, polygonBase = 0;
+    // Where the chunk's vertices and indices start in the mesh, once welded
+    size_t vertexBase = 0, indexBase = 0;
+};
+
+/**
+ * Skips spaces, tabs and the carriage returns of Windows line breaks
+ * @param text Current position
+ * @param end End of the line
+ * @return First character that isn't a space, or end
+ */
+static const char *skipSpaces(const char *text, const char *end)
+{
+    while(text < end && (*text == ' ' || *text == '\t' || *text == '\r')) text++;
+    return text;
+}
+
+/**
+ * Reads a decimal number in place, which unlike strtof needn't be followed by a terminator. The digits are gathered
+ * into an integer and scaled once by a power of ten, which is exact for the up to 15 significant digits exporters write
+ * @param text Current position, moved past the number
+ * @param end End of the line
+ * @param value Location to store the number
+ * @return True if a number was read
+ */
+static bool parseFloat(const char *&text, const char *end, float &value)
+{
+    const char *cursor = skipSpaces(text, end);
+    bool negative = cursor < end && *cursor == '-';
+    if(cursor < end && (*cursor == '-' || *cursor == '+')) cursor++;
+
+    uint64_t mantissa = 0;
+    int exponent = 0, digits = 0;
+    bool found = false;
+    for(; cursor < end && *cursor >= '0' && *cursor <= '9'; cursor++, found = true)
+    {
+        // Digits past what the mantissa holds only scale it
+        if(digits < 19) mantissa = mantissa * 10 + (*cursor - '0');
+        else exponent++;
+        digits += mantissa != 0;
+    }
+    if(cursor < end && *cursor == '.')
+    {
+        for(cursor++; cursor < end && *cursor >= '0' && *cursor <= '9'; cursor++, found = true)
+        {
+            if(digits < 19)
+            {
+                mantissa = mantissa * 10 + (*cursor - '0');
+                exponent--;
+            }
+            digits += mantissa != 0;
+        }
+    }
+    if(!found) return false;
+    // An e not followed by digits isn't part of the number
+    if(cursor + 1 < end && (*cursor == 'e' || *cursor == 'E'))
+    {
+        const char *power = cursor + 1;
+        bool negativePower = *power == '-';
+        if(*power == '-' || *power == '+') power++;
+        if(power < end && *power >= '0' && *power <= '9')
+        {
+            int written = 0;
+            for(; power < end && *power >= '0' && *power <= '9'; power++)
+            {
+                written = std::min(written * 10 + (*power - '0'), 10000);
+            }
+            exponent += negativePower ? -written : written;
+            cursor = power;
+        }
+    }
+
+    auto result = (double) mantissa;
+    if(mantissa == 0) result = 0;
+    else if(exponent >= 0 && exponent <= 22) result *= POWERS_OF_TEN[exponent];
+    else if(exponent < 0 && exponent >= -22) result /= POWERS_OF_TEN[-exponent];
+    else result *= std::pow(10.0, exponent);
+    value = (float) (negative ? -result : result);
+    text = cursor;
+    return true;
+}
+
+/**
+ * Reads an index of a face's corner in place
+ * @param text Current position, moved past the index
+ * @param end End of the line
+ * @param value Location to store the index as written
+ * @return True if a non zero index was read
+ */
+static bool parseIndex(const char *&text, const char *end, long &value)
+{
+    const char *cursor = text;
+    bool negative = cursor < end && *cursor == '-';
+    if(negative) cursor++;
+    long index = 0;
+    const char *digits = cursor;
+    for(; cursor < end && *cursor >= '0' && *cursor <= '9'; cursor++)
+    {
+        index = std::min(index * 10 + (*cursor - '0'), (long) INT32_MAX);
+    }
+    if(cursor == digits || index == 0) return false;
+    value = negative ? -index : index;
+    text = cursor;
+    return true;
+}
+
+/**
+ * Reads one index of a corner, counting from 0. Those written from the end are left relative to the chunk's start
+ * @param text Current position, moved past the index
+ * @param end End of the line
+ * @param count Number of elements of the index's kind the chunk has read
+ * @param corner Corner to store the index in
+ * @param slot Which of the corner's indices it is
+ * @return True if an index was read
+ */
+static bool parseCornerIndex(const char *&text, const char *end, size_t count, ObjCorner &corner, int slot)
+{
+    long index;
+    if(!parseIndex(text, end, index)) return false;
+    corner.index[slot] = (int32_t) (index < 0 ? (long) count + index : index - 1);
+    if(index < 0) corner.relative |= 1u << slot;
+    return true;
+}
+
+/**
+ * Parses a chunk of the file into its elements and triangles, with indices as written
+ * @param chunk Chunk to parse
+ */
+static void parseChunk(ObjChunk &chunk)
+{
+    // Lines average around 30 bytes, so reserving by the size saves most of the growing
+    size_t estimate = (chunk.end - chunk.begin) / 30;
+    chunk.positions.reserve(estimate / 2);
+    chunk.corners.reserve(estimate * 3 / 2);
+
+    const char *line = chunk.begin;
+    while(line < chunk.end)
+    {
+        auto *next = (const char *) memchr(line, '\n', chunk.end - line);
+        if(!next) next = chunk.end;
+        const char *cursor = skipSpaces(line, next);
+        line = next + 1;
+        if(next - cursor < 2) continue;
+        bool separated = cursor[1] == ' ' || cursor[1] == '\t';
+
+        if(cursor[0] == 'v' && separated)
+        {
+            glm::vec3 position(0.0f);
+            cursor++;
+            // A vertex missing a coordinate keeps its place, so the indices after it still count right
+            parseFloat(cursor, next, position.x) && parseFloat(cursor, next, position.y) &&
+                    parseFloat(cursor, next, position.z);
+            chunk.positions.push_back(position);
+        }
+        else if(cursor[0] == 'v' && cursor[1] == 't')
+        {
+            glm::vec2 texture(0.0f);
+            cursor += 2;
+            parseFloat(cursor, next, texture.x) && parseFloat(cursor, next, texture.y);
+            chunk.textures.push_back(texture);
+        }
+        else if(cursor[0] == 'v' && cursor[1] == 'n')
+        {
+            glm::vec3 normal(0.0f);
+            cursor += 2;
+            parseFloat(cursor, next, normal.x) && parseFloat(cursor, next, normal.y) &&
+                    parseFloat(cursor, next, normal.z);
+            chunk.normals.push_back(normal);
+        }
+        else if(cursor[0] == 'f' && separated)
+        {
+            chunk.polygon.clear();
+            bool valid = true;
+            cursor = skipSpaces(cursor + 1, next);
+            while(valid && cursor < next && *cursor != '#')
+            {
+                ObjCorner corner = {{MISSING, MISSING, MISSING}, 0};
+                valid = parseCornerIndex(cursor, next, chunk.positions.size(), corner, 0);
+                if(valid && cursor < next && *cursor == '/')
+                {
+                    cursor++;
+                    if(cursor < next && *cursor != '/')
+                    {
+                        valid = parseCornerIndex(cursor, next, chunk.textures.size(), corner, 1);
+                    }
+                    if(valid && cursor < next && *cursor == '/')
+                    {
+                        cursor++;
+                        valid = parseCornerIndex(cursor, next, chunk.normals.size(), corner, 2);
+                    }
+                }
+                valid = valid && (cursor == next || *cursor == ' ' || *cursor == '\t' || *cursor == '\r');
+                chunk.polygon.push_back(corner);
+                cursor = skipSpaces(cursor, next);
+            }
+
+            if(!valid || chunk.polygon.size() < 3)
+            {
+                chunk.malformed++;
+                continue;
+            }
+            chunk.polygons.push_back((uint32_t) (chunk.corners.size() / 3));
+            for(size_t i = 1; i + 1 < chunk.polygon.size(); i++)
+            {
+                chunk.corners.push_back(chunk.polygon[0]);
+                chunk.corners.push_back(chunk.polygon[i]);
+                chunk.corners.push_back(chunk.polygon[i + 1]);
+            }
+        }
+    }
+}
+
+/**
+ * Hashes a corner's indices to weld it by
+ * @param key Indices of the corner
+ * @return Hash of the indices
+ */
+static uint32_t hashCorner(const glm::ivec3 &key)
+{
+    uint64_t hash = fnv1a((const char *) &key, sizeof(key));
+    return (uint32_t) (hash ^ (hash >> 32));
+}
+
+bool ObjLoader::load(const std::string &path, const std::string &name, Mesh *mesh, ThreadPool *pool)
+{
+    // Threads read their own parts of the file at once, so it's read ahead as a whole
+    MappedFile file(path, false);
+    if(!file.isOpen())
+    {
+        std::cerr << "ERROR::OBJ::FILE_NOT_SUCCESSFULLY_READ " << path << std::endl;
+        return false;
+    }
+    ThreadPool serial(1);
+    ThreadPool &threads = pool ? *pool : serial;
+
+    // Enough chunks for threads finishing early to take more, ending each after a line break
+    auto *text = (const char *) file.getData();
+    const char *end = text + file.getSize();
+    size_t chunkCount = std::max<size_t>(1, std::min<size_t>(file.getSize() / OBJ_CHUNK_SIZE,
+            threads.getThreadCount() * 4));
+    std::vector<ObjChunk> chunks(chunkCount);
+    const char *begin = text;
+    for(size_t i = 0; i < chunkCount; i++)
+    {
+        const char *split = i + 1 == chunkCount ? end : std::max(begin, text + file.getSize() * (i + 1) / chunkCount);
+        auto *lineEnd = split < end ? (const char *) memchr(split, '\n', end - split) : nullptr;
+        chunks[i].begin = begin;
+        chunks[i].end = split < end ? (lineEnd ? lineEnd + 1 : end) : end;
+        begin = chunks[i].end;
+    }
+    threads.run(chunkCount, [&chunks](size_t i) { parseChunk(chunks[i]); });
+
+    // Every chunk's elements are gathered into one array, so indices into earlier chunks resolve
+    size_t positionCount = 0, textureCount = 0, normalCount = 0, cornerCount = 0, polygonCount = 0;
+    for(ObjChunk &chunk : chunks)
+    {
+        chunk.positionBase = positionCount;
+        chunk.textureBase = textureCount;
+        chunk.normalBase = normalCount;
+        chunk.cornerBase = cornerCount;
+        chunk.polygonBase = polygonCount;
+        positionCount += chunk.positions.size();
+        textureCount += chunk.textures.size();
+        normalCount += chunk.normals.size();
+        cornerCount += chunk.corners.size();
+        polygonCount += chunk.polygons.size();
+    }
+    std::vector<glm::vec3> positions(positionCount), normals(normalCount), faceNormals(polygonCount);
+    std::vector<glm::vec2> textures(textureCount);
+    threads.run(chunkCount, [&](size_t i) {
+        ObjChunk &chunk = chunks[i];
+        std::copy(chunk.positions.begin(), chunk.positions.end(), positions.begin() + chunk.positionBase);
+        std::copy(chunk.textures.begin(), chunk.textures.end(), textures.begin() + chunk.textureBase);
+        std::copy(chunk.normals.begin(), chunk.normals.end(), normals.begin() + chunk.normalBase);
+        chunk.positions = std::vector<glm::vec3>();
+        chunk.textures = std::vector<glm::vec2>();
+        chunk.normals = std::vector<glm::vec3>();
+    });
+
+    // Corners are welded by their indices. Those without a normal take their polygon's, so are only welded within it
+    std::vector<glm::ivec3> keys(cornerCount);
+    std::vector<uint32_t> hashes(cornerCount);
+    size_t counts[3] = {positionCount, textureCount, normalCount};
+    threads.run(chunkCount, [&](size_t i) {
+        ObjChunk &chunk = chunks[i];
+        size_t bases[3] = {chunk.positionBase, chunk.textureBase, chunk.normalBase};
+        for(size_t polygon = 0; polygon < chunk.polygons.size(); polygon++)
+        {
+            size_t first = chunk.polygons[polygon] * 3;
+            size_t last = polygon + 1 < chunk.polygons.size() ? chunk.polygons[polygon + 1] * 3 : chunk.corners.size();
+            auto global = (int32_t) (chunk.polygonBase + polygon);
+            bool valid = true, flat = false;
+            for(size_t c = first; c < last; c++)
+            {
+                ObjCorner &corner = chunk.corners[c];
+                flat = flat || corner.index[2] == MISSING;
+                for(int slot = 0; slot < 3; slot++)
+                {
+                    if(corner.index[slot] == MISSING) continue;
+                    long index = corner.index[slot] + ((corner.relative >> slot & 1u) ? (long) bases[slot] : 0);
+                    valid = valid && index >= 0 && index < (long) counts[slot];
+                    corner.index[slot] = (int32_t) index;
+                }
+                keys[chunk.cornerBase + c] = glm::ivec3(corner.index[0], corner.index[1] == MISSING ? -1 :
+                        corner.index[1], corner.index[2] == MISSING ? -2 - global : corner.index[2]);
+            }
+            if(!valid)
+            {
+                chunk.unresolved++;
+                for(size_t c = first; c < last; c++) keys[chunk.cornerBase + c].x = MISSING;
+                continue;
+            }
+
+            for(size_t c = first; c < last; c++) hashes[chunk.cornerBase + c] = hashCorner(keys[chunk.cornerBase + c]);
+            if(!flat) continue;
+
+            // Newell's method, so a polygon that isn't quite flat still gets the normal it mostly faces. Its outline is
+            // the fan's first corner, the second of each triangle, then the last
+            size_t outline = (last - first) / 3 + 2;
+            auto outlineAt = [&](size_t i) {
+                size_t c = i == 0 ? first : i + 1 == outline ? last - 1 : first + (i - 1) * 3 + 1;
+                return positions[chunk.corners[c].index[0]];
+            };
+            glm::vec3 faceNormal(0.0f);
+            for(size_t i = 0; i < outline; i++)
+            {
+                glm::vec3 a = outlineAt(i), b = outlineAt((i + 1) % outline);
+                faceNormal += glm::vec3((a.y - b.y) * (a.z + b.z), (a.z - b.z) * (a.x + b.x), (a.x - b.x) * (a.y + b.y));
+            }
+            faceNormals[global] = glm::length(faceNormal) > 0 ? glm::normalize(faceNormal) : faceNormal;
+        }
+        chunk.corners = std::vector<ObjCorner>();
+    });
+    size_t malformed = 0, unresolved = 0;
+    for(const ObjChunk &chunk : chunks)
+    {
+        malformed += chunk.malformed;
+        unresolved += chunk.unresolved;
+    }
+
+    // Each thread welds the corners whose hashes fall in its share, keeping their order, so finds the first corner of
+    // each kind without sharing a table
+    std::vector<uint32_t> firsts(cornerCount, UNWELDED);
+    size_t shares = threads.getThreadCount();
+    threads.run(shares, [&](size_t share) {
+        // Only the hashes are read to find the share's corners, as each thread passes over every one
+        auto owns = [&](size_t c) {
+            return ((uint64_t) hashes[c] * shares >> 32) == share && keys[c].x != MISSING;
+        };
+        size_t owned = 0;
+        for(size_t c = 0; c < cornerCount; c++) owned += owns(c);
+        size_t capacity = 16;
+        while(capacity < owned * 2) capacity *= 2;
+        std::vector<uint32_t> table(capacity, UNWELDED);
+        for(size_t c = 0; c < cornerCount; c++)
+        {
+            if(!owns(c)) continue;
+            for(size_t slot = hashes[c] & (capacity - 1);; slot = (slot + 1) & (capacity - 1))
+            {
+                if(table[slot] == UNWELDED) table[slot] = (uint32_t) c;
+                else if(keys[table[slot]] != keys[c]) continue;
+                firsts[c] = table[slot];
+                break;
+            }
+        }
+    });
+
+    // Vertices are numbered by where they first appear, chunk by chunk
+    size_t vertexCount = 0, indexCount = 0;
+    threads.run(chunkCount, [&](size_t i) {
+        ObjChunk &chunk = chunks[i];
+        size_t last = i + 1 < chunkCount ? chunks[i + 1].cornerBase : cornerCount;
+        chunk.vertexBase = chunk.indexBase = 0;
+        for(size_t c = chunk.cornerBase; c < last; c++)
+        {
+            chunk.vertexBase += firsts[c] == c;
+            chunk.indexBase += firsts[c] != UNWELDED;
+        }
+    });
+    for(ObjChunk &chunk : chunks)
+    {
+        size_t vertices = chunk.vertexBase, indices = chunk.indexBase;
+        chunk.vertexBase = vertexCount;
+        chunk.indexBase = indexCount;
+        vertexCount += vertices;
+        indexCount += indices;
+    }
+
+    Mesh result;
+    result.floatsPerVertex = 8;
+    result.vertices.resize(vertexCount * 8);
+    result.indices.resize(indexCount);
+    // Holds each first corner's vertex
+    std::vector<uint32_t> &numbers = hashes;
+    threads.run(chunkCount, [&](size_t i) {
+        ObjChunk &chunk = chunks[i];
+        size_t last = i + 1 < chunkCount ? chunks[i + 1].cornerBase : cornerCount;
+        size_t vertex = chunk.vertexBase;
+        for(size_t c = chunk.cornerBase; c < last; c++)
+        {
+            if(firsts[c] != c) continue;
+            const glm::ivec3 &key = keys[c];
+            glm::vec3 position = positions[key.x];
+            glm::vec3 normal = key.z >= 0 ? normals[key.z] : faceNormals[-2 - key.z];
+            glm::vec2 texture = key.y >= 0 ? textures[key.y] : glm::vec2(0.0f);
+            float *out = &result.vertices[vertex * 8];
+            out[0] = position.x, out[1] = position.y, out[2] = position.z;
+            out[3] = normal.x, out[4] = normal.y, out[5] = normal.z;
+            out[6] = texture.x, out[7] = texture.y;
+            numbers[c] = (uint32_t) vertex++;
+        }
+    });
+    threads.run(chunkCount, [&](size_t i) {
+        ObjChunk &chunk = chunks[i];
+        size_t last = i + 1 < chunkCount ? chunks[i + 1].cornerBase : cornerCount;
+        size_t index = chunk.indexBase;
+        for(size_t c = chunk.cornerBase; c < last; c++)
+        {
+            if(firsts[c] != UNWELDED) result.indices[index++] = numbers[firsts[c]];
+        }
+    });
+    *mesh = std::move(result);
+    std::cout << "INFO::OBJ::LOADED " << name << " " << file.getSize() << " bytes, " << positionCount
+              << " positions to " << mesh->vertexCount() << " vertices and " << mesh->indices.size() / 3
+              << " triangles";
+    if(malformed || unresolved) std::cout << ", skipping ";
+    if(malformed) std::cout << malformed << " malformed faces" << (unresolved ? " and " : "");
+    if(unresolved) std::cout << unresolved << " faces with missing vertices";
+    std::cout << std::endl;
+    return true;
+}
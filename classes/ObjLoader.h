@@ -0,0 +1,39 @@
+#ifndef OPENGLPROJECT_OBJLOADER_H
+#define OPENGLPROJECT_OBJLOADER_H
+
+#include <string>
+#include "MeshBuilder.h"
+#include "ThreadPool.h"
+
+// Smallest share of an OBJ file parsed as one job, so small files aren't split into more jobs than they're worth
+const size_t OBJ_CHUNK_SIZE = 1 << 20;
+
+/**
+ * Reads Wavefront OBJ files into a Mesh of positions, normals and texture coordinates, 8 floats per vertex as
+ * CubeModel's are
+ *
+ * Only geometry is read: v, vt, vn and f, with polygons split into fans of triangles. Faces without normals take the
+ * normal of their polygon, and those without texture coordinates take 0. Every other statement, such as materials and
+ * groups, is skipped
+ *
+ * The file is memory mapped and split at line breaks into chunks parsed at once on a ThreadPool, reading numbers in
+ * place without copying or allocating per line. Corners are then welded by their indices, in parallel over shares of
+ * the hashes, so each distinct corner becomes one vertex in the order it first appears. The mesh is the same however
+ * many threads load it
+ */
+class ObjLoader {
+public:
+    /**
+     * Reads an OBJ file, printing its size
+     * @param path Path of the file
+     * @param name Name to print the size under
+     * @param mesh Location to store the welded mesh
+     * @param pool Threads to parse the file on, or nullptr to parse it on the calling thread
+     * @return True if the file was read. Malformed faces, and faces referring to missing vertices, are skipped
+     * without failing
+     */
+    static bool load(const std::string &path, const std::string &name, Mesh *mesh, ThreadPool *pool = nullptr);
+};
+
+
+#endif //OPENGLPROJECT_OBJLOADER_H
@@ -0,0 +1,104 @@
+#include <iterator>
+#include "RangeAllocator.h"
+
+RangeAllocator::RangeAllocator(size_t capacity) : capacity(capacity)
+{
+    if(capacity) freeRanges[0] = capacity;
+}
+
+bool RangeAllocator::allocate(size_t size, size_t *offset)
+{
+    if(size == 0)
+    {
+        *offset = 0;
+        return true;
+    }
+    auto best = freeRanges.end();
+    for(auto range = freeRanges.begin(); range != freeRanges.end(); ++range)
+    {
+        if(range->second >= size && (best == freeRanges.end() || range->second < best->second))
+        {
+            best = range;
+            if(range->second == size) break;
+        }
+    }
+    if(best == freeRanges.end()) return false;
+
+    *offset = best->first;
+    size_t remaining = best->second - size;
+    freeRanges.erase(best);
+    if(remaining) freeRanges[*offset + size] = remaining;
+    used += size;
+    return true;
+}
+
+void RangeAllocator::free(size_t offset, size_t size)
+{
+    if(size == 0) return;
+    used -= size;
+
+    auto next = freeRanges.lower_bound(offset);
+    // Merges with the free range directly after
+    if(next != freeRanges.end() && offset + size == next->first)
+    {
+        size += next->second;
+        next = freeRanges.erase(next);
+    }
+    // And with the free range directly before
+    if(next != freeRanges.begin())
+    {
+        auto previous = std::prev(next);
+        if(previous->first + previous->second == offset)
+        {
+            previous->second += size;
+            return;
+        }
+    }
+    freeRanges[offset] = size;
+}
+
+void RangeAllocator::grow(size_t capacity)
+{
+    if(capacity <= this->capacity) return;
+    size_t added = capacity - this->capacity;
+    size_t offset = this->capacity;
+    this->capacity = capacity;
+    // Freeing counts the units as having been used
+    used += added;
+    free(offset, added);
+}
+
+void RangeAllocator::reset(size_t used, size_t capacity)
+{
+    freeRanges.clear();
+    this->capacity = capacity;
+    this->used = used;
+    if(capacity > used) freeRanges[used] = capacity - used;
+}
+
+size_t RangeAllocator::getCapacity() const
+{
+    return capacity;
+}
+
+size_t RangeAllocator::getUsed() const
+{
+    return used;
+}
+
+size_t RangeAllocator::getLargestFree() const
+{
+    size_t largest = 0;
+    for(const auto &range : freeRanges)
+    {
+        if(range.second > largest) largest = range.second;
+    }
+    return largest;
+}
+
+double RangeAllocator::getFragmentation() const
+{
+    size_t free = capacity - used;
+    if(free == 0) return 0;
+    return 1.0 - (double) getLargestFree() / free;
+}
@@ -0,0 +1,66 @@
+#ifndef OPENGLPROJECT_RANGEALLOCATOR_H
+#define OPENGLPROJECT_RANGEALLOCATOR_H
+
+#include <cstddef>
+#include <map>
+
+/**
+ * Hands out ranges of a fixed capacity, such as parts of a buffer, keeping a list of the free ranges
+ *
+ * Freed ranges are merged with free neighbours, and allocations take the smallest free range they fit in so large
+ * ranges are kept for large allocations
+ */
+class RangeAllocator {
+public:
+    /**
+     * Creates an allocator with every unit free
+     * @param capacity Number of units
+     */
+    explicit RangeAllocator(size_t capacity = 0);
+    /**
+     * Allocates a range
+     * @param size Number of units
+     * @param offset Location to store the first unit of the range
+     * @return True if a free range was large enough
+     */
+    bool allocate(size_t size, size_t *offset);
+    /**
+     * Frees a range given by allocate
+     * @param offset First unit of the range
+     * @param size Number of units
+     */
+    void free(size_t offset, size_t size);
+    /**
+     * Adds free units to the end
+     * @param capacity New number of units, at least the current capacity
+     */
+    void grow(size_t capacity);
+    /**
+     * Marks everything before used as allocated and the rest as free, as after packing every allocation together
+     * @param used Number of units allocated
+     * @param capacity Number of units
+     */
+    void reset(size_t used, size_t capacity);
+
+    size_t getCapacity() const;
+    size_t getUsed() const;
+    /**
+     * Gets the size of the largest free range, the largest allocation that can succeed
+     * @return Number of units
+     */
+    size_t getLargestFree() const;
+    /**
+     * Gets how much of the free space can't be used by an allocation of all of it
+     * @return 0 if the free space is one range, approaching 1 as it's split into smaller ranges
+     */
+    double getFragmentation() const;
+
+private:
+    // Size of each free range by its first unit
+    std::map<size_t, size_t> freeRanges;
+    size_t capacity;
+    size_t used = 0;
+};
+
+
+#endif //OPENGLPROJECT_RANGEALLOCATOR_H
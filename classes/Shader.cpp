@@ -1,178 +1,928 @@
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <thread>
 #include <glm/gtc/type_ptr.hpp>
 #include "Shader.h"
+#include "ShaderCache.h"
+#include "Hash.h"
+#include "UniformBuffer.h"
+#include "Extensions.h"
+#include "ShaderProfiler.h"
 
-Shader::Shader(std::string vertexPath, std::string fragmentPath, std::string location)
+std::map<std::pair<GLenum, uint64_t>, std::weak_ptr<Stage>> Shader::stages;
+std::map<std::pair<uint64_t, uint64_t>, std::weak_ptr<Program>> Shader::programs;
+std::map<std::string, int> Shader::textureUnits;
+uint64_t Shader::registryGeneration = 0;
+uint64_t Program::created = 0;
+long Shader::uploadsIssued = 0;
+long Shader::uploadsSkipped = 0;
+bool Shader::separable = false;
+
+/**
+ * Works out how a GLSL attribute type is read from a vertex buffer
+ * @param type GLSL type, such as GL_FLOAT_VEC3
+ * @param components Location to store the number of components read from each location
+ * @param locations Location to store the number of locations used, more than 1 for matrices
+ * @param integer Location to store whether the type is read as integers rather than floats
+ */
+static void attributeShape(GLenum type, int *components, int *locations, bool *integer)
+{
+    *locations = 1;
+    *integer = false;
+    switch(type)
+    {
+        case GL_FLOAT: *components = 1; break;
+        case GL_FLOAT_VEC2: *components = 2; break;
+        case GL_FLOAT_VEC3: *components = 3; break;
+        case GL_FLOAT_VEC4: *components = 4; break;
+        case GL_FLOAT_MAT2: *components = 2; *locations = 2; break;
+        case GL_FLOAT_MAT3: *components = 3; *locations = 3; break;
+        case GL_FLOAT_MAT4: *components = 4; *locations = 4; break;
+        case GL_INT: case GL_UNSIGNED_INT: *components = 1; *integer = true; break;
+        case GL_INT_VEC2: case GL_UNSIGNED_INT_VEC2: *components = 2; *integer = true; break;
+        case GL_INT_VEC3: case GL_UNSIGNED_INT_VEC3: *components = 3; *integer = true; break;
+        case GL_INT_VEC4: case GL_UNSIGNED_INT_VEC4: *components = 4; *integer = true; break;
+        default: *components = 4; break;
+    }
+}
+
+/**
+ * Checks whether a GLSL uniform type is a sampler
+ * @param type GLSL type, such as GL_SAMPLER_2D
+ * @return True if the uniform is a sampler
+ */
+static bool isSampler(GLenum type)
+{
+    switch(type)
+    {
+        case GL_SAMPLER_1D: case GL_SAMPLER_2D: case GL_SAMPLER_3D: case GL_SAMPLER_CUBE:
+        case GL_SAMPLER_1D_SHADOW: case GL_SAMPLER_2D_SHADOW: case GL_SAMPLER_CUBE_SHADOW:
+        case GL_SAMPLER_1D_ARRAY: case GL_SAMPLER_2D_ARRAY: case GL_SAMPLER_2D_ARRAY_SHADOW:
+        case GL_SAMPLER_2D_MULTISAMPLE: case GL_SAMPLER_2D_RECT: case GL_SAMPLER_BUFFER:
+        case GL_INT_SAMPLER_2D: case GL_INT_SAMPLER_3D: case GL_INT_SAMPLER_2D_ARRAY:
+        case GL_UNSIGNED_INT_SAMPLER_2D: case GL_UNSIGNED_INT_SAMPLER_3D: case GL_UNSIGNED_INT_SAMPLER_2D_ARRAY:
+            return true;
+        default:
+            return false;
+    }
+}
+
+Stage::~Stage()
+{
+    glDeleteShader(ID);
+    glDeleteProgram(program);
+}
+
+Program::~Program()
+{
+    glDeleteProgram(ID);
+    if(pipeline != 0) glDeleteProgramPipelines(1, &pipeline);
+}
+
+Shader::Shader(std::string vertexPath, std::string fragmentPath, std::string location, const ShaderDefines &defines)
+{
+    ShaderPreprocessor preprocessor(location);
+    std::string vertexSource, fragmentSource;
+    if(!preprocessor.process(vertexPath, defines, &vertexSource))
+    {
+        std::cerr << "ERROR::SHADER::VERTEX::PREPROCESSING_FAILED " << vertexPath << std::endl;
+    }
+    std::vector<std::string> files = preprocessor.getFiles();
+    if(!preprocessor.process(fragmentPath, defines, &fragmentSource))
+    {
+        std::cerr << "ERROR::SHADER::FRAGMENT::PREPROCESSING_FAILED " << fragmentPath << std::endl;
+    }
+    files.insert(files.end(), preprocessor.getFiles().begin(), preprocessor.getFiles().end());
+    uint64_t vertexHash = fnv1a(vertexSource.c_str(), vertexSource.size());
+    uint64_t fragmentHash = fnv1a(fragmentSource.c_str(), fragmentSource.size());
+
+    // Another Shader already using these sources shares its program
+    auto key = std::make_pair(vertexHash, fragmentHash);
+    auto existing = programs.find(key);
+    if(existing != programs.end() && (program = existing->second.lock()))
+    {
+        std::cout << "INFO::SHADER::PROGRAM::REUSED" << std::endl;
+        return;
+    }
+
+    program = std::make_shared<Program>();
+    program->vertexPath = vertexPath;
+    program->fragmentPath = fragmentPath;
+    program->location = location;
+    program->defines = defines;
+    program->files = std::move(files);
+    program->vertexSource = std::move(vertexSource);
+    program->fragmentSource = std::move(fragmentSource);
+    program->vertexHash = vertexHash;
+    program->fragmentHash = fragmentHash;
+    registerProgram(key, program);
+}
+
+Shader::Shader(std::shared_ptr<Program> program) : program(std::move(program)) {}
+
+Shader Shader::variant(const ShaderDefines &defines) const
+{
+    auto existing = program->variants.find(defines);
+    if(existing != program->variants.end()) return Shader(existing->second);
+
+    ShaderDefines merged = program->defines;
+    for(const auto &define : defines)
+    {
+        merged[define.first] = define.second;
+    }
+    Shader shader(program->vertexPath, program->fragmentPath, program->location, merged);
+    program->variants[defines] = shader.program;
+    return shader;
+}
+
+void Shader::build() const
+{
+    submit();
+    finish();
+}
+
+void Shader::submit() const
+{
+    if(program->submitted) return;
+    program->submitted = true;
+    program->started = std::chrono::steady_clock::now();
+
+    program->separable = separable && Extensions::separateShaderObjects;
+    if(program->separable)
+    {
+        // Stages another pipeline already uses are neither compiled nor linked again
+        program->vertex = getSeparableStage(GL_VERTEX_SHADER, program->vertexSource, program->vertexHash);
+        program->fragment = getSeparableStage(GL_FRAGMENT_SHADER, program->fragmentSource, program->fragmentHash);
+        return;
+    }
+
+    if(ShaderCache::load(&program->ID, program->vertexSource, program->fragmentSource)) return;
+
+    program->vertex = getStage(GL_VERTEX_SHADER, program->vertexSource, program->vertexHash);
+    program->fragment = getStage(GL_FRAGMENT_SHADER, program->fragmentSource, program->fragmentHash);
+
+    // The stages stay alive while a program links them, so other programs can reuse them
+    linkShaders(&program->ID, program->vertex->ID, program->fragment->ID);
+}
+
+bool Shader::isComplete() const
+{
+    if(!Extensions::parallelShaderCompile) return true;
+
+    for(unsigned int ID : getPrograms())
+    {
+        int complete;
+        glGetProgramiv(ID, GL_COMPLETION_STATUS_KHR, &complete);
+        if(complete != GL_TRUE) return false;
+    }
+    return true;
+}
+
+void Shader::finish() const
+{
+    if(program->built) return;
+    program->built = true;
+
+    program->linked = true;
+    if(program->separable)
+    {
+        bool vertexLinked = checkSeparable(*program->vertex, program->vertexSource);
+        bool fragmentLinked = checkSeparable(*program->fragment, program->fragmentSource);
+        program->linked = vertexLinked && fragmentLinked;
+        if(program->linked)
+        {
+            // Combining linked stages needs no further linking
+            glGenProgramPipelines(1, &program->pipeline);
+            glUseProgramStages(program->pipeline, GL_VERTEX_SHADER_BIT, program->vertex->program);
+            glUseProgramStages(program->pipeline, GL_FRAGMENT_SHADER_BIT, program->fragment->program);
+        }
+    }
+    // Programs from the binary cache have no stages, and were checked when loaded
+    else if(program->vertex)
+    {
+        checkStage(*program->vertex);
+        checkStage(*program->fragment);
+        program->linked = checkLink(program->ID);
+        if(program->linked)
+        {
+            double milliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - program->started).count();
+            ShaderCache::save(program->ID, program->vertexSource, program->fragmentSource, milliseconds);
+        }
+    }
+
+    // The sources aren't needed once linked
+    program->vertexSource = std::string();
+    program->fragmentSource = std::string();
+
+    loadUniforms();
+    loadAttributes();
+    bindUniformBlocks();
+    bindSamplers();
+    printBindings();
+}
+
+void Shader::replace(const std::shared_ptr<Program> &live) const
+{
+    Program &rebuilt = *program;
+
+    // Carries over every value set on the old program, so the swap can't be seen. Samplers were set when linked
+    int current;
+    glGetIntegerv(GL_CURRENT_PROGRAM, &current);
+    if(!rebuilt.separable) glUseProgram(rebuilt.ID);
+    for(Uniform &uniform : rebuilt.uniforms)
+    {
+        if(isSampler(uniform.type)) continue;
+        auto old = std::lower_bound(live->uniforms.begin(), live->uniforms.end(), uniform.hash,
+                [](const Uniform &uniform, uint64_t hash) { return uniform.hash < hash; });
+        if(old == live->uniforms.end() || old->hash != uniform.hash || old->type != uniform.type) continue;
+
+        const Uniform &previous = old->stages[0] ? *old->stages[0] : *old;
+        if(previous.set && needsUpload(&uniform, previous.value, sizeof(previous.value))) upload(uniform);
+    }
+    if(!rebuilt.separable) glUseProgram((unsigned int) current == live->ID ? rebuilt.ID : current);
+    if(live->separable)
+    {
+        int bound;
+        glGetIntegerv(GL_PROGRAM_PIPELINE_BINDING, &bound);
+        if((unsigned int) bound == live->pipeline) glBindProgramPipeline(rebuilt.pipeline);
+    }
+
+    // The registry finds the program by its new sources from now on
+    unregisterProgram(std::make_pair(live->vertexHash, live->fragmentHash), live);
+    registerProgram(std::make_pair(rebuilt.vertexHash, rebuilt.fragmentHash), live);
+
+    std::swap(live->ID, rebuilt.ID);
+    std::swap(live->separable, rebuilt.separable);
+    std::swap(live->pipeline, rebuilt.pipeline);
+    std::swap(live->files, rebuilt.files);
+    std::swap(live->vertexHash, rebuilt.vertexHash);
+    std::swap(live->fragmentHash, rebuilt.fragmentHash);
+    std::swap(live->uniforms, rebuilt.uniforms);
+    std::swap(live->attributes, rebuilt.attributes);
+    std::swap(live->blocks, rebuilt.blocks);
+    std::swap(live->samplers, rebuilt.samplers);
+    std::swap(live->vertex, rebuilt.vertex);
+    std::swap(live->fragment, rebuilt.fragment);
+}
+
+void Shader::registerProgram(const std::pair<uint64_t, uint64_t> &key, const std::shared_ptr<Program> &program)
 {
-    std::string vertexLocation;// = new std::string;
-    std::string fragmentLocation;// = new std::string;
-    readVertexFile((location + vertexPath).c_str(), &vertexLocation);
-    readFragmentFile((location + fragmentPath).c_str(), &fragmentLocation);
-    const char* vShaderCode = (vertexLocation).c_str();
-    const char* fShaderCode = (fragmentLocation).c_str();
+    std::weak_ptr<Program> &entry = programs[key];
+    // A rebuild can end up with the sources of another program, which keeps its entry
+    std::shared_ptr<Program> holder = entry.lock();
+    if(holder && holder != program) return;
+    entry = program;
+    registryGeneration++;
+}
+
+void Shader::unregisterProgram(const std::pair<uint64_t, uint64_t> &key, const std::shared_ptr<Program> &program)
+{
+    auto entry = programs.find(key);
+    if(entry == programs.end() || entry->second.lock() != program) return;
+    programs.erase(entry);
+    registryGeneration++;
+}
+
+double Shader::buildAll(const std::vector<const Shader *> &shaders)
+{
+    auto start = std::chrono::steady_clock::now();
+
+    std::vector<const Shader *> pending;
+    for(const Shader *shader : shaders)
+    {
+        if(!shader->program->built) pending.push_back(shader);
+    }
+
+    for(const Shader *shader : pending)
+    {
+        shader->submit();
+    }
 
-    unsigned int vertex, fragment;
-    vertex = createVertexShader(vShaderCode);
-    fragment = createFragmentShader(fShaderCode);
+    // Finishes programs in whatever order the driver completes them, so the checks never wait
+    size_t remaining = pending.size();
+    while(remaining > 0)
+    {
+        remaining = 0;
+        for(const Shader *shader : pending)
+        {
+            if(shader->program->built) continue;
+            if(shader->isComplete()) shader->finish();
+            else remaining++;
+        }
+        if(remaining > 0) std::this_thread::yield();
+    }
 
-    linkShaders(&ID, vertex, fragment);
-    // Delete the shaders as they're linked into our program now and no longer necessery
-    glDeleteShader(vertex);
-    glDeleteShader(fragment);
+    double milliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    std::cout << "INFO::SHADER::BATCH " << pending.size() << " programs built in " << milliseconds << "ms"
+              << (Extensions::parallelShaderCompile ? " using parallel compile" : "") << std::endl;
+    return milliseconds;
 }
 
-void Shader::use()
+unsigned int Shader::getID() const
 {
-    glUseProgram(ID);
+    build();
+    return program->separable ? program->pipeline : program->ID;
+}
+
+void Shader::use() const
+{
+    build();
+    if(program->separable)
+    {
+        // A program in use takes priority over the bound pipeline
+        glUseProgram(0);
+        glBindProgramPipeline(program->pipeline);
+    }
+    else
+    {
+        glUseProgram(program->ID);
+    }
+    if(ShaderProfiler::active) ShaderProfiler::active->use(*program);
+}
+
+void Shader::setBool(UniformId name, bool value) const
+{
+    setInt(name, (int)value);
+}
+
+void Shader::setInt(UniformId name, int value) const
+{
+    Uniform *uniform = findUniform(name);
+    if(needsUpload(uniform, &value, sizeof(value))) upload(*uniform);
+}
+
+void Shader::setFloat(UniformId name, float value) const
+{
+    Uniform *uniform = findUniform(name);
+    if(needsUpload(uniform, &value, sizeof(value))) upload(*uniform);
+}
+
+void Shader::setVec3(UniformId name, float v1, float v2, float v3) const
+{
+    setVec3(name, glm::vec3(v1, v2, v3));
+}
+
+void Shader::setVec3(UniformId name, glm::vec3 vec) const
+{
+    Uniform *uniform = findUniform(name);
+    if(needsUpload(uniform, &vec, sizeof(vec))) upload(*uniform);
+}
+
+void Shader::setVec2(UniformId name, glm::vec2 vec) const
+{
+    Uniform *uniform = findUniform(name);
+    if(needsUpload(uniform, &vec, sizeof(vec))) upload(*uniform);
+}
+
+void Shader::setMat4(UniformId name, const glm::mat4 &mat, bool transpose) const
+{
+    // Transposes here so the recorded value is the one the shader sees
+    glm::mat4 value = transpose ? glm::transpose(mat) : mat;
+    Uniform *uniform = findUniform(name);
+    if(needsUpload(uniform, &value, sizeof(value))) upload(*uniform);
+}
+
+int Shader::getLocation(UniformId name) const
+{
+    Uniform *uniform = findUniform(name);
+    return uniform ? uniform->location : -1;
 }
 
 void Shader::setBool(const std::string &name, bool value) const
 {
-    glUniform1i(glGetUniformLocation(ID, name.c_str()), (int)value);
+    setBool(UniformId(name), value);
 }
 
 void Shader::setInt(const std::string &name, int value) const
 {
-    glUniform1i(glGetUniformLocation(ID, name.c_str()), value);
+    setInt(UniformId(name), value);
 }
 
 void Shader::setFloat(const std::string &name, float value) const
 {
-    glUniform1f(glGetUniformLocation(ID, name.c_str()), value);
+    setFloat(UniformId(name), value);
 }
 
 void Shader::setVec3(const std::string &name, float v1, float v2, float v3) const
 {
-    setVec3(name, glm::vec3(v1, v2, v3));
+    setVec3(UniformId(name), v1, v2, v3);
 }
 
 void Shader::setVec3(const std::string &name, glm::vec3 vec) const
 {
-    glUniform3fv(glGetUniformLocation(ID, name.c_str()), 1, glm::value_ptr(vec));
+    setVec3(UniformId(name), vec);
+}
+
+void Shader::setVec2(const std::string &name, glm::vec2 vec) const
+{
+    setVec2(UniformId(name), vec);
+}
+
+void Shader::setMat4(const std::string &name, const glm::mat4 &mat, bool transpose) const
+{
+    setMat4(UniformId(name), mat, transpose);
+}
+
+int Shader::getLocation(const std::string &name) const
+{
+    return getLocation(UniformId(name));
+}
+
+Uniform *Shader::findUniform(UniformId name) const
+{
+    build();
+    // The table is sorted by hash, so a binary search finds the uniform comparing only integers
+    std::vector<Uniform> &uniforms = program->uniforms;
+    auto it = std::lower_bound(uniforms.begin(), uniforms.end(), name.hash,
+            [](const Uniform &uniform, uint64_t hash) { return uniform.hash < hash; });
+    if(it == uniforms.end() || it->hash != name.hash) return nullptr;
+    return &*it;
 }
 
-void Shader::readVertexFile(const char* vertexPath, std::string * vertexCode)
+bool Shader::needsUpload(Uniform *uniform, const void *value, size_t size) const
 {
-    std::ifstream vShaderFile;
-    // Ensure ifstream objects can throw exceptions:
-    vShaderFile.exceptions (std::ifstream::failbit | std::ifstream::badbit);
-    try
+    bool changed = false;
+    if(uniform != nullptr)
     {
-        // Open files
-        vShaderFile.open(vertexPath);
-        std::stringstream vShaderStream;
-        // Read file's buffer contents into streams
-        vShaderStream << vShaderFile.rdbuf();
-        // Close file handlers
-        vShaderFile.close();
-        // Convert stream into string
-        *vertexCode = vShaderStream.str();
+        Uniform *holders[2] = {uniform->stages[0] ? uniform->stages[0] : uniform, uniform->stages[1]};
+        for(Uniform *holder : holders)
+        {
+            if(holder == nullptr || (holder->set && memcmp(holder->value, value, size) == 0)) continue;
+            memcpy(holder->value, value, size);
+            holder->set = true;
+            changed = true;
+        }
     }
-    catch(std::ifstream::failure e)
+
+    if(!changed)
     {
-        std::cerr << "ERROR::SHADER::VERTEX::FILE_NOT_SUCCESFULLY_READ" << std::endl;
+        uploadsSkipped++;
+        return false;
     }
+    uploadsIssued++;
+    return true;
 }
 
-void Shader::readFragmentFile(const char* fragmentPath, std::string * fragmentCode)
+void Shader::upload(const Uniform &uniform) const
 {
-    std::ifstream fShaderFile;
-    // Ensure ifstream objects can throw exceptions:
-    fShaderFile.exceptions (std::ifstream::failbit | std::ifstream::badbit);
-    try
+    const Uniform *holders[2] = {uniform.stages[0] ? uniform.stages[0] : &uniform, uniform.stages[1]};
+    for(const Uniform *holder : holders)
     {
-        // Open files
-        fShaderFile.open(fragmentPath);
-        std::stringstream fShaderStream;
-        // Read file's buffer contents into streams
-        fShaderStream << fShaderFile.rdbuf();
-        // Close file handlers
-        fShaderFile.close();
-        // Convert stream into string
-        *fragmentCode = fShaderStream.str();
+        if(holder == nullptr) continue;
+        // Separable programs are set directly, others must be in use
+        unsigned int ID = holder->program;
+        int location = holder->location;
+        const auto *value = (const float *) holder->value;
+        switch(holder->type)
+        {
+            case GL_FLOAT:
+                if(ID) glProgramUniform1fv(ID, location, 1, value);
+                else glUniform1fv(location, 1, value);
+                break;
+            case GL_FLOAT_VEC2:
+                if(ID) glProgramUniform2fv(ID, location, 1, value);
+                else glUniform2fv(location, 1, value);
+                break;
+            case GL_FLOAT_VEC3:
+                if(ID) glProgramUniform3fv(ID, location, 1, value);
+                else glUniform3fv(location, 1, value);
+                break;
+            case GL_FLOAT_VEC4:
+                if(ID) glProgramUniform4fv(ID, location, 1, value);
+                else glUniform4fv(location, 1, value);
+                break;
+            case GL_FLOAT_MAT4:
+                if(ID) glProgramUniformMatrix4fv(ID, location, 1, GL_FALSE, value);
+                else glUniformMatrix4fv(location, 1, GL_FALSE, value);
+                break;
+            default:
+                // Integers, booleans and samplers
+                if(ID) glProgramUniform1iv(ID, location, 1, (const int *) holder->value);
+                else glUniform1iv(location, 1, (const int *) holder->value);
+                break;
+        }
     }
-    catch(std::ifstream::failure e)
+}
+
+void Shader::reportUploads()
+{
+    std::cout << "INFO::SHADER::UNIFORMS " << uploadsIssued << " uploads issued, "
+              << uploadsSkipped << " skipped" << std::endl;
+}
+
+const std::vector<Uniform> &Shader::getUniforms() const
+{
+    build();
+    return program->uniforms;
+}
+
+const std::vector<Attribute> &Shader::getAttributes() const
+{
+    build();
+    return program->attributes;
+}
+
+bool Shader::validate(const VertexLayout &layout, const std::string &layoutName) const
+{
+    build();
+    bool valid = true;
+    for(const Attribute &attribute : program->attributes)
     {
-        std::cerr << "ERROR::SHADER::FRAGMENT::FILE_NOT_SUCCESFULLY_READ" << std::endl;
+        // Built in inputs such as gl_VertexID have no location and aren't read from the buffer
+        if(attribute.location == -1) continue;
+
+        int components, locations;
+        bool integer;
+        attributeShape(attribute.type, &components, &locations, &integer);
+        if(integer)
+        {
+            // Every layout is set with glVertexAttribPointer, which converts to floats
+            std::cerr << "ERROR::SHADER::LAYOUT::INTEGER_ATTRIBUTE " << program->vertexPath << " " << layoutName
+                      << " " << attribute.name << std::endl;
+            valid = false;
+            continue;
+        }
+
+        for(int i = 0; i < locations; i++)
+        {
+            unsigned int location = attribute.location + i;
+            auto provided = std::find_if(layout.attributes.begin(), layout.attributes.end(),
+                    [location](const VertexAttribute &vertex) { return vertex.location == location; });
+            if(provided == layout.attributes.end())
+            {
+                std::cerr << "ERROR::SHADER::LAYOUT::MISSING_ATTRIBUTE " << program->vertexPath << " " << layoutName
+                          << " " << attribute.name << " at location " << location << std::endl;
+                valid = false;
+            }
+            // Packed 2_10_10_10 attributes always have 4 components, which may be more than are read
+            else if(provided->size != components && !(provided->size > components &&
+                    (provided->type == GL_INT_2_10_10_10_REV || provided->type == GL_UNSIGNED_INT_2_10_10_10_REV)))
+            {
+                std::cerr << "ERROR::SHADER::LAYOUT::SIZE_MISMATCH " << program->vertexPath << " " << layoutName
+                          << " " << attribute.name << " reads " << components << " components, the buffer has "
+                          << provided->size << std::endl;
+                valid = false;
+            }
+        }
     }
+    return valid;
 }
 
-void Shader::linkShaders(unsigned int * shaderProgram, unsigned int vertexShader, unsigned int fragmentShader)
+void Shader::setTextureUnit(const std::string &name, int unit)
 {
-    int success;
-    char infoLog[512];
+    textureUnits[name] = unit;
+}
+
+std::shared_ptr<Stage> Shader::getStage(GLenum type, const std::string &source, uint64_t hash) const
+{
+    auto key = std::make_pair(type, hash);
+    auto existing = stages.find(key);
+    std::shared_ptr<Stage> stage;
+    if(existing != stages.end() && (stage = existing->second.lock()))
+    {
+        std::cout << (type == GL_VERTEX_SHADER ? "INFO::SHADER::VERTEX::REUSED" : "INFO::SHADER::FRAGMENT::REUSED") << std::endl;
+        return stage;
+    }
+
+    if(type == GL_VERTEX_SHADER) stage = std::make_shared<Stage>(createVertexShader(source.c_str()), type);
+    else stage = std::make_shared<Stage>(createFragmentShader(source.c_str()), type);
+    stages[key] = stage;
+    return stage;
+}
+
+std::shared_ptr<Stage> Shader::getSeparableStage(GLenum type, const std::string &source, uint64_t hash) const
+{
+    // Kept apart from the stages of whole programs, as they may have been loaded without a shader object
+    auto key = std::make_pair(type, fnv1a("separable", 9, hash));
+    auto existing = stages.find(key);
+    std::shared_ptr<Stage> stage;
+    if(existing != stages.end() && (stage = existing->second.lock()))
+    {
+        std::cout << (type == GL_VERTEX_SHADER ? "INFO::SHADER::VERTEX::REUSED" : "INFO::SHADER::FRAGMENT::REUSED") << std::endl;
+        return stage;
+    }
+
+    // A separable program is cached under its own source alone
+    bool vertex = type == GL_VERTEX_SHADER;
+    unsigned int cached;
+    if(ShaderCache::load(&cached, vertex ? source : "", vertex ? "" : source))
+    {
+        stage = std::make_shared<Stage>(0, type);
+        stage->checked = true;
+        stage->program = cached;
+    }
+    else
+    {
+        stage = std::make_shared<Stage>(vertex ? createVertexShader(source.c_str()) : createFragmentShader(source.c_str()), type);
+        linkSeparable(*stage);
+    }
+    stages[key] = stage;
+    return stage;
+}
+
+void Shader::loadUniforms() const
+{
+    std::vector<Uniform> &uniforms = program->uniforms;
+    uniforms.clear();
+    if(!program->separable)
+    {
+        readUniforms(program->ID, false, &uniforms);
+        return;
+    }
+
+    // Refers to each stage's uniforms, merging any both stages declare
+    for(Stage *stage : {program->vertex.get(), program->fragment.get()})
+    {
+        for(Uniform &stageUniform : stage->uniforms)
+        {
+            auto existing = std::find_if(uniforms.begin(), uniforms.end(),
+                    [&stageUniform](const Uniform &uniform) { return uniform.hash == stageUniform.hash; });
+            if(existing != uniforms.end())
+            {
+                existing->stages[1] = &stageUniform;
+                continue;
+            }
+
+            Uniform uniform{};
+            uniform.name = stageUniform.name;
+            uniform.hash = stageUniform.hash;
+            uniform.location = stageUniform.location;
+            uniform.type = stageUniform.type;
+            uniform.program = stageUniform.program;
+            uniform.stages[0] = &stageUniform;
+            uniforms.push_back(uniform);
+        }
+    }
+    std::sort(uniforms.begin(), uniforms.end(),
+            [](const Uniform &a, const Uniform &b) { return a.hash < b.hash; });
+}
+
+void Shader::readUniforms(unsigned int ID, bool separable, std::vector<Uniform> *uniforms) const
+{
+    int count, maxLength;
+    glGetProgramiv(ID, GL_ACTIVE_UNIFORMS, &count);
+    glGetProgramiv(ID, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxLength);
+
+    std::vector<char> buffer(maxLength > 0 ? maxLength : 1);
+    uniforms->clear();
+    uniforms->reserve(count);
+    for(int i = 0; i < count; i++)
+    {
+        int length, size;
+        GLenum type;
+        glGetActiveUniform(ID, i, maxLength, &length, &size, &type, buffer.data());
+        std::string name(buffer.data(), length);
+
+        // Arrays are reported as "name[0]", but are set using just "name"
+        if(name.size() > 3 && name.compare(name.size() - 3, 3, "[0]") == 0) name.resize(name.size() - 3);
+
+        // Members of uniform blocks have no location of their own
+        int location = glGetUniformLocation(ID, name.c_str());
+        if(location == -1) continue;
+
+        Uniform uniform{};
+        uniform.name = name;
+        uniform.hash = fnv1a(name.c_str(), name.size());
+        uniform.location = location;
+        uniform.type = type;
+        uniform.program = separable ? ID : 0;
+        uniforms->push_back(uniform);
+    }
+
+    std::sort(uniforms->begin(), uniforms->end(),
+            [](const Uniform &a, const Uniform &b) { return a.hash < b.hash; });
+    for(size_t i = 1; i < uniforms->size(); i++)
+    {
+        if((*uniforms)[i].hash == (*uniforms)[i - 1].hash)
+        {
+            std::cerr << "ERROR::SHADER::PROGRAM::UNIFORM_HASH_COLLISION " << (*uniforms)[i - 1].name << " " << (*uniforms)[i].name << std::endl;
+        }
+    }
+}
+
+void Shader::loadAttributes() const
+{
+    // Only the vertex stage has attributes
+    unsigned int ID = program->separable ? program->vertex->program : program->ID;
+    std::vector<Attribute> &attributes = program->attributes;
+    int count, maxLength;
+    glGetProgramiv(ID, GL_ACTIVE_ATTRIBUTES, &count);
+    glGetProgramiv(ID, GL_ACTIVE_ATTRIBUTE_MAX_LENGTH, &maxLength);
+
+    std::vector<char> buffer(maxLength > 0 ? maxLength : 1);
+    attributes.clear();
+    for(int i = 0; i < count; i++)
+    {
+        int length, size;
+        GLenum type;
+        glGetActiveAttrib(ID, i, maxLength, &length, &size, &type, buffer.data());
+        std::string name(buffer.data(), length);
+        attributes.push_back({name, glGetAttribLocation(ID, name.c_str()), type});
+    }
+
+    std::sort(attributes.begin(), attributes.end(),
+            [](const Attribute &a, const Attribute &b) { return a.location < b.location; });
+}
+
+void Shader::bindUniformBlocks() const
+{
+    program->blocks.clear();
+    for(unsigned int ID : getPrograms())
+    {
+        int count, maxLength;
+        glGetProgramiv(ID, GL_ACTIVE_UNIFORM_BLOCKS, &count);
+        glGetProgramiv(ID, GL_ACTIVE_UNIFORM_BLOCK_MAX_NAME_LENGTH, &maxLength);
+
+        std::vector<char> buffer(maxLength > 0 ? maxLength : 1);
+        for(int i = 0; i < count; i++)
+        {
+            int length;
+            glGetActiveUniformBlockName(ID, i, maxLength, &length, buffer.data());
+            std::string name(buffer.data(), length);
 
+            int binding = UniformBuffer::getBinding(name);
+            if(binding == -1)
+            {
+                std::cerr << "ERROR::SHADER::PROGRAM::UNKNOWN_UNIFORM_BLOCK " << name << std::endl;
+            }
+            else
+            {
+                glUniformBlockBinding(ID, i, binding);
+            }
+
+            // Stages of a pipeline may both use the same block
+            bool recorded = std::any_of(program->blocks.begin(), program->blocks.end(),
+                    [&name](const UniformBlock &block) { return block.name == name; });
+            if(recorded) continue;
+            int size;
+            glGetActiveUniformBlockiv(ID, i, GL_UNIFORM_BLOCK_DATA_SIZE, &size);
+            program->blocks.push_back({name, (unsigned int) i, binding, size});
+        }
+    }
+}
+
+std::vector<unsigned int> Shader::getPrograms() const
+{
+    if(program->separable) return {program->vertex->program, program->fragment->program};
+    return {program->ID};
+}
+
+void Shader::bindSamplers() const
+{
+    program->samplers.clear();
+    for(const Uniform &uniform : program->uniforms)
+    {
+        if(!isSampler(uniform.type)) continue;
+
+        auto unit = textureUnits.find(uniform.name);
+        if(unit == textureUnits.end())
+        {
+            std::cerr << "ERROR::SHADER::PROGRAM::UNKNOWN_SAMPLER " << uniform.name << std::endl;
+            program->samplers.push_back({uniform.name, uniform.location, -1});
+            continue;
+        }
+        program->samplers.push_back({uniform.name, uniform.location, unit->second});
+    }
+    if(program->samplers.empty()) return;
+
+    // Samplers of a whole program can only be set while it's in use, so the one in use is put back afterwards
+    int current;
+    glGetIntegerv(GL_CURRENT_PROGRAM, &current);
+    if(!program->separable) glUseProgram(program->ID);
+    for(const Sampler &sampler : program->samplers)
+    {
+        if(sampler.unit != -1) setInt(UniformId(sampler.name), sampler.unit);
+    }
+    if(!program->separable) glUseProgram(current);
+}
+
+void Shader::printBindings() const
+{
+    std::cout << "INFO::SHADER::BINDINGS " << program->vertexPath << " " << program->fragmentPath << " attributes [";
+    for(const Attribute &attribute : program->attributes)
+    {
+        std::cout << " " << attribute.name << "=" << attribute.location;
+    }
+    std::cout << " ] blocks [";
+    for(const UniformBlock &block : program->blocks)
+    {
+        std::cout << " " << block.name << "=" << block.binding << " (" << block.size << " bytes)";
+    }
+    std::cout << " ] samplers [";
+    for(const Sampler &sampler : program->samplers)
+    {
+        std::cout << " " << sampler.name << "=" << sampler.unit;
+    }
+    std::cout << " ]" << std::endl;
+}
+
+void Shader::linkShaders(unsigned int * shaderProgram, unsigned int vertexShader, unsigned int fragmentShader) const
+{
     // SHADER LINKING
     // Creates a basic program object
     *shaderProgram = glCreateProgram();
+    ShaderCache::prepare(*shaderProgram);
     // Attaches a compiled shader3d object to a program
     glAttachShader(*shaderProgram, vertexShader);
     glAttachShader(*shaderProgram, fragmentShader);
-    // Links all the shaders in the program together
+    // Links all the shaders in the program together. The status is checked later so this doesn't wait
     glLinkProgram(*shaderProgram);
+}
+
+bool Shader::checkLink(unsigned int shaderProgram) const
+{
+    int success;
+    char infoLog[512];
 
-    glGetProgramiv(*shaderProgram, GL_LINK_STATUS, &success);
+    glGetProgramiv(shaderProgram, GL_LINK_STATUS, &success);
 
     if(!success)
     {
-        glGetProgramInfoLog(shaderProgram[1], 512, nullptr, infoLog);
+        glGetProgramInfoLog(shaderProgram, 512, nullptr, infoLog);
         std::cerr << "ERROR::SHADER::PROGRAM::LINKING_FAILED" << infoLog << std::endl;
     }
     else
     {
         std::cout << "INFO::SHADER::PROGRAM::LINKING_SUCCESS" << std::endl;
     }
+    return success;
+}
+
+void Shader::linkSeparable(Stage &stage) const
+{
+    stage.program = glCreateProgram();
+    ShaderCache::prepare(stage.program);
+    glProgramParameteri(stage.program, GL_PROGRAM_SEPARABLE, GL_TRUE);
+    glAttachShader(stage.program, stage.ID);
+    // The status is checked later so this doesn't wait
+    glLinkProgram(stage.program);
 }
 
-unsigned int Shader::createVertexShader(const char * vertexShaderSource)
+bool Shader::checkSeparable(Stage &stage, const std::string &source) const
+{
+    if(stage.programChecked) return stage.programLinked;
+    stage.programChecked = true;
+
+    // Stages from the binary cache have no shader object, and were checked when loaded
+    stage.programLinked = true;
+    if(stage.ID != 0)
+    {
+        checkStage(stage);
+        stage.programLinked = checkLink(stage.program);
+        if(stage.programLinked)
+        {
+            double milliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - program->started).count();
+            bool vertex = stage.type == GL_VERTEX_SHADER;
+            ShaderCache::save(stage.program, vertex ? source : "", vertex ? "" : source, milliseconds);
+        }
+    }
+    readUniforms(stage.program, true, &stage.uniforms);
+    return stage.programLinked;
+}
+
+unsigned int Shader::createVertexShader(const char * vertexShaderSource) const
 {
     // VERTEX SHADERS
     // Makes an empty vertex shader3d
     unsigned int vertexShader = glCreateShader(GL_VERTEX_SHADER);
     // Replaces the current shader3d source code with that given by the .vert files
     glShaderSource(vertexShader, 1, &vertexShaderSource, nullptr);
-    // Compiles the shader3d object using source code just given
+    // Compiles the shader3d object using source code just given. The status is checked later so this doesn't wait
     glCompileShader(vertexShader);
 
-    int success;
-    char infoLog[512];
-    // Gets specific info about an element of a shader3d
-    glGetShaderiv(vertexShader, GL_COMPILE_STATUS, &success);
-
-    if(!success)
-    {
-        // Returns the error log
-        glGetShaderInfoLog(vertexShader, 512, nullptr, infoLog);
-        std::cerr << "ERROR::SHADER::VERTEX::COMPILATION_FAILED " << infoLog << std::endl;
-    }
-    else
-    {
-        std::cout << "INFO::SHADER::VERTEX::COMPILATION_SUCCESS" << std::endl;
-    }
-
     return vertexShader;
 }
 
-unsigned int Shader::createFragmentShader(const char * fragmentShaderSource)
+unsigned int Shader::createFragmentShader(const char * fragmentShaderSource) const
 {
     // FRAGMENT SHADERS
-    int success;
-    char infoLog[512];
-
     unsigned int fragmentShader = glCreateShader(GL_FRAGMENT_SHADER);
     glShaderSource(fragmentShader, 1, &fragmentShaderSource, nullptr);
     glCompileShader(fragmentShader);
 
-    glGetShaderiv(fragmentShader, GL_COMPILE_STATUS, &success);
+    return fragmentShader;
+}
+
+void Shader::checkStage(Stage &stage) const
+{
+    if(stage.checked) return;
+    stage.checked = true;
+
+    int success;
+    char infoLog[512];
+    // Gets specific info about an element of a shader3d
+    glGetShaderiv(stage.ID, GL_COMPILE_STATUS, &success);
 
+    bool vertex = stage.type == GL_VERTEX_SHADER;
     if(!success)
     {
-        glGetShaderInfoLog(fragmentShader, 512, nullptr, infoLog);
-        std::cerr << "ERROR::SHADER::FRAGMENT::COMPILATION_FAILED" << infoLog << std::endl;
+        // Returns the error log
+        glGetShaderInfoLog(stage.ID, 512, nullptr, infoLog);
+        std::cerr << (vertex ? "ERROR::SHADER::VERTEX::COMPILATION_FAILED " : "ERROR::SHADER::FRAGMENT::COMPILATION_FAILED ") << infoLog << std::endl;
     }
     else
     {
-        std::cout << "INFO::SHADER::FRAGMENT::COMPILATION_SUCCESS" << std::endl;
+        std::cout << (vertex ? "INFO::SHADER::VERTEX::COMPILATION_SUCCESS" : "INFO::SHADER::FRAGMENT::COMPILATION_SUCCESS") << std::endl;
     }
-
-    return fragmentShader;
-}
\ No newline at end of file
+}
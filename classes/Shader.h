@@ -7,91 +7,478 @@
 #include <fstream>
 #include <sstream>
 #include <iostream>
+#include <vector>
+#include <map>
+#include <memory>
+#include <cstdint>
+#include <chrono>
 #include <glm/glm.hpp>
+#include "Hash.h"
+#include "ShaderPreprocessor.h"
+#include "VertexLayout.h"
+
+/**
+ * Identifies a uniform by a hash of its name, so it can be looked up without allocating or comparing strings
+ *
+ * Written as a literal, such as "viewPos"_u, the hash is worked out at compile time
+ */
+struct UniformId {
+    uint64_t hash;
+
+    constexpr explicit UniformId(uint64_t hash) : hash(hash) {}
+    explicit UniformId(const std::string &name) : hash(fnv1a(name.c_str(), name.size())) {}
+};
+
+/**
+ * Creates a uniform identifier from its name
+ * @param name Variable name
+ * @param length Length of the name
+ * @return Identifier of the uniform
+ */
+constexpr UniformId operator""_u(const char *name, size_t length)
+{
+    return UniformId(fnv1a(name, length));
+}
+
+/**
+ * An active uniform of a linked program and its location
+ */
+struct Uniform {
+    std::string name;
+    // Hash of the name, which the table is sorted and searched by
+    uint64_t hash;
+    int location;
+    // GLSL type, such as GL_FLOAT_VEC3 or GL_SAMPLER_2D
+    GLenum type;
+    // Last value uploaded, so setting the same value again can skip the OpenGL call
+    unsigned char value[sizeof(glm::mat4)];
+    // Whether a value has been uploaded yet
+    bool set = false;
+    // Separable program the uniform belongs to, or 0 if it's set on the program in use
+    unsigned int program = 0;
+    // For a pipeline, the uniform in each stage declaring it. They hold the value instead, as other pipelines may
+    // share the stages
+    Uniform *stages[2] = {nullptr, nullptr};
+};
+
+/**
+ * An active vertex attribute of a linked program
+ */
+struct Attribute {
+    std::string name;
+    int location;
+    // GLSL type, such as GL_FLOAT_VEC3
+    GLenum type;
+};
+
+/**
+ * An active uniform block of a linked program and the binding point it reads from
+ */
+struct UniformBlock {
+    std::string name;
+    unsigned int index;
+    // Binding point, or -1 if the block isn't known
+    int binding;
+    // Size of the block's data in bytes
+    int size;
+};
+
+/**
+ * An active sampler of a linked program and the texture unit it reads from
+ */
+struct Sampler {
+    std::string name;
+    int location;
+    // Texture unit, or -1 if the sampler isn't known
+    int unit;
+};
+
+/**
+ * A compiled shader object, shared by every program that links the same source
+ */
+struct Stage {
+    unsigned int ID;
+    GLenum type;
+    // Whether the compile status has been checked yet
+    bool checked = false;
+    // Separable program linked from just this stage, or 0 if no pipeline has needed one
+    unsigned int program = 0;
+    // Whether the separable program's link status has been checked yet, and whether it linked
+    bool programChecked = false;
+    bool programLinked = false;
+    // Active uniforms of the separable program sorted by name hash, filled once after linking
+    std::vector<Uniform> uniforms;
+
+    Stage(unsigned int ID, GLenum type) : ID(ID), type(type) {}
+    Stage(const Stage &) = delete;
+    Stage &operator=(const Stage &) = delete;
+    ~Stage();
+};
+
+/**
+ * A linked program, shared by every Shader built from the same vertex and fragment source
+ */
+struct Program {
+    // Number of programs created so far
+    static uint64_t created;
+    // Numbers the program uniquely for the life of the process, as a new program can be given a deleted one's address
+    const uint64_t serial = ++created;
+    unsigned int ID = 0;
+    // Whether the program is a pipeline of separable stages rather than a single linked program
+    bool separable = false;
+    // Pipeline combining the stages' separable programs, if separable
+    unsigned int pipeline = 0;
+    // Whether compiling and linking has been started
+    bool submitted = false;
+    // Whether the program has finished linking and been checked
+    bool built = false;
+    // Whether the program linked successfully
+    bool linked = false;
+    // When compiling started
+    std::chrono::steady_clock::time_point started;
+    // Where the sources came from, so permutations can be built from them
+    std::string vertexPath;
+    std::string fragmentPath;
+    std::string location;
+    ShaderDefines defines;
+    // Files the sources were read from relative to location, so changes to them can be noticed
+    std::vector<std::string> files;
+    // Preprocessed sources and their hashes, kept until the program is built
+    std::string vertexSource;
+    std::string fragmentSource;
+    uint64_t vertexHash = 0;
+    uint64_t fragmentHash = 0;
+    // Permutations requested from this program, by the defines they add
+    std::map<ShaderDefines, std::shared_ptr<Program>> variants;
+    // Active uniforms sorted by name hash, filled once after linking
+    std::vector<Uniform> uniforms;
+    // Reflection of the linked program, filled once after linking so drawing never queries it
+    std::vector<Attribute> attributes;
+    std::vector<UniformBlock> blocks;
+    std::vector<Sampler> samplers;
+    // Stages linked into the program. Empty if it was loaded from the binary cache
+    std::shared_ptr<Stage> vertex;
+    std::shared_ptr<Stage> fragment;
+
+    Program() = default;
+    Program(const Program &) = delete;
+    Program &operator=(const Program &) = delete;
+    ~Program();
+};
 
 class Shader
 {
+    // Rebuilds programs in place when their sources change
+    friend class ShaderWatcher;
+
 public:
-    // The program ID
-    unsigned int ID;
+    // Number of uniform uploads sent to OpenGL
+    static long uploadsIssued;
+    // Number of uniform uploads skipped as the uniform already held the value, or isn't active
+    static long uploadsSkipped;
+    // Whether programs are built as pipelines of separately linked stages, so stages shared between shaders are
+    // only linked once. Ignored if the driver doesn't support separate shader objects
+    static bool separable;
+
 
     /**
-     * Initialises and builds the shader
+     * Initialises the shader, reading and preprocessing its sources. It is compiled the first time it is used
      * @param vertexPath Path to vertex shader relative to shaders
      * @param fragmentPath Path to fragment shader relative to shaders
      * @param location Location of shaders path (Use Path.shaders)
+     * @param defines Macros to define in both shaders
+     */
+    Shader(std::string vertexPath, std::string fragmentPath, std::string location, const ShaderDefines &defines = {});
+    // A Shader is a handle to its program, so is moved rather than copied. The program is deleted once no Shader,
+    // permutation or registry entry refers to it
+    Shader(const Shader &) = delete;
+    Shader &operator=(const Shader &) = delete;
+    Shader(Shader &&) noexcept = default;
+    Shader &operator=(Shader &&) noexcept = default;
+    /**
+     * Gets a permutation of this shader with extra macros defined. Permutations are only compiled when first used,
+     * and are kept so asking again returns the same one
+     * @param defines Macros to define, replacing any of the same name
+     * @return The permutation
      */
-    Shader(std::string vertexPath, std::string fragmentPath, std::string location);
+    Shader variant(const ShaderDefines &defines) const;
+    /**
+     * Gets the ID of the linked program, or of the pipeline if built from separable stages
+     * @return Program or pipeline ID
+     */
+    unsigned int getID() const;
     /**
      * Activates the shader as the one being used to draw
      */
-    void use();
+    void use() const;
     /**
      * Sets a boolean uniform to the given value
-     * @param name Variable name
+     * @param name Variable name, such as "alpha"_u
      * @param value Boolean value
      */
-    void setBool(const std::string &name, bool value) const;
+    void setBool(UniformId name, bool value) const;
     /**
      * Sets an integer uniform to the given value
-     * @param name Variable name
+     * @param name Variable name, such as "alpha"_u
      * @param value Integer value
      */
-    void setInt(const std::string &name, int value) const;
+    void setInt(UniformId name, int value) const;
     /**
      * Sets a float uniform to the given value
-     * @param name Variable name
+     * @param name Variable name, such as "alpha"_u
      * @param value Float value
      */
-    void setFloat(const std::string &name, float value) const;
+    void setFloat(UniformId name, float value) const;
     /**
      * Sets a vector 3 uniform to the given value
-     * @param name Variable name
+     * @param name Variable name, such as "alpha"_u
      * @param v1 First Value
      * @param v2 Second Value
      * @param v3 Third Value
      */
-    void setVec3(const std::string &name, float v1, float v2, float v3) const;
-
+    void setVec3(UniformId name, float v1, float v2, float v3) const;
     /**
      * Sets a vector 3 uniform to the given value
-     * @param name Variable name
+     * @param name Variable name, such as "alpha"_u
+     * @param vec Vector Value
+     */
+    void setVec3(UniformId name, glm::vec3 vec) const;
+    /**
+     * Sets a vector 2 uniform to the given value
+     * @param name Variable name, such as "alpha"_u
      * @param vec Vector Value
      */
+    void setVec2(UniformId name, glm::vec2 vec) const;
+    /**
+     * Sets a 4x4 matrix uniform to the given value
+     * @param name Variable name, such as "alpha"_u
+     * @param mat Matrix Value
+     * @param transpose Whether the matrix should be transposed when uploaded
+     */
+    void setMat4(UniformId name, const glm::mat4 &mat, bool transpose = false) const;
+    /**
+     * Finds the location of a uniform using the table built after linking, without querying OpenGL
+     * @param name Variable name, such as "alpha"_u
+     * @return Uniform location, or -1 if the program has no active uniform of that name
+     */
+    int getLocation(UniformId name) const;
+
+    // The same, taking names at runtime. These hash the name on every call, so are meant for tooling rather than drawing
+    void setBool(const std::string &name, bool value) const;
+    void setInt(const std::string &name, int value) const;
+    void setFloat(const std::string &name, float value) const;
+    void setVec3(const std::string &name, float v1, float v2, float v3) const;
     void setVec3(const std::string &name, glm::vec3 vec) const;
+    void setVec2(const std::string &name, glm::vec2 vec) const;
+    void setMat4(const std::string &name, const glm::mat4 &mat, bool transpose = false) const;
+    int getLocation(const std::string &name) const;
+
+    /**
+     * Gets every active uniform of the program
+     * @return Uniforms sorted by name hash
+     */
+    const std::vector<Uniform> &getUniforms() const;
+    /**
+     * Gets every active vertex attribute of the program
+     * @return Attributes sorted by location
+     */
+    const std::vector<Attribute> &getAttributes() const;
+    /**
+     * Checks the program can draw from a vertex layout, printing every attribute it would read wrongly
+     *
+     * Meant to be called once per shader and model pair when loading, rather than while drawing
+     * @param layout Layout of the VAO the shader draws with
+     * @param layoutName Name to print errors under, such as the model's class
+     * @return True if every attribute the program reads is provided by the layout
+     */
+    bool validate(const VertexLayout &layout, const std::string &layoutName) const;
+    /**
+     * Sets the texture unit samplers of the given name read from. Programs built afterwards have their samplers set
+     * when linked, so they needn't be set by hand
+     * @param name Sampler name
+     * @param unit Texture unit, counting from 0 for GL_TEXTURE0
+     */
+    static void setTextureUnit(const std::string &name, int unit);
+    /**
+     * Prints the number of uniform uploads issued and skipped
+     */
+    static void reportUploads();
+    /**
+     * Compiles and links shaders as one batch, skipping any already built
+     *
+     * Every program is submitted before any status is queried, so the driver isn't forced to finish one before
+     * starting the next. With parallel shader compile the programs are finished as the driver completes them,
+     * otherwise all statuses are queried at a single sync point
+     * @param shaders Shaders to build
+     * @return Wall-clock time the batch took in milliseconds
+     */
+    static double buildAll(const std::vector<const Shader *> &shaders);
 
 private:
+    // Compiled stages by type and source hash, kept while any program links them
+    static std::map<std::pair<GLenum, uint64_t>, std::weak_ptr<Stage>> stages;
+    // Linked programs by vertex and fragment source hash, kept while any Shader uses them
+    static std::map<std::pair<uint64_t, uint64_t>, std::weak_ptr<Program>> programs;
+    // Bumped on every change to the program registry, so the watcher can tell when to rescan it
+    static uint64_t registryGeneration;
+    // Texture unit of each sampler by name
+    static std::map<std::string, int> textureUnits;
+
+    // The program this shader draws with, shared with any other Shader of the same sources
+    std::shared_ptr<Program> program;
+
+    /**
+     * Wraps an existing program
+     * @param program Program to draw with
+     */
+    explicit Shader(std::shared_ptr<Program> program);
+    /**
+     * Compiles and links the program if that hasn't happened yet, waiting for it to finish
+     */
+    void build() const;
+    /**
+     * Starts compiling and linking the program without waiting for the result
+     */
+    void submit() const;
+    /**
+     * Checks whether a submitted program can be finished without waiting for the driver
+     * @return True if the driver has completed the program
+     */
+    bool isComplete() const;
+    /**
+     * Checks the result of a submitted program and builds its uniform table
+     */
+    void finish() const;
+    /**
+     * Swaps this shader's linked program into another program, so every Shader using that one draws with it.
+     * Uniform values already set are uploaded to the new program first
+     * @param live Program to replace. Its old OpenGL program is left in this shader to be deleted
+     */
+    void replace(const std::shared_ptr<Program> &live) const;
+    /**
+     * Files a program in the registry under its sources, unless a live program already holds them
+     * @param key Hashes of the vertex and fragment sources
+     * @param program Program to file
+     */
+    static void registerProgram(const std::pair<uint64_t, uint64_t> &key, const std::shared_ptr<Program> &program);
+    /**
+     * Removes a program from the registry, leaving the entry alone if it holds another program
+     * @param key Hashes of the vertex and fragment sources the program was filed under
+     * @param program Program to remove
+     */
+    static void unregisterProgram(const std::pair<uint64_t, uint64_t> &key, const std::shared_ptr<Program> &program);
+    /**
+     * Finds a uniform in the table built after linking
+     * @param name Variable name
+     * @return The uniform, or nullptr if the program has no active uniform of that name
+     */
+    Uniform *findUniform(UniformId name) const;
+    /**
+     * Compares a value against the last one uploaded to a uniform, recording it if it differs
+     * @param uniform Uniform to set, or nullptr if it isn't active
+     * @param value Value to set
+     * @param size Size of the value in bytes
+     * @return True if the value needs uploading
+     */
+    bool needsUpload(Uniform *uniform, const void *value, size_t size) const;
     /**
-     * Links the shader programs together into a single program
+     * Uploads the value recorded for a uniform, to every stage holding it
+     * @param uniform Uniform to upload
+     */
+    void upload(const Uniform &uniform) const;
+    /**
+     * Finds the compiled stage for the source, compiling it if no program currently uses it
+     * @param type GL_VERTEX_SHADER or GL_FRAGMENT_SHADER
+     * @param source Source Code
+     * @param hash Hash of the source code
+     * @return Compiled stage
+     */
+    std::shared_ptr<Stage> getStage(GLenum type, const std::string &source, uint64_t hash) const;
+    /**
+     * Finds the separable program for the source, loading it from the binary cache or compiling and linking it if
+     * no pipeline currently uses it
+     * @param type GL_VERTEX_SHADER or GL_FRAGMENT_SHADER
+     * @param source Source Code
+     * @param hash Hash of the source code
+     * @return Stage holding the separable program
+     */
+    std::shared_ptr<Stage> getSeparableStage(GLenum type, const std::string &source, uint64_t hash) const;
+    /**
+     * Enumerates the active uniforms of the linked program into the uniform table. For a pipeline the table refers
+     * to the uniforms of each stage
+     */
+    void loadUniforms() const;
+    /**
+     * Enumerates the active uniforms of a linked program
+     * @param ID Program ID
+     * @param separable Whether uniforms are set on the program directly rather than while it's in use
+     * @param uniforms Location to store the uniforms, sorted by name hash
+     */
+    void readUniforms(unsigned int ID, bool separable, std::vector<Uniform> *uniforms) const;
+    /**
+     * Enumerates the active vertex attributes of the linked program
+     */
+    void loadAttributes() const;
+    /**
+     * Binds each uniform block of the linked program to its fixed binding point
+     */
+    void bindUniformBlocks() const;
+    /**
+     * Gets the OpenGL programs that make up the shader
+     * @return The linked program, or the separable program of each stage
+     */
+    std::vector<unsigned int> getPrograms() const;
+    /**
+     * Points each sampler of the linked program at its texture unit
+     */
+    void bindSamplers() const;
+    /**
+     * Prints where each attribute, uniform block and sampler of the program is bound
+     */
+    void printBindings() const;
+    /**
+     * Starts linking the shader programs together into a single program
      * @param shaderProgram Location to store the program ID
      * @param vertexShader ID of Vertex Shader to use
      * @param fragmentShader ID of Fragment Shader to use
      */
-    void linkShaders(unsigned int * shaderProgram, unsigned int vertexShader, unsigned int fragmentShader);
+    void linkShaders(unsigned int * shaderProgram, unsigned int vertexShader, unsigned int fragmentShader) const;
+    /**
+     * Checks whether a program linked, printing the error log if not
+     * @param shaderProgram Program ID
+     * @return True if the program linked
+     */
+    bool checkLink(unsigned int shaderProgram) const;
+    /**
+     * Starts linking a stage on its own into a separable program
+     * @param stage Compiled stage
+     */
+    void linkSeparable(Stage &stage) const;
     /**
-     * Creates a vertex shader from the source code
+     * Checks whether a stage's separable program linked, printing the error log if not, and reads its uniforms.
+     * Each stage is only checked once
+     * @param stage Stage to check
+     * @param source Source code of the stage, to save it to the binary cache under
+     * @return True if the program linked
+     */
+    bool checkSeparable(Stage &stage, const std::string &source) const;
+    /**
+     * Starts compiling a vertex shader from the source code
      * @param vertexShaderSource Vertex Shader Source Code
      * @return Vertex Shader ID
      */
-    unsigned int createVertexShader(const char * vertexShaderSource);
+    unsigned int createVertexShader(const char * vertexShaderSource) const;
     /**
-     * Creates a fragment shader from the source code
+     * Starts compiling a fragment shader from the source code
      * @param fragmentShaderSource Fragment Shader Source Code
      * @return Fragment Shader ID
      */
-    unsigned int createFragmentShader(const char * fragmentShaderSource);
-    /**
-     * Reads a vertex file, storing it as a string
-     * @param vertexPath Path to vertex code file
-     * @param vertexCode Location to store the source code extracted
-     */
-    void readVertexFile(const char *vertexPath, std::string * vertexCode);
+    unsigned int createFragmentShader(const char * fragmentShaderSource) const;
     /**
-     * Reads a fragment file, storing it as a string
-     * @param fragmentPath Path to fragment code file
-     * @param fragmentCode Location to store the source code extracted
+     * Checks whether a stage compiled, printing the error log if not. Each stage is only checked once
+     * @param stage Stage to check
      */
-    void readFragmentFile(const char *fragmentPath, std::string * fragmentCode);
+    void checkStage(Stage &stage) const;
 };
 
 #endif //OPENGLPROJECT_SHADER_H
@@ -0,0 +1,125 @@
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <iomanip>
+#include <vector>
+#include "ShaderCache.h"
+#include "Extensions.h"
+#include "Hash.h"
+
+// Identifies cache files written by this program
+static const uint32_t CACHE_MAGIC = 0x42504c47; // "GLPB"
+
+/**
+ * Stored at the start of every cache file
+ */
+struct CacheHeader {
+    uint32_t magic;
+    uint32_t format;
+    uint32_t length;
+    double milliseconds;
+};
+
+std::string ShaderCache::directory;
+int ShaderCache::hits = 0;
+int ShaderCache::misses = 0;
+double ShaderCache::millisecondsSaved = 0.0;
+
+bool ShaderCache::load(unsigned int *program, const std::string &vertexSource, const std::string &fragmentSource)
+{
+    if(!Extensions::programBinary || directory.empty()) return false;
+
+    auto start = std::chrono::steady_clock::now();
+
+    std::ifstream file(getPath(vertexSource, fragmentSource), std::ios::binary);
+    CacheHeader header{};
+    if(!file.read((char *) &header, sizeof(header)) || header.magic != CACHE_MAGIC)
+    {
+        misses++;
+        return false;
+    }
+    std::vector<char> binary(header.length);
+    if(!file.read(binary.data(), header.length))
+    {
+        misses++;
+        return false;
+    }
+
+    *program = glCreateProgram();
+    glProgramBinary(*program, header.format, binary.data(), header.length);
+
+    // The driver rejects binaries from other driver versions, in which case the program is compiled from source
+    int success;
+    glGetProgramiv(*program, GL_LINK_STATUS, &success);
+    if(!success)
+    {
+        glDeleteProgram(*program);
+        *program = 0;
+        misses++;
+        return false;
+    }
+
+    double milliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    hits++;
+    millisecondsSaved += header.milliseconds - milliseconds;
+    std::cout << "INFO::SHADER::PROGRAM::LOADED_FROM_CACHE" << std::endl;
+    return true;
+}
+
+void ShaderCache::prepare(unsigned int program)
+{
+    if(!Extensions::programBinary || directory.empty()) return;
+
+    glProgramParameteri(program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+}
+
+void ShaderCache::save(unsigned int program, const std::string &vertexSource, const std::string &fragmentSource, double milliseconds)
+{
+    if(!Extensions::programBinary || directory.empty()) return;
+
+    int success;
+    glGetProgramiv(program, GL_LINK_STATUS, &success);
+    if(!success) return;
+
+    int length = 0;
+    glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+    if(length <= 0) return;
+
+    std::vector<char> binary(length);
+    GLenum format;
+    glGetProgramBinary(program, length, &length, &format, binary.data());
+
+    std::error_code error;
+    std::filesystem::create_directories(directory, error);
+
+    std::ofstream file(getPath(vertexSource, fragmentSource), std::ios::binary | std::ios::trunc);
+    CacheHeader header{CACHE_MAGIC, format, (uint32_t) length, milliseconds};
+    file.write((const char *) &header, sizeof(header));
+    file.write(binary.data(), length);
+    if(!file)
+    {
+        std::cerr << "ERROR::SHADER::CACHE::WRITE_FAILED " << directory << std::endl;
+    }
+}
+
+void ShaderCache::report()
+{
+    std::cout << "INFO::SHADER::CACHE " << hits << " hits, " << misses << " misses, "
+              << millisecondsSaved << "ms saved" << std::endl;
+}
+
+std::string ShaderCache::getPath(const std::string &vertexSource, const std::string &fragmentSource)
+{
+    // Binaries are only valid for the driver that made them
+    std::string driver = std::string((const char *) glGetString(GL_VENDOR)) + "\n"
+            + (const char *) glGetString(GL_RENDERER) + "\n" + (const char *) glGetString(GL_VERSION);
+    uint64_t key = fnv1a(vertexSource.c_str(), vertexSource.size() + 1);
+    key = fnv1a(fragmentSource.c_str(), fragmentSource.size() + 1, key);
+    key = fnv1a(driver.c_str(), driver.size(), key);
+
+    std::stringstream path;
+    path << directory << std::hex << std::setw(16) << std::setfill('0') << key << ".bin";
+    return path.str();
+}
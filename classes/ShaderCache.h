@@ -0,0 +1,64 @@
+#ifndef OPENGLPROJECT_SHADERCACHE_H
+#define OPENGLPROJECT_SHADERCACHE_H
+
+#include <glad/glad.h>
+
+#include <cstdint>
+#include <string>
+
+/**
+ * Saves linked programs to disk as driver binaries so later launches can skip compiling and linking
+ *
+ * Binaries are keyed by a hash of the shader sources and the driver, so editing a shader or updating the driver
+ * simply misses the cache
+ */
+class ShaderCache {
+public:
+    // Directory binaries are stored in. Empty disables the cache
+    static std::string directory;
+
+    // Number of programs loaded from the cache
+    static int hits;
+    // Number of programs that had to be compiled from source
+    static int misses;
+    // Time the cache hits would have spent compiling and linking, less the time spent loading them
+    static double millisecondsSaved;
+
+    /**
+     * Tries to load a program from the cache
+     * @param program Location to store the program ID
+     * @param vertexSource Vertex Shader Source Code
+     * @param fragmentSource Fragment Shader Source Code
+     * @return True if the program was loaded and linked successfully
+     */
+    static bool load(unsigned int *program, const std::string &vertexSource, const std::string &fragmentSource);
+    /**
+     * Marks a program about to be linked so the driver keeps its binary available
+     * @param program Program ID
+     */
+    static void prepare(unsigned int program);
+    /**
+     * Saves a linked program to the cache
+     * @param program Program ID
+     * @param vertexSource Vertex Shader Source Code
+     * @param fragmentSource Fragment Shader Source Code
+     * @param milliseconds Time it took to compile and link the program from source
+     */
+    static void save(unsigned int program, const std::string &vertexSource, const std::string &fragmentSource, double milliseconds);
+    /**
+     * Prints the number of hits and misses and the time saved
+     */
+    static void report();
+
+private:
+    /**
+     * Finds the file a program's binary is stored in
+     * @param vertexSource Vertex Shader Source Code
+     * @param fragmentSource Fragment Shader Source Code
+     * @return Path to the cache file
+     */
+    static std::string getPath(const std::string &vertexSource, const std::string &fragmentSource);
+};
+
+
+#endif //OPENGLPROJECT_SHADERCACHE_H
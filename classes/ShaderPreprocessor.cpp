@@ -0,0 +1,112 @@
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include "ShaderPreprocessor.h"
+
+const std::map<std::string, std::string> *ShaderPreprocessor::embedded = nullptr;
+
+ShaderPreprocessor::ShaderPreprocessor(std::string location) : location(std::move(location)) {}
+
+bool ShaderPreprocessor::process(const std::string &path, const ShaderDefines &defines, std::string *source)
+{
+    files.clear();
+    included.clear();
+    source->clear();
+    return expand(path, &defines, source);
+}
+
+const std::vector<std::string> &ShaderPreprocessor::getFiles() const
+{
+    return files;
+}
+
+bool ShaderPreprocessor::expand(const std::string &path, const ShaderDefines *defines, std::string *output)
+{
+    // Every file is included once, which also stops include cycles
+    if(!included.insert(path).second) return true;
+
+    std::string code;
+    if(!read(path, &code)) return false;
+
+    int number = (int) files.size();
+    files.push_back(path);
+    if(defines == nullptr) *output += "#line 1 " + std::to_string(number) + "\n";
+
+    std::istringstream lines(code);
+    std::string line;
+    int lineNumber = 0;
+    while(std::getline(lines, line))
+    {
+        lineNumber++;
+        size_t start = line.find_first_not_of(" \t");
+        std::string directive = start == std::string::npos ? "" : line.substr(start);
+
+        if(directive.compare(0, 8, "#include") == 0)
+        {
+            size_t open = directive.find('"');
+            size_t close = directive.find('"', open + 1);
+            if(open == std::string::npos || close == std::string::npos)
+            {
+                std::cerr << "ERROR::SHADER::PREPROCESSOR::INVALID_INCLUDE " << path << ":" << lineNumber << std::endl;
+                return false;
+            }
+            if(!expand(directive.substr(open + 1, close - open - 1), nullptr, output)) return false;
+
+            // Puts compiler errors after the include back in this file
+            *output += "#line " + std::to_string(lineNumber + 1) + " " + std::to_string(number) + "\n";
+        }
+        else if(directive.compare(0, 8, "#version") == 0)
+        {
+            *output += line + "\n";
+            if(defines != nullptr)
+            {
+                for(const auto &define : *defines)
+                {
+                    *output += "#define " + define.first + " " + define.second + "\n";
+                }
+            }
+            *output += "#line " + std::to_string(lineNumber + 1) + " " + std::to_string(number) + "\n";
+        }
+        else
+        {
+            *output += line + "\n";
+        }
+    }
+    return true;
+}
+
+bool ShaderPreprocessor::read(const std::string &path, std::string *code) const
+{
+    if(embedded != nullptr)
+    {
+        auto source = embedded->find(path);
+        if(source != embedded->end())
+        {
+            *code = source->second;
+            return true;
+        }
+    }
+    return readFile(location + path, code);
+}
+
+bool ShaderPreprocessor::readFile(const std::string &path, std::string *code)
+{
+    std::ifstream file;
+    // Ensure ifstream objects can throw exceptions:
+    file.exceptions (std::ifstream::failbit | std::ifstream::badbit);
+    try
+    {
+        file.open(path);
+        std::stringstream stream;
+        // Read file's buffer contents into streams
+        stream << file.rdbuf();
+        file.close();
+        *code = stream.str();
+        return true;
+    }
+    catch(std::ifstream::failure &e)
+    {
+        std::cerr << "ERROR::SHADER::FILE_NOT_SUCCESFULLY_READ " << path << std::endl;
+        return false;
+    }
+}
@@ -0,0 +1,74 @@
+#ifndef OPENGLPROJECT_SHADERPREPROCESSOR_H
+#define OPENGLPROJECT_SHADERPREPROCESSOR_H
+
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+// Macros to define when building a shader permutation, by name and value
+typedef std::map<std::string, std::string> ShaderDefines;
+
+/**
+ * Expands the directives GLSL itself doesn't support before a shader is compiled
+ *
+ * Supports #include "file" relative to the shaders directory, with each file included at most once, and inserts
+ * #define lines after #version so one source can build several permutations
+ */
+class ShaderPreprocessor {
+public:
+    // Sources built into the program by path relative to shaders, read instead of the files when set. Files not
+    // found in it are still read from disk
+    static const std::map<std::string, std::string> *embedded;
+
+    /**
+     * Creates a preprocessor resolving files from the given directory
+     * @param location Location of shaders path (Use Path.shaders)
+     */
+    explicit ShaderPreprocessor(std::string location);
+
+    /**
+     * Reads a shader, expanding its includes and adding the defines
+     * @param path Path to the shader relative to shaders
+     * @param defines Macros to define
+     * @param source Location to store the preprocessed source code
+     * @return True if the shader and everything it includes was read
+     */
+    bool process(const std::string &path, const ShaderDefines &defines, std::string *source);
+    /**
+     * Gets the files read by the last call to process, in the order of the #line source numbers given to them
+     * @return Paths relative to shaders
+     */
+    const std::vector<std::string> &getFiles() const;
+
+private:
+    std::string location;
+    std::vector<std::string> files;
+    std::set<std::string> included;
+
+    /**
+     * Appends a file to the output, recursively expanding its includes
+     * @param path Path to the file relative to shaders
+     * @param defines Macros to define after #version, or nullptr if this is an included file
+     * @param output Location to append the source code to
+     * @return True if the file and everything it includes was read
+     */
+    bool expand(const std::string &path, const ShaderDefines *defines, std::string *output);
+    /**
+     * Gets a file's source, from the embedded sources if it's there and from disk otherwise
+     * @param path Path to the file relative to shaders
+     * @param code Location to store the source code
+     * @return True if the file was found
+     */
+    bool read(const std::string &path, std::string *code) const;
+    /**
+     * Reads a file, storing it as a string
+     * @param path Path to the file
+     * @param code Location to store the source code extracted
+     * @return True if the file was read
+     */
+    static bool readFile(const std::string &path, std::string *code);
+};
+
+
+#endif //OPENGLPROJECT_SHADERPREPROCESSOR_H
@@ -0,0 +1,223 @@
+#include <algorithm>
+#include <iostream>
+#include "ShaderProfiler.h"
+#include "DrawList.h"
+#include "Extensions.h"
+
+ShaderProfiler *ShaderProfiler::active = nullptr;
+
+ShaderProfiler::ShaderProfiler(const std::string &csvPath)
+{
+    if(csvPath.empty()) return;
+    csv.open(csvPath);
+    if(!csv)
+    {
+        std::cerr << "ERROR::PROFILER::CSV_NOT_OPENED " << csvPath << std::endl;
+        return;
+    }
+    csv << "frame,program,draw_calls,vertices,cpu_ms,gpu_ms\n";
+}
+
+ShaderProfiler::~ShaderProfiler()
+{
+    if(active == this) active = nullptr;
+    for(const Frame &frame : frames)
+    {
+        for(const Scope &scope : frame.scopes) queries.push_back(scope.query);
+    }
+    if(!queries.empty()) glDeleteQueries((int) queries.size(), queries.data());
+}
+
+void ShaderProfiler::beginFrame()
+{
+    frames.push_back({frameNumber++, {}, {}});
+    if(current != -1) openScope(current);
+}
+
+void ShaderProfiler::endFrame()
+{
+    if(frames.empty()) return;
+    int program = current;
+    closeScope();
+    // Remembered so the next frame carries on with the same program
+    current = program;
+    readFrames();
+}
+
+void ShaderProfiler::use(const Program &program)
+{
+    if(frames.empty()) return;
+
+    auto index = indices.find(program.serial);
+    if(index == indices.end())
+    {
+        std::string name = program.vertexPath + " " + program.fragmentPath;
+        for(const auto &define : program.defines)
+        {
+            name += " " + define.first + "=" + define.second;
+        }
+        index = indices.emplace(program.serial, (int) names.size()).first;
+        names.push_back(name);
+    }
+    if(index->second == current) return;
+
+    closeScope();
+    openScope(index->second);
+}
+
+void ShaderProfiler::draw(long vertices)
+{
+    if(frames.empty() || current == -1) return;
+    ProgramCost &cost = costOf(current);
+    cost.drawCalls++;
+    cost.vertices += vertices;
+}
+
+const std::vector<ProgramCost> &ShaderProfiler::getFrame() const
+{
+    return latest;
+}
+
+void ShaderProfiler::report() const
+{
+    if(framesRead == 0)
+    {
+        std::cout << "INFO::PROFILER::NO_FRAMES_READ" << std::endl;
+        return;
+    }
+    std::vector<ProgramCost> averages = totals;
+    std::sort(averages.begin(), averages.end(),
+            [](const ProgramCost &a, const ProgramCost &b) { return a.gpuMilliseconds > b.gpuMilliseconds; });
+    std::cout << "INFO::PROFILER::AVERAGE_PER_FRAME over " << framesRead << " frames" << std::endl;
+    for(const ProgramCost &cost : averages)
+    {
+        std::cout << "    " << cost.name << ": " << (double) cost.drawCalls / framesRead << " draws, "
+                  << (double) cost.vertices / framesRead << " vertices, "
+                  << cost.cpuMilliseconds / framesRead << "ms CPU, "
+                  << cost.gpuMilliseconds / framesRead << "ms GPU" << std::endl;
+    }
+}
+
+void ShaderProfiler::drawArrays(GLenum mode, int first, int count)
+{
+    glDrawArrays(mode, first, count);
+    if(active) active->draw(count);
+}
+
+void ShaderProfiler::drawElements(GLenum mode, int count, GLenum type, size_t offset, int baseVertex)
+{
+    glDrawElementsBaseVertex(mode, count, type, (void *) offset, baseVertex);
+    if(active) active->draw(count);
+}
+
+void ShaderProfiler::drawArraysInstanced(GLenum mode, int first, int count, int instances)
+{
+    glDrawArraysInstanced(mode, first, count, instances);
+    if(active) active->draw((long) count * instances);
+}
+
+void ShaderProfiler::drawElementsInstanced(GLenum mode, int count, GLenum type, size_t offset, int instances, int baseVertex)
+{
+    glDrawElementsInstancedBaseVertex(mode, count, type, (void *) offset, instances, baseVertex);
+    if(active) active->draw((long) count * instances);
+}
+
+void ShaderProfiler::multiDrawElementsIndirect(GLenum mode, GLenum type, size_t offset,
+        const DrawElementsIndirectCommand *commands, int drawCount)
+{
+    glMultiDrawElementsIndirect(mode, type, (void *) offset, drawCount, 0);
+    if(!active) return;
+    long vertices = 0;
+    for(int i = 0; i < drawCount; i++)
+    {
+        vertices += (long) commands[i].count * commands[i].instanceCount;
+    }
+    active->draw(vertices);
+}
+
+void ShaderProfiler::openScope(int program)
+{
+    unsigned int query;
+    if(queries.empty())
+    {
+        glGenQueries(1, &query);
+    }
+    else
+    {
+        query = queries.back();
+        queries.pop_back();
+    }
+    // Only one GL_TIME_ELAPSED query can run at once, which is why scopes never overlap
+    glBeginQuery(GL_TIME_ELAPSED, query);
+    frames.back().scopes.push_back({program, query});
+    current = program;
+    scopeStarted = std::chrono::steady_clock::now();
+}
+
+void ShaderProfiler::closeScope()
+{
+    if(current == -1) return;
+    glEndQuery(GL_TIME_ELAPSED);
+    costOf(current).cpuMilliseconds += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - scopeStarted).count();
+    current = -1;
+}
+
+ProgramCost &ShaderProfiler::costOf(int program)
+{
+    std::vector<ProgramCost> &costs = frames.back().costs;
+    if(costs.size() <= (size_t) program) costs.resize(program + 1);
+    return costs[program];
+}
+
+void ShaderProfiler::readFrames()
+{
+    // The frame being recorded is never read
+    while(frames.size() > 1)
+    {
+        Frame &frame = frames.front();
+        // Queries finish in order, so the frame is done once its last one is
+        if(!frame.scopes.empty())
+        {
+            int available;
+            glGetQueryObjectiv(frame.scopes.back().query, GL_QUERY_RESULT_AVAILABLE, &available);
+            if(!available) return;
+        }
+
+        frame.costs.resize(names.size());
+        for(const Scope &scope : frame.scopes)
+        {
+            GLuint64 nanoseconds;
+            glGetQueryObjectui64v(scope.query, GL_QUERY_RESULT, &nanoseconds);
+            frame.costs[scope.program].gpuMilliseconds += nanoseconds / 1e6;
+            queries.push_back(scope.query);
+        }
+
+        // The first frame pays for the driver compiling each program on its first draw, so isn't averaged
+        bool averaged = frame.number > 0;
+        totals.resize(names.size());
+        for(size_t i = 0; i < names.size(); i++)
+        {
+            ProgramCost &cost = frame.costs[i];
+            cost.name = names[i];
+            totals[i].name = names[i];
+            if(averaged)
+            {
+                totals[i].drawCalls += cost.drawCalls;
+                totals[i].vertices += cost.vertices;
+                totals[i].cpuMilliseconds += cost.cpuMilliseconds;
+                totals[i].gpuMilliseconds += cost.gpuMilliseconds;
+            }
+            if(csv.is_open())
+            {
+                csv << frame.number << ",\"" << cost.name << "\"," << cost.drawCalls << "," << cost.vertices << ","
+                    << cost.cpuMilliseconds << "," << cost.gpuMilliseconds << "\n";
+            }
+        }
+        if(averaged) framesRead++;
+
+        latest = std::move(frame.costs);
+        std::sort(latest.begin(), latest.end(),
+                [](const ProgramCost &a, const ProgramCost &b) { return a.gpuMilliseconds > b.gpuMilliseconds; });
+        frames.pop_front();
+    }
+}
@@ -0,0 +1,183 @@
+#ifndef OPENGLPROJECT_SHADERPROFILER_H
+#define OPENGLPROJECT_SHADERPROFILER_H
+
+#include <glad/glad.h>
+
+#include <chrono>
+#include <deque>
+#include <fstream>
+#include <map>
+#include <string>
+#include <vector>
+#include "Shader.h"
+
+struct DrawElementsIndirectCommand;
+
+/**
+ * What one program cost over a frame
+ */
+struct ProgramCost {
+    // Shader sources and defines the program was built from
+    std::string name;
+    int drawCalls = 0;
+    long vertices = 0;
+    // Time spent issuing the program's work, from each use until the next program is used
+    double cpuMilliseconds = 0;
+    // Time the GPU spent on the same work
+    double gpuMilliseconds = 0;
+};
+
+/**
+ * Attributes draw calls, vertices, and CPU and GPU time to the program in use
+ *
+ * While active, each Shader::use opens a scope for its program that lasts until the next use, timed on the GPU with a
+ * GL_TIME_ELAPSED query. Queries are read a few frames later, once available, so profiling never waits on the GPU
+ */
+class ShaderProfiler {
+public:
+    // Profiler that Shader::use and the draw functions report to, or nullptr when not profiling
+    static ShaderProfiler *active;
+
+    /**
+     * Creates a profiler. Set it as active to start profiling
+     * @param csvPath File to write every frame's costs to, or empty to not write them
+     */
+    explicit ShaderProfiler(const std::string &csvPath = "");
+    /**
+     * Deletes the queries, discarding frames not yet read
+     */
+    ~ShaderProfiler();
+    ShaderProfiler(const ShaderProfiler &) = delete;
+    ShaderProfiler &operator=(const ShaderProfiler &) = delete;
+
+    /**
+     * Starts a frame. The program left in use by the last frame keeps being profiled
+     */
+    void beginFrame();
+    /**
+     * Ends the frame, and reads any earlier frames whose GPU times are available
+     */
+    void endFrame();
+    /**
+     * Records that a program is now in use, closing the previous program's scope. Called by Shader::use
+     * @param program Program now in use
+     */
+    void use(const Program &program);
+    /**
+     * Records a draw call for the program in use
+     * @param vertices Number of vertices drawn
+     */
+    void draw(long vertices);
+    /**
+     * Gets the latest frame whose GPU times have been read
+     * @return Costs of every program seen so far, most expensive on the GPU first
+     */
+    const std::vector<ProgramCost> &getFrame() const;
+    /**
+     * Prints the average cost per frame of each program
+     */
+    void report() const;
+
+    /**
+     * Draws with glDrawArrays, recording it for the active profiler if there is one
+     * @param mode Primitive type, such as GL_TRIANGLES
+     * @param first First vertex to draw
+     * @param count Number of vertices to draw
+     */
+    static void drawArrays(GLenum mode, int first, int count);
+    /**
+     * Draws with glDrawElementsBaseVertex, recording it for the active profiler if there is one
+     * @param mode Primitive type, such as GL_TRIANGLES
+     * @param count Number of indices to draw
+     * @param type Type of the indices, such as GL_UNSIGNED_SHORT
+     * @param offset Offset of the first index into the element buffer in bytes
+     * @param baseVertex Added to every index, for meshes sharing a vertex buffer
+     */
+    static void drawElements(GLenum mode, int count, GLenum type, size_t offset, int baseVertex = 0);
+    /**
+     * Draws with glDrawArraysInstanced, recording it for the active profiler if there is one
+     * @param mode Primitive type, such as GL_TRIANGLES
+     * @param first First vertex to draw
+     * @param count Number of vertices to draw of each instance
+     * @param instances Number of instances
+     */
+    static void drawArraysInstanced(GLenum mode, int first, int count, int instances);
+    /**
+     * Draws with glDrawElementsInstancedBaseVertex, recording it for the active profiler if there is one
+     * @param mode Primitive type, such as GL_TRIANGLES
+     * @param count Number of indices to draw of each instance
+     * @param type Type of the indices, such as GL_UNSIGNED_SHORT
+     * @param offset Offset of the first index into the element buffer in bytes
+     * @param instances Number of instances
+     * @param baseVertex Added to every index, for meshes sharing a vertex buffer
+     */
+    static void drawElementsInstanced(GLenum mode, int count, GLenum type, size_t offset, int instances, int baseVertex = 0);
+    /**
+     * Draws with glMultiDrawElementsIndirect from the bound indirect buffer, recording it as one draw call for the
+     * active profiler if there is one
+     * @param mode Primitive type, such as GL_TRIANGLES
+     * @param type Type of the indices, such as GL_UNSIGNED_SHORT
+     * @param offset Offset of the first command into the indirect buffer in bytes
+     * @param commands Copy of the commands in the indirect buffer, to count the vertices drawn
+     * @param drawCount Number of commands
+     */
+    static void multiDrawElementsIndirect(GLenum mode, GLenum type, size_t offset, const DrawElementsIndirectCommand *commands,
+            int drawCount);
+
+private:
+    /**
+     * A period one program was in use, timed by a query
+     */
+    struct Scope {
+        int program;
+        unsigned int query;
+    };
+    /**
+     * A frame waiting for its queries to be read
+     */
+    struct Frame {
+        long number;
+        std::vector<ProgramCost> costs;
+        std::vector<Scope> scopes;
+    };
+
+    // Index of each program seen by its serial, into the costs of a frame
+    std::map<uint64_t, int> indices;
+    std::vector<std::string> names;
+    // Frames whose queries haven't been read, oldest first. The last is the frame being recorded
+    std::deque<Frame> frames;
+    // Queries no longer in use, to reuse
+    std::vector<unsigned int> queries;
+    // Program the open scope is for, or -1 if none is open
+    int current = -1;
+    std::chrono::steady_clock::time_point scopeStarted;
+    long frameNumber = 0;
+
+    std::vector<ProgramCost> latest;
+    std::vector<ProgramCost> totals;
+    long framesRead = 0;
+    std::ofstream csv;
+
+    /**
+     * Starts timing a program in the frame being recorded
+     * @param program Index of the program
+     */
+    void openScope(int program);
+    /**
+     * Stops timing the open scope
+     */
+    void closeScope();
+    /**
+     * Gets the costs of a program in the frame being recorded
+     * @param program Index of the program
+     * @return Costs so far
+     */
+    ProgramCost &costOf(int program);
+    /**
+     * Reads the queries of every finished frame whose results are available, oldest first
+     */
+    void readFrames();
+};
+
+
+#endif //OPENGLPROJECT_SHADERPROFILER_H
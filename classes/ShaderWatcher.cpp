@@ -0,0 +1,206 @@
+#include <algorithm>
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#include "ShaderWatcher.h"
+
+ShaderWatcher::ShaderWatcher(std::string location) : location(std::move(location))
+{
+    descriptor = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    // Editors either write the file in place or write a new one and rename it over the old
+    if(descriptor == -1 || inotify_add_watch(descriptor, this->location.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO) == -1)
+    {
+        std::cerr << "ERROR::SHADER::WATCHER::INOTIFY_FAILED " << this->location << std::endl;
+        if(descriptor != -1) close(descriptor);
+        descriptor = -1;
+        return;
+    }
+
+    watchPrograms(true);
+    running = true;
+    thread = std::thread(&ShaderWatcher::run, this);
+    std::cout << "INFO::SHADER::WATCHER::WATCHING " << this->location << std::endl;
+}
+
+ShaderWatcher::~ShaderWatcher()
+{
+    running = false;
+    if(thread.joinable()) thread.join();
+    if(descriptor != -1) close(descriptor);
+}
+
+void ShaderWatcher::update()
+{
+    if(descriptor == -1) return;
+    updates++;
+    watchPrograms(false);
+
+    // Set when a program's files may have changed
+    bool rewatch = false;
+    std::vector<Reload> ready;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        ready.swap(reloads);
+    }
+    for(Reload &reload : ready)
+    {
+        std::shared_ptr<Program> live = reload.program.lock();
+        if(!live) continue;
+
+        uint64_t vertexHash = fnv1a(reload.vertexSource.c_str(), reload.vertexSource.size());
+        uint64_t fragmentHash = fnv1a(reload.fragmentSource.c_str(), reload.fragmentSource.size());
+        // Saving a file without changing what this program compiles leaves it alone
+        if(vertexHash == live->vertexHash && fragmentHash == live->fragmentHash) continue;
+
+        // A program nobody has used yet is only compiled when first used, so it just takes the new sources
+        if(!live->submitted)
+        {
+            Shader::unregisterProgram(std::make_pair(live->vertexHash, live->fragmentHash), live);
+            Shader::registerProgram(std::make_pair(vertexHash, fragmentHash), live);
+            live->files = std::move(reload.files);
+            live->vertexSource = std::move(reload.vertexSource);
+            live->fragmentSource = std::move(reload.fragmentSource);
+            live->vertexHash = vertexHash;
+            live->fragmentHash = fragmentHash;
+            rewatch = true;
+            continue;
+        }
+
+        auto rebuilt = std::make_shared<Program>();
+        rebuilt->vertexPath = live->vertexPath;
+        rebuilt->fragmentPath = live->fragmentPath;
+        rebuilt->location = live->location;
+        rebuilt->defines = live->defines;
+        rebuilt->files = std::move(reload.files);
+        rebuilt->vertexSource = std::move(reload.vertexSource);
+        rebuilt->fragmentSource = std::move(reload.fragmentSource);
+        rebuilt->vertexHash = vertexHash;
+        rebuilt->fragmentHash = fragmentHash;
+
+        // A newer edit supersedes a rebuild still compiling
+        building.erase(std::remove_if(building.begin(), building.end(),
+                [&live](const Rebuild &entry) { return entry.live.lock() == live; }),
+                building.end());
+
+        Shader shader(rebuilt);
+        shader.submit();
+        building.push_back(Rebuild{live, std::move(shader), updates});
+        std::cout << "INFO::SHADER::WATCHER::REBUILDING " << live->vertexPath << " " << live->fragmentPath << std::endl;
+    }
+
+    for(auto it = building.begin(); it != building.end();)
+    {
+        // Without parallel shader compile a rebuild always looks complete, so it's left to the driver for a frame
+        const Shader &shader = it->shader;
+        if(it->submitted == updates || !shader.isComplete())
+        {
+            ++it;
+            continue;
+        }
+
+        shader.finish();
+        std::shared_ptr<Program> live = it->live.lock();
+        if(live && shader.program->linked)
+        {
+            shader.replace(live);
+            rewatch = true;
+            std::cout << "INFO::SHADER::WATCHER::RELOADED " << live->vertexPath << " " << live->fragmentPath << std::endl;
+        }
+        else if(live)
+        {
+            std::cerr << "ERROR::SHADER::WATCHER::KEEPING_PREVIOUS " << live->vertexPath << " " << live->fragmentPath << std::endl;
+        }
+        // Deletes whichever OpenGL program is no longer used
+        it = building.erase(it);
+    }
+
+    // A rebuilt program may include different files
+    if(rewatch) watchPrograms(true);
+}
+
+void ShaderWatcher::run()
+{
+    alignas(inotify_event) char buffer[4096];
+    std::set<std::string> changed;
+    while(running)
+    {
+        pollfd events{descriptor, POLLIN, 0};
+        // Times out regularly so the thread notices it has been stopped
+        int ready = poll(&events, 1, 100);
+        if(ready > 0)
+        {
+            ssize_t length = read(descriptor, buffer, sizeof(buffer));
+            for(ssize_t offset = 0; offset < length;)
+            {
+                auto *event = (inotify_event *) (buffer + offset);
+                if(event->len > 0) changed.insert(event->name);
+                offset += sizeof(inotify_event) + event->len;
+            }
+        }
+        // Editors often write a file in several steps, so sources are only reread once nothing has changed for a poll
+        else if(ready == 0 && !changed.empty())
+        {
+            reread(changed);
+            changed.clear();
+        }
+    }
+}
+
+void ShaderWatcher::reread(const std::set<std::string> &changed)
+{
+    std::vector<Source> watched;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        watched = sources;
+    }
+
+    for(const Source &source : watched)
+    {
+        bool affected = std::any_of(source.files.begin(), source.files.end(),
+                [&changed](const std::string &file) { return changed.count(file) > 0; });
+        if(!affected) continue;
+
+        Reload reload;
+        reload.program = source.program;
+        ShaderPreprocessor preprocessor(location);
+        bool read = preprocessor.process(source.vertexPath, source.defines, &reload.vertexSource);
+        reload.files = preprocessor.getFiles();
+        read = read && preprocessor.process(source.fragmentPath, source.defines, &reload.fragmentSource);
+        reload.files.insert(reload.files.end(), preprocessor.getFiles().begin(), preprocessor.getFiles().end());
+        if(!read)
+        {
+            std::cerr << "ERROR::SHADER::WATCHER::PREPROCESSING_FAILED " << source.vertexPath << " " << source.fragmentPath << std::endl;
+            continue;
+        }
+
+        std::lock_guard<std::mutex> lock(mutex);
+        reloads.push_back(std::move(reload));
+    }
+}
+
+void ShaderWatcher::watchPrograms(bool force)
+{
+    if(!force && Shader::registryGeneration == registered) return;
+    registered = Shader::registryGeneration;
+
+    std::vector<Source> watched;
+    std::set<const Program *> found;
+    for(const auto &entry : Shader::programs)
+    {
+        std::shared_ptr<Program> program = entry.second.lock();
+        if(!program) continue;
+        watched.push_back({program, program->vertexPath, program->fragmentPath, program->defines, program->files});
+        found.insert(program.get());
+    }
+    // A program rebuilt to the same sources as another is left out of the registry, but is still watched
+    for(const Source &source : sources)
+    {
+        std::shared_ptr<Program> program = source.program.lock();
+        if(!program || found.count(program.get())) continue;
+        watched.push_back({program, program->vertexPath, program->fragmentPath, program->defines, program->files});
+        found.insert(program.get());
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+    sources.swap(watched);
+}
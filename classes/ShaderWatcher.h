@@ -0,0 +1,112 @@
+#ifndef OPENGLPROJECT_SHADERWATCHER_H
+#define OPENGLPROJECT_SHADERWATCHER_H
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+#include "Shader.h"
+
+/**
+ * Rebuilds shaders while the program runs whenever their source files are saved
+ *
+ * A background thread waits on inotify for changes to the shaders directory and rereads the sources of every program
+ * using a changed file. The new programs are compiled without waiting on them, and swapped into the live programs by
+ * update once linked, so every Shader using them picks up the change. A program that fails to build is discarded,
+ * leaving the old one drawing
+ *
+ * A rebuild is never finished in the frame it was submitted. With parallel shader compile it is finished once the
+ * driver reports it complete. Without it there is no way to ask, so it is finished the next frame, giving a driver
+ * that compiles on its own threads a frame to do so. A driver that only compiles when the status is queried, or
+ * that compiles inside glCompileShader and glLinkProgram, still stalls the frame that does so
+ */
+class ShaderWatcher {
+public:
+    /**
+     * Starts watching the shaders directory. Does nothing if inotify isn't available
+     * @param location Location of shaders path (Use Path.shaders)
+     */
+    explicit ShaderWatcher(std::string location);
+    /**
+     * Stops the background thread and discards any rebuild in progress
+     */
+    ~ShaderWatcher();
+    ShaderWatcher(const ShaderWatcher &) = delete;
+    ShaderWatcher &operator=(const ShaderWatcher &) = delete;
+
+    /**
+     * Starts compiling any sources reread since the last call, and swaps in those submitted on an earlier call that
+     * the driver has finished. Never waits on the disk or, with parallel shader compile, the driver. Call once a
+     * frame, between frames
+     */
+    void update();
+
+private:
+    /**
+     * What the background thread needs to reread a program, copied so it never touches the program itself
+     */
+    struct Source {
+        std::weak_ptr<Program> program;
+        std::string vertexPath;
+        std::string fragmentPath;
+        ShaderDefines defines;
+        std::vector<std::string> files;
+    };
+    /**
+     * Sources reread for a program, waiting to be compiled
+     */
+    struct Reload {
+        std::weak_ptr<Program> program;
+        std::string vertexSource;
+        std::string fragmentSource;
+        std::vector<std::string> files;
+    };
+    /**
+     * A rebuild submitted to the driver, with the program it replaces
+     */
+    struct Rebuild {
+        std::weak_ptr<Program> live;
+        Shader shader;
+        // Call of update it was submitted on
+        uint64_t submitted;
+    };
+
+    std::string location;
+    // inotify instance, or -1 if watching failed
+    int descriptor = -1;
+    std::thread thread;
+    std::atomic<bool> running{false};
+
+    // Guards sources and reloads, which are shared with the background thread
+    std::mutex mutex;
+    std::vector<Source> sources;
+    std::vector<Reload> reloads;
+
+    // Generation of the program registry when sources was last filled
+    uint64_t registered = 0;
+    // Number of calls to update so far
+    uint64_t updates = 0;
+    // Rebuilds submitted to the driver and not yet finished
+    std::vector<Rebuild> building;
+
+    /**
+     * Waits for changes on the background thread, rereading the affected sources once writes have settled
+     */
+    void run();
+    /**
+     * Rereads the sources of every program using one of the changed files
+     * @param changed Names of the changed files
+     */
+    void reread(const std::set<std::string> &changed);
+    /**
+     * Refreshes the list of programs to watch from the program registry if it has changed
+     * @param force Whether to refresh even if the registry hasn't changed
+     */
+    void watchPrograms(bool force);
+};
+
+
+#endif //OPENGLPROJECT_SHADERWATCHER_H
@@ -2,43 +2,24 @@
 #include <glm/gtc/type_ptr.hpp>
 #include "SquareModel.h"
 
-SquareModel::SquareModel() : Model((float*) sq_vertices, 24)
+SquareModel::SquareModel() : Model(MeshBuilder::weld(sq_vertices, sizeof(sq_vertices) / sizeof(float), 4, "SquareModel"),
+        VertexLayout{4 * sizeof(float), {
+        // Position, Texture
+        {0, 2, GL_FLOAT, 0},
+        {1, 2, GL_FLOAT, 2 * sizeof(float)}
+}})
 {
-    // Position
-    // Tells OpenGL how to interpret the vertex buffer data
-    // Index, Size, Type, Normalized, Stride, Pointer
-    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 4 * sizeof(float), (void *) 0);
-    // Enables a generic vertex attribute at the given index
-    glEnableVertexAttribArray(0);
-
-    // Location
-    // Tells OpenGL how to interpret the vertex buffer data
-    // Index, Size, Type, Normalized, Stride, Pointer
-    glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 4 * sizeof(float), (void *) (2 * sizeof(float)));
-    // Enables a generic vertex attribute at the given index
-    glEnableVertexAttribArray(1);
-
-    // Note that this is allowed, the call to glVertexAttribPointer registered VBO as the vertex attribute's bound vertex buffer object so afterwards we can safely unbind
-    // Unbinds the buffer
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
-
-    // You can unbind the VAO afterwards so other VAO calls won't accidentally modify this VAO, but this rarely happens. Modifying other
-    // VAOs requires a call to glBindVertexArray anyways so we generally don't unbind VAOs (nor VBOs) when it's not directly necessary.
-    glBindVertexArray(0);
 }
 
-void SquareModel::draw(glm::vec2 position, glm::vec2 screen, glm::vec2 size, Shader shader) {
+void SquareModel::draw(glm::vec2 position, glm::vec2 screen, glm::vec2 size, const Shader &shader) {
     shader.use();
 
     // Creates the model matrix by translating by coordinates
-    int positionLoc = glGetUniformLocation(shader.ID, "position");
-    glUniform2fv(positionLoc, 1, glm::value_ptr(position));
-    int screenLoc = glGetUniformLocation(shader.ID, "screen");
-    glUniform2fv(screenLoc, 1, glm::value_ptr(screen));
-    int sizeLoc = glGetUniformLocation(shader.ID, "size");
-    glUniform2fv(sizeLoc, 1, glm::value_ptr(size));
+    shader.setVec2("position"_u, position);
+    shader.setVec2("screen"_u, screen);
+    shader.setVec2("size"_u, size);
 
-    glDrawArrays(GL_TRIANGLES, 0, 6);
+    drawMesh(6);
 }
 
-void SquareModel::drawS(glm::vec3 position, Shader shader, float size){}
\ No newline at end of file
+void SquareModel::drawS(glm::vec3 position, const Shader &shader, float size){}
\ No newline at end of file
@@ -0,0 +1,187 @@
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include "StreamBuffer.h"
+
+StreamBuffer *StreamBuffer::active = nullptr;
+
+// Every offset alignment OpenGL requires, such as GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, is at most this
+static const size_t MAXIMUM_ALIGNMENT = 256;
+
+StreamBuffer::StreamBuffer(size_t regionSize, int regions, bool persistent)
+        : regionSize((regionSize + MAXIMUM_ALIGNMENT - 1) / MAXIMUM_ALIGNMENT * MAXIMUM_ALIGNMENT), regions(regions),
+          persistent(persistent), fences(regions, nullptr)
+{
+    create();
+}
+
+StreamBuffer::~StreamBuffer()
+{
+    for(GLsync fence : fences)
+    {
+        if(fence) glDeleteSync(fence);
+    }
+    if(persistent)
+    {
+        glBindBuffer(GL_COPY_WRITE_BUFFER, buffer);
+        glUnmapBuffer(GL_COPY_WRITE_BUFFER);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+    }
+    glDeleteBuffers(1, &buffer);
+    if(!retired.empty()) glDeleteBuffers((int) retired.size(), retired.data());
+}
+
+void StreamBuffer::create()
+{
+    size_t size = regionSize * regions;
+    glGenBuffers(1, &buffer);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, buffer);
+    if(persistent)
+    {
+        GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+        glBufferStorage(GL_COPY_WRITE_BUFFER, size, nullptr, flags);
+        mapping = (unsigned char *) glMapBufferRange(GL_COPY_WRITE_BUFFER, 0, size, flags);
+        if(mapping == nullptr)
+        {
+            // Storage can't be respecified, so the fallback needs a new buffer
+            std::cerr << "ERROR::STREAM_BUFFER::PERSISTENT_MAP_FAILED mapping each write instead" << std::endl;
+            glDeleteBuffers(1, &buffer);
+            glGenBuffers(1, &buffer);
+            glBindBuffer(GL_COPY_WRITE_BUFFER, buffer);
+            persistent = false;
+        }
+    }
+    if(!persistent) glBufferData(GL_COPY_WRITE_BUFFER, size, nullptr, GL_STREAM_DRAW);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+}
+
+void *StreamBuffer::map(size_t size, size_t alignment, size_t *offset)
+{
+    size_t start = (head + alignment - 1) / alignment * alignment;
+    if(start + size > regionSize)
+    {
+        if(size > regionSize) resize(size);
+        else advance();
+        start = 0;
+    }
+    head = start + size;
+    *offset = region * regionSize + start;
+    stats.bytesWritten += size;
+
+    if(persistent) return mapping + *offset;
+    // The fences already keep the range from being written while the GPU reads it
+    glBindBuffer(GL_COPY_WRITE_BUFFER, buffer);
+    mapping = (unsigned char *) glMapBufferRange(GL_COPY_WRITE_BUFFER, *offset, size,
+            GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT | GL_MAP_UNSYNCHRONIZED_BIT);
+    return mapping;
+}
+
+void StreamBuffer::unmap()
+{
+    if(persistent) return;
+    glUnmapBuffer(GL_COPY_WRITE_BUFFER);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+    mapping = nullptr;
+}
+
+size_t StreamBuffer::write(const void *data, size_t size, size_t alignment)
+{
+    size_t offset;
+    void *destination = map(size, alignment, &offset);
+    if(destination) memcpy(destination, data, size);
+    unmap();
+    return offset;
+}
+
+void StreamBuffer::endFrame()
+{
+    stats.frames++;
+    // A frame that wrote nothing leaves the region for the next
+    if(head > 0) advance();
+
+    if(!retired.empty())
+    {
+        glDeleteBuffers((int) retired.size(), retired.data());
+        retired.clear();
+    }
+}
+
+void StreamBuffer::advance()
+{
+    fences[region] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    region = (region + 1) % regions;
+    head = 0;
+    if(fences[region])
+    {
+        stats.regionsReused++;
+        wait(fences[region]);
+        fences[region] = nullptr;
+    }
+}
+
+void StreamBuffer::resize(size_t size)
+{
+    // Nothing in the old buffer is overwritten, but its fences are waited for so none are left for the new one
+    for(GLsync &fence : fences)
+    {
+        if(fence) wait(fence);
+        fence = nullptr;
+    }
+    if(persistent)
+    {
+        glBindBuffer(GL_COPY_WRITE_BUFFER, buffer);
+        glUnmapBuffer(GL_COPY_WRITE_BUFFER);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+    }
+    // Deleting the buffer would unbind it from wherever this frame's earlier writes are bound
+    retired.push_back(buffer);
+
+    while(regionSize < size) regionSize *= 2;
+    region = 0;
+    head = 0;
+    stats.resizes++;
+    create();
+    std::cout << "INFO::STREAM_BUFFER::RESIZED to " << regions << " regions of " << regionSize << " bytes" << std::endl;
+}
+
+void StreamBuffer::wait(GLsync fence)
+{
+    GLenum status = glClientWaitSync(fence, 0, 0);
+    if(status != GL_ALREADY_SIGNALED && status != GL_CONDITION_SATISFIED)
+    {
+        stats.stalls++;
+        auto start = std::chrono::steady_clock::now();
+        // Flushing makes sure the fence is sent to the GPU, otherwise it might never be signalled
+        do
+        {
+            status = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000000);
+        } while(status == GL_TIMEOUT_EXPIRED);
+        if(status == GL_WAIT_FAILED) std::cerr << "ERROR::STREAM_BUFFER::WAIT_FAILED" << std::endl;
+        stats.stallMilliseconds += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    }
+    glDeleteSync(fence);
+}
+
+unsigned int StreamBuffer::getBuffer() const
+{
+    return buffer;
+}
+
+bool StreamBuffer::isPersistent() const
+{
+    return persistent;
+}
+
+StreamBuffer::Stats StreamBuffer::getStats() const
+{
+    return stats;
+}
+
+void StreamBuffer::report() const
+{
+    std::cout << "INFO::STREAM_BUFFER " << (persistent ? "persistently mapped" : "mapped each write") << ", "
+              << regions << " regions of " << regionSize << " bytes: " << stats.bytesWritten << " bytes over "
+              << stats.frames << " frames, " << stats.stalls << " stalls in " << stats.regionsReused
+              << " region reuses waiting " << stats.stallMilliseconds << "ms, " << stats.resizes << " resizes"
+              << std::endl;
+}
@@ -0,0 +1,125 @@
+#ifndef OPENGLPROJECT_STREAMBUFFER_H
+#define OPENGLPROJECT_STREAMBUFFER_H
+
+#include <glad/glad.h>
+
+#include <vector>
+#include "Extensions.h"
+
+/**
+ * A ring buffer for data rewritten every frame, such as per-instance attributes and uniform blocks
+ *
+ * The buffer is split into regions, one per frame in flight. Writes go to the next free space of the current region,
+ * and each region is fenced when left, so it's only rewritten once the GPU has finished reading it. Where
+ * ARB_buffer_storage is supported the buffer is mapped once, persistently and coherently, otherwise each write maps
+ * its range unsynchronised, which the fences make safe. Either way the driver never has to orphan or wait on a buffer
+ */
+class StreamBuffer {
+public:
+    /**
+     * How often writing had to wait for the GPU
+     */
+    struct Stats {
+        long frames;
+        // Times a region was reused, whether at the end of a frame or because a frame filled its region
+        long regionsReused;
+        // Times a reused region was still being read, so writing waited for the GPU
+        long stalls;
+        double stallMilliseconds;
+        size_t bytesWritten;
+        // Times a write was larger than a region, so the buffer was replaced with a larger one
+        int resizes;
+    };
+
+    // Ring that per-frame data is streamed through, or nullptr for each user to orphan buffers of its own
+    static StreamBuffer *active;
+
+    /**
+     * Creates and maps the buffer
+     * @param regionSize Size of each region in bytes. Rounded up to a multiple of 256, the largest alignment required
+     * @param regions Number of frames that can be in flight
+     * @param persistent Whether to map the buffer persistently, which needs ARB_buffer_storage
+     */
+    explicit StreamBuffer(size_t regionSize, int regions = 3, bool persistent = Extensions::bufferStorage);
+    /**
+     * Deletes the buffer and fences
+     */
+    ~StreamBuffer();
+    StreamBuffer(const StreamBuffer &) = delete;
+    StreamBuffer &operator=(const StreamBuffer &) = delete;
+
+    /**
+     * Reserves space in the current region to write to. Must be followed by unmap before drawing
+     * @param size Size in bytes
+     * @param alignment Alignment of the offset in bytes, at most 256
+     * @param offset Location to store the offset of the space into the buffer
+     * @return Pointer to write the data to
+     */
+    void *map(size_t size, size_t alignment, size_t *offset);
+    /**
+     * Finishes writing the space from map
+     */
+    void unmap();
+    /**
+     * Copies data into the current region
+     * @param data Data to copy
+     * @param size Size in bytes
+     * @param alignment Alignment of the offset in bytes, at most 256
+     * @return Offset of the data into the buffer
+     */
+    size_t write(const void *data, size_t size, size_t alignment);
+    /**
+     * Fences the region written this frame, and moves to the next, waiting for the GPU to finish reading it if needed
+     */
+    void endFrame();
+
+    /**
+     * Gets the buffer to bind. It changes if a write is larger than a region, so must be got after each map or write
+     * @return Buffer ID
+     */
+    unsigned int getBuffer() const;
+    bool isPersistent() const;
+    Stats getStats() const;
+    /**
+     * Prints how the ring is mapped and how often it waited for the GPU
+     */
+    void report() const;
+
+private:
+    unsigned int buffer = 0;
+    // Whole buffer while persistently mapped, otherwise the range of the current map
+    unsigned char *mapping = nullptr;
+    size_t regionSize;
+    int regions;
+    bool persistent;
+    // Region being written, and the next free byte in it
+    int region = 0;
+    size_t head = 0;
+    // Fence of each region's last use, or nullptr if the GPU has nothing left to read from it
+    std::vector<GLsync> fences;
+    // Buffers replaced by a resize this frame, which draws may still have bound until it ends
+    std::vector<unsigned int> retired;
+    Stats stats{};
+
+    /**
+     * Creates the buffer, mapping it if persistent
+     */
+    void create();
+    /**
+     * Replaces the buffer with one whose regions are large enough for a write
+     * @param size Size of the write in bytes
+     */
+    void resize(size_t size);
+    /**
+     * Fences the current region and moves to the next
+     */
+    void advance();
+    /**
+     * Waits for the GPU to pass a fence, then deletes it
+     * @param fence Fence to wait for
+     */
+    void wait(GLsync fence);
+};
+
+
+#endif //OPENGLPROJECT_STREAMBUFFER_H
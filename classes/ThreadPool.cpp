@@ -0,0 +1,85 @@
+#include <algorithm>
+#include "ThreadPool.h"
+
+ThreadPool::ThreadPool(unsigned threads)
+{
+    // The calling thread is one of them
+    for(unsigned i = 1; i < std::max(threads, 1u); i++)
+    {
+        this->threads.emplace_back(&ThreadPool::wait, this);
+    }
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    started.notify_all();
+    for(std::thread &thread : threads)
+    {
+        thread.join();
+    }
+}
+
+unsigned ThreadPool::getThreadCount() const
+{
+    return (unsigned) threads.size() + 1;
+}
+
+void ThreadPool::run(size_t jobs, const std::function<void(size_t job)> &work)
+{
+    if(threads.empty() || jobs <= 1)
+    {
+        for(size_t job = 0; job < jobs; job++)
+        {
+            work(job);
+        }
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        this->work = &work;
+        this->jobs = jobs;
+        next = 0;
+        working = (unsigned) threads.size();
+        batch++;
+    }
+    started.notify_all();
+    take();
+
+    // The batch's state can't be reset until every thread has stopped taking jobs from it
+    std::unique_lock<std::mutex> lock(mutex);
+    finished.wait(lock, [this] { return working == 0; });
+    this->work = nullptr;
+}
+
+void ThreadPool::wait()
+{
+    size_t seen = 0;
+    while(true)
+    {
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            started.wait(lock, [this, seen] { return stopping || batch != seen; });
+            if(stopping) return;
+            seen = batch;
+        }
+        take();
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            working--;
+        }
+        finished.notify_one();
+    }
+}
+
+void ThreadPool::take()
+{
+    for(size_t job = next++; job < jobs; job = next++)
+    {
+        (*work)(job);
+    }
+}
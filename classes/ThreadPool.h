@@ -0,0 +1,71 @@
+#ifndef OPENGLPROJECT_THREADPOOL_H
+#define OPENGLPROJECT_THREADPOOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * A fixed set of threads splitting batches of independent jobs between them
+ *
+ * The thread calling run works through the batch alongside the others, so a pool of one thread starts none and runs
+ * every job in turn. Jobs are taken in order from a shared counter, so those that finish early take the next rather
+ * than waiting on a fixed share
+ */
+class ThreadPool {
+public:
+    /**
+     * Starts the threads, which sleep until given work
+     * @param threads Number of threads running each batch, including the one calling run. At least 1
+     */
+    explicit ThreadPool(unsigned threads = std::thread::hardware_concurrency());
+    /**
+     * Stops the threads once any batch in progress has finished
+     */
+    ~ThreadPool();
+    ThreadPool(const ThreadPool &) = delete;
+    ThreadPool &operator=(const ThreadPool &) = delete;
+
+    /**
+     * Gets the number of threads running each batch
+     * @return Number of threads, including the one calling run
+     */
+    unsigned getThreadCount() const;
+    /**
+     * Runs a batch of jobs, returning once every one has finished. Only one batch runs at a time
+     * @param jobs Number of jobs
+     * @param work Function to run each job, given its number from 0. Called from several threads at once
+     */
+    void run(size_t jobs, const std::function<void(size_t job)> &work);
+
+private:
+    std::vector<std::thread> threads;
+
+    // Guards the batch and wakes the threads for it
+    std::mutex mutex;
+    std::condition_variable started;
+    std::condition_variable finished;
+    // Counts the batches run, so a thread knows when there's a new one
+    size_t batch = 0;
+    bool stopping = false;
+    const std::function<void(size_t)> *work = nullptr;
+    size_t jobs = 0;
+    std::atomic<size_t> next{0};
+    // Number of threads still working on the batch
+    unsigned working = 0;
+
+    /**
+     * Waits for batches on one of the threads, working through each
+     */
+    void wait();
+    /**
+     * Runs jobs of the current batch until none are left
+     */
+    void take();
+};
+
+
+#endif //OPENGLPROJECT_THREADPOOL_H
@@ -0,0 +1,49 @@
+#include "UniformBuffer.h"
+#include "StreamBuffer.h"
+
+UniformBuffer::UniformBuffer(unsigned int binding, unsigned int size) : binding(binding), size(size)
+{
+    int offsetAlignment;
+    glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &offsetAlignment);
+    alignment = (unsigned int) offsetAlignment;
+
+    glGenBuffers(1, &UBO);
+    glBindBuffer(GL_UNIFORM_BUFFER, UBO);
+    // Allocates the memory now, the contents are uploaded every frame
+    glBufferData(GL_UNIFORM_BUFFER, size, nullptr, GL_DYNAMIC_DRAW);
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+
+    // Every program with a block bound to this point now reads from this buffer
+    glBindBufferBase(GL_UNIFORM_BUFFER, binding, UBO);
+}
+
+UniformBuffer::~UniformBuffer()
+{
+    glDeleteBuffers(1, &UBO);
+}
+
+void UniformBuffer::update(const void *data)
+{
+    if(StreamBuffer::active)
+    {
+        size_t offset = StreamBuffer::active->write(data, size, alignment);
+        glBindBufferRange(GL_UNIFORM_BUFFER, binding, StreamBuffer::active->getBuffer(), offset, size);
+        streamed = true;
+        return;
+    }
+    if(streamed)
+    {
+        glBindBufferBase(GL_UNIFORM_BUFFER, binding, UBO);
+        streamed = false;
+    }
+
+    glBindBuffer(GL_UNIFORM_BUFFER, UBO);
+    glBufferSubData(GL_UNIFORM_BUFFER, 0, size, data);
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+}
+
+int UniformBuffer::getBinding(const std::string &block)
+{
+    if(block == "Frame") return FRAME_BINDING;
+    return -1;
+}
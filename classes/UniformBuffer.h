@@ -0,0 +1,68 @@
+#ifndef OPENGLPROJECT_UNIFORMBUFFER_H
+#define OPENGLPROJECT_UNIFORMBUFFER_H
+
+#include <glad/glad.h>
+
+#include <string>
+#include <glm/glm.hpp>
+
+// Binding point of the Frame uniform block
+const unsigned int FRAME_BINDING = 0;
+
+/**
+ * Camera and light data shared by every shader, laid out to match the std140 Frame block
+ *
+ * vec3 values are stored as vec4 since std140 pads them to 16 bytes anyway
+ */
+struct FrameUniforms {
+    glm::mat4 view;
+    glm::mat4 projection;
+    glm::mat4 viewProjection;
+    glm::mat4 lightSpaceMatrix;
+    glm::vec4 viewPos;
+    glm::vec4 lightPos;
+    glm::vec4 lightColour;
+};
+
+/**
+ * A buffer backing a uniform block, bound to a fixed binding point so every program reads the same data
+ */
+class UniformBuffer {
+public:
+    /**
+     * Creates the buffer and binds it to the binding point
+     * @param binding Binding point to bind to
+     * @param size Size of the buffer in bytes
+     */
+    UniformBuffer(unsigned int binding, unsigned int size);
+    /**
+     * Deletes the buffer
+     */
+    ~UniformBuffer();
+
+    /**
+     * Replaces the contents of the buffer. While a StreamBuffer is active the data is written to it instead, and its
+     * range bound to the binding point, so draws still reading the previous contents never wait
+     * @param data Data to upload, the size of the buffer
+     */
+    void update(const void *data);
+
+    /**
+     * Finds the fixed binding point of a uniform block
+     * @param block Name of the uniform block
+     * @return Binding point, or -1 if the block has no fixed binding
+     */
+    static int getBinding(const std::string &block);
+
+private:
+    unsigned int UBO;
+    unsigned int binding;
+    unsigned int size;
+    // Alignment the driver requires of a range bound to a binding point
+    unsigned int alignment;
+    // Whether the binding point is bound to a StreamBuffer rather than UBO
+    bool streamed = false;
+};
+
+
+#endif //OPENGLPROJECT_UNIFORMBUFFER_H
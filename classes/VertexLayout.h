@@ -0,0 +1,36 @@
+#ifndef OPENGLPROJECT_VERTEXLAYOUT_H
+#define OPENGLPROJECT_VERTEXLAYOUT_H
+
+#include <glad/glad.h>
+
+#include <vector>
+
+/**
+ * One attribute of an interleaved vertex buffer
+ */
+struct VertexAttribute {
+    // Location the shader reads the attribute from
+    unsigned int location;
+    // Number of components, 1 to 4
+    int size;
+    // Type of each component in the buffer, such as GL_FLOAT
+    GLenum type;
+    // Offset from the start of the vertex in bytes
+    unsigned int offset;
+    // Whether integer data is normalised to [0, 1] or [-1, 1] when read as a float
+    bool normalized = false;
+    // Number of instances drawn before advancing to the next value, or 0 to advance every vertex
+    unsigned int divisor = 0;
+};
+
+/**
+ * Describes how a VAO reads its vertex buffer, so the shaders drawn with it can be checked against it
+ */
+struct VertexLayout {
+    // Size of a vertex in bytes
+    unsigned int stride;
+    std::vector<VertexAttribute> attributes;
+};
+
+
+#endif //OPENGLPROJECT_VERTEXLAYOUT_H
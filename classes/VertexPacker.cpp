@@ -0,0 +1,118 @@
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/packing.hpp>
+#include "VertexPacker.h"
+
+unsigned int VertexPacker::sizeOf(const PackedAttribute &attribute)
+{
+    unsigned int size;
+    switch(attribute.packing)
+    {
+        case VertexPacking::FLOAT: size = attribute.size * 4; break;
+        case VertexPacking::NORMALISED_INT_2_10_10_10: size = 4; break;
+        default: size = attribute.size * 2; break;
+    }
+    // Attributes not aligned to 4 bytes are slow to read on many GPUs
+    return (size + 3) & ~3u;
+}
+
+PackedVertices VertexPacker::pack(const Mesh &mesh, const std::vector<PackedAttribute> &format, const std::string &name)
+{
+    PackedVertices packed;
+    packed.layout.stride = 0;
+    for(const PackedAttribute &attribute : format)
+    {
+        VertexAttribute vertex{attribute.location, attribute.size, GL_FLOAT, packed.layout.stride};
+        switch(attribute.packing)
+        {
+            case VertexPacking::FLOAT: break;
+            case VertexPacking::HALF_FLOAT: vertex.type = GL_HALF_FLOAT; break;
+            case VertexPacking::NORMALISED_SHORT:
+            case VertexPacking::QUANTISED_SHORT: vertex.type = GL_SHORT; vertex.normalized = true; break;
+            case VertexPacking::NORMALISED_INT_2_10_10_10:
+                // Always read as 4 components, the shader ignoring w
+                vertex.type = GL_INT_2_10_10_10_REV; vertex.size = 4; vertex.normalized = true; break;
+        }
+        packed.layout.attributes.push_back(vertex);
+        packed.layout.stride += sizeOf(attribute);
+    }
+
+    size_t count = mesh.vertexCount();
+    packed.data.resize(count * packed.layout.stride);
+    for(size_t a = 0; a < format.size(); a++)
+    {
+        const PackedAttribute &attribute = format[a];
+        if(attribute.offset + attribute.size > mesh.floatsPerVertex)
+        {
+            std::cerr << "ERROR::MESH::PACKING::ATTRIBUTE_OUTSIDE_VERTEX at location " << attribute.location << std::endl;
+            continue;
+        }
+
+        // Positions are stored relative to the centre of their bounds, scaled so the largest axis spans [-1, 1].
+        // The scale is kept the same on every axis so the inverse transpose of the model matrix still keeps normals
+        // pointing the right way
+        glm::vec3 centre(0.0f);
+        float extent = 1.0f;
+        if(attribute.packing == VertexPacking::QUANTISED_SHORT)
+        {
+            glm::vec3 minimum(0.0f), maximum(0.0f);
+            for(size_t v = 0; v < count; v++)
+            {
+                for(int c = 0; c < attribute.size && c < 3; c++)
+                {
+                    float value = mesh.vertices[v * mesh.floatsPerVertex + attribute.offset + c];
+                    minimum[c] = v == 0 ? value : std::min(minimum[c], value);
+                    maximum[c] = v == 0 ? value : std::max(maximum[c], value);
+                }
+            }
+            centre = (minimum + maximum) * 0.5f;
+            glm::vec3 half = (maximum - minimum) * 0.5f;
+            extent = std::max(std::max(half.x, half.y), half.z);
+            if(extent == 0.0f) extent = 1.0f;
+            packed.dequantisation = glm::scale(glm::translate(glm::mat4(1.0f), centre), glm::vec3(extent));
+        }
+
+        for(size_t v = 0; v < count; v++)
+        {
+            const float *source = &mesh.vertices[v * mesh.floatsPerVertex + attribute.offset];
+            unsigned char *destination = &packed.data[v * packed.layout.stride + packed.layout.attributes[a].offset];
+            switch(attribute.packing)
+            {
+                case VertexPacking::FLOAT:
+                    memcpy(destination, source, attribute.size * sizeof(float));
+                    break;
+                case VertexPacking::HALF_FLOAT:
+                    for(int c = 0; c < attribute.size; c++)
+                    {
+                        uint16_t half = glm::packHalf1x16(source[c]);
+                        memcpy(destination + c * 2, &half, 2);
+                    }
+                    break;
+                case VertexPacking::NORMALISED_SHORT:
+                case VertexPacking::QUANTISED_SHORT:
+                    for(int c = 0; c < attribute.size; c++)
+                    {
+                        float value = c < 3 ? (source[c] - centre[c]) / extent : source[c];
+                        uint16_t quantised = glm::packSnorm1x16(value);
+                        memcpy(destination + c * 2, &quantised, 2);
+                    }
+                    break;
+                case VertexPacking::NORMALISED_INT_2_10_10_10:
+                {
+                    glm::vec4 vector(0.0f);
+                    for(int c = 0; c < attribute.size && c < 3; c++) vector[c] = source[c];
+                    // x in the lowest bits, as GL_INT_2_10_10_10_REV reads it
+                    uint32_t normal = glm::packSnorm3x10_1x2(vector);
+                    memcpy(destination, &normal, 4);
+                    break;
+                }
+            }
+        }
+    }
+
+    std::cout << "INFO::MESH::PACKED " << name << " " << mesh.floatsPerVertex * sizeof(float) << " to "
+              << packed.layout.stride << " bytes per vertex" << std::endl;
+    return packed;
+}
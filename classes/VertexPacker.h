@@ -0,0 +1,74 @@
+#ifndef OPENGLPROJECT_VERTEXPACKER_H
+#define OPENGLPROJECT_VERTEXPACKER_H
+
+#include <glm/glm.hpp>
+
+#include <string>
+#include <vector>
+#include "MeshBuilder.h"
+#include "VertexLayout.h"
+
+/**
+ * How an attribute is stored in the vertex buffer
+ */
+enum class VertexPacking {
+    // 4 bytes per component, as built
+    FLOAT,
+    // 2 bytes per component, for values near 1 such as texture coordinates
+    HALF_FLOAT,
+    // 2 bytes per component, for values within [-1, 1]
+    NORMALISED_SHORT,
+    // 3 components in 4 bytes as GL_INT_2_10_10_10_REV, for unit vectors such as normals
+    NORMALISED_INT_2_10_10_10,
+    // 2 bytes per component, mapped onto the bounds of the mesh and restored by the Model's dequantisation matrix.
+    // Only for positions
+    QUANTISED_SHORT
+};
+
+/**
+ * An attribute of a Mesh, and how to pack it
+ */
+struct PackedAttribute {
+    // Location the shader reads the attribute from
+    unsigned int location;
+    // Number of components
+    int size;
+    // Index of the attribute's first float in each vertex of the Mesh
+    int offset;
+    VertexPacking packing = VertexPacking::FLOAT;
+};
+
+/**
+ * Vertices of a Mesh in a packed format
+ */
+struct PackedVertices {
+    std::vector<unsigned char> data;
+    // How to read data
+    VertexLayout layout;
+    // Transforms positions read from data back to where they were built, for QUANTISED_SHORT positions
+    glm::mat4 dequantisation = glm::mat4(1.0f);
+};
+
+/**
+ * Encodes the vertices of a mesh into smaller formats when it is built, so less is read each time it's drawn
+ */
+class VertexPacker {
+public:
+    /**
+     * Packs every vertex of a mesh. Attributes are laid out in the order given, each aligned to 4 bytes
+     * @param mesh Mesh to pack
+     * @param format Attributes to keep and how to store each. Attributes of the mesh not listed are dropped
+     * @param name Name to print the reduction under
+     * @return Packed vertices
+     */
+    static PackedVertices pack(const Mesh &mesh, const std::vector<PackedAttribute> &format, const std::string &name);
+    /**
+     * Gets the size in bytes an attribute takes in each vertex, including padding to 4 bytes
+     * @param attribute Attribute to size
+     * @return Size in bytes
+     */
+    static unsigned int sizeOf(const PackedAttribute &attribute);
+};
+
+
+#endif //OPENGLPROJECT_VERTEXPACKER_H
@@ -2,10 +2,16 @@
 #include "src/include.cpp"
 
 #include "classes/Shader.h"
+#include "classes/ShaderCache.h"
+#include "classes/ShaderWatcher.h"
+#include "classes/ShaderProfiler.h"
+#include "classes/EmbeddedShaders.h"
+#include "classes/Extensions.h"
 #include "src/data.cpp"
 #include "src/preInit.cpp"
 #include "src/init.cpp"
 #include "src/frame.cpp"
+#include "src/benchmark.cpp"
 #include "classes/CubeModel.h"
 #include "classes/SquareModel.h"
 #include "classes/LightModel.h"
@@ -65,6 +71,7 @@ namespace core {
             std::cout << "Failed to initialize GLAD" << std::endl;
             throw initialisationException("Failed to initialize GLAD");
         }
+        Extensions::load((GLADloadproc) glfwGetProcAddress);
 
         Data.window = window;
     }
@@ -77,15 +84,32 @@ namespace core {
         glEnable(GL_STENCIL_TEST);
 
         // Program
+        ShaderCache::directory = Path.cache;
+        // Built in shaders are used unless working on them
+        if(!Data.diskShaders) ShaderPreprocessor::embedded = &EmbeddedShaders::load();
+        // Stages shared between shaders are only linked once, where the driver allows
+        Shader::separable = true;
+        // Samplers are pointed at these units when each program links
+        Shader::setTextureUnit("utexture", 0);
+        Shader::setTextureUnit("shadowMap", 1);
+        Shader::setTextureUnit("depthMap", 0);
         auto *shader3d = new Shader("vertexShader.vert", "fragmentShader.frag", Path.shaders);
         Data.shader3d = shader3d;
 
         auto *shader2d = new Shader("2dImage.vert", "2dImage.frag", Path.shaders);
         Data.shader2d = shader2d;
 
-        stbi_set_flip_vertically_on_load(true);
+        Data.frame = new UniformBuffer(FRAME_BINDING, sizeof(FrameUniforms));
+        // Per-instance attributes, draw commands and the Frame block are all streamed through one ring
+        Data.stream = new StreamBuffer(1 << 20);
+        StreamBuffer::active = Data.stream;
+
+        // The scene is submitted with one draw call per shader where the driver allows
+        DrawList::indirect = Extensions::multiDrawIndirect;
+        Data.drawList = new DrawList();
+        Data.drawList->setCuller(&Data.culler);
 
-        shader3d->use(); // Must activate shader3d to use uniforms
+        stbi_set_flip_vertically_on_load(true);
 
         // Creates the actual main viewport, and makes it adjust for window size changes
         glViewport(0, 0, Data.SCR_WIDTH, Data.SCR_HEIGHT);
@@ -112,7 +136,22 @@ namespace core {
 
     void close() {
         delete (Data.shader3d);
+        delete (Data.shader2d);
         delete (Data.camera);
+        delete (Data.frame);
+        delete (Data.drawList);
+        Data.stream->report();
+        Data.lods.report();
+        Data.culler.report();
+        StreamBuffer::active = nullptr;
+        delete (Data.stream);
+        for (Model *model : Data.models) {
+            delete model;
+        }
+        Data.models.clear();
+        GeometryArena::deleteAll();
+
+        Shader::reportUploads();
 
         glfwTerminate();
     }
@@ -120,13 +159,11 @@ namespace core {
     void drawScene(Shader* shader, Shader* lightShader, Shader* solidShader, Model* model, glm::vec3 lightPos, bool renderlight) {
         core::prerender(0.1, 0.1, 0.1);
 
-        model->bind();
-        lightShader->use();
-//        core::makeModel(*lightShader);
-        if(renderlight) model->draw(lightPos, *lightShader);
-
-        shader->use();
-//        core::makeModel(*shader);
+        DrawList &drawList = *Data.drawList;
+        if(renderlight) {
+            glm::mat4 lightMat = glm::translate(glm::mat4(1.0f), lightPos);
+            drawList.add(*lightShader, *model, Data.lods.select(*model, lightMat, Data.lightLevel), lightMat);
+        }
 
         // Creates the model matrix by translating by coordinates
         glm::mat4 modelMat = glm::mat4 {
@@ -135,17 +172,9 @@ namespace core {
                 0, 0, 1, 0,
                 0, 0, 0, 1
         };
-
-        int modelLoc = glGetUniformLocation(shader->ID, "model");
-
-        // Sets the relative shader3d uniform
-        glUniformMatrix4fv(modelLoc, 1, GL_TRUE, glm::value_ptr(modelMat));
-
-        // Draws the model
-        glDrawArrays(GL_TRIANGLES, 0, 36);
-
-        solidShader->use();
-//        core::makeModel(*solidShader);
+        // The shadow pass draws without the light, so only the camera pass counts the cube
+        drawList.add(*shader, *model, Data.lods.select(*model, glm::transpose(modelMat), Data.cubeLevel, renderlight),
+                glm::transpose(modelMat));
 
         modelMat = glm::mat4 {
                 1, 0, 0, 0,
@@ -163,22 +192,18 @@ namespace core {
                 0, 0, 1, 0,
                 0, 0, 0, 1
         };
+        drawList.add(*solidShader, *model, 6, glm::transpose(modelMat));
 
-        modelLoc = glGetUniformLocation(solidShader->ID, "model");
-
-        // Sets the relative shader3d uniform
-        glUniformMatrix4fv(modelLoc, 1, GL_TRUE, glm::value_ptr(modelMat));
-
-        // Draws the model
-        glDrawArrays(GL_TRIANGLES, 0, 6);
+        // Objects sharing a shader are drawn together, so the depth pass is one draw call
+        drawList.draw();
     }
 
-    void portalAtLoc(glm::vec3 position, Model* model, Shader coolShader) {
+    void portalAtLoc(glm::vec3 position, Model* model, const Shader &coolShader) {
         coolShader.use();
 
-        coolShader.setInt("alpha", 0);
+        coolShader.setInt("alpha"_u, 0);
         model->draw(position, coolShader);
-        coolShader.setInt("alpha", 1);
+        coolShader.setInt("alpha"_u, 1);
     }
 }
 
@@ -209,9 +234,20 @@ glm::vec3 multiply(glm::vec3 vector, int i) {
     else return vector + multiply(vector, i-1);
 }
 
-int main() {
+int main(int argc, char *argv[]) {
+    bool runBenchmark = false;
+    bool profile = false;
+    for(int i = 1; i < argc; i++) {
+        std::string argument = argv[i];
+        if(argument == "--benchmark") runBenchmark = true;
+        else if(argument == "--disk-shaders") core::Data.diskShaders = true;
+        else if(argument == "--profile") profile = true;
+    }
+
     core::preInit(1920, 1080, "Stuff");
     core::init(true);
+    // Closes the program once the shaders and models below have been destroyed, while OpenGL can still delete them
+    struct Closer { ~Closer() { core::close(); } } closer;
 
     unsigned int cardboard;
     core::generateTexture(&cardboard, std::string("container.jpg"), false);
@@ -219,32 +255,65 @@ int main() {
     LightModel light;
     SquareModel square;
 
-    Shader lightShader("light.vert", "light.frag", core::Path.shaders);
-    Shader simpleDepthShader("simpleDepthShader.vert", "simpleDepthShader.frag", core::Path.shaders);
+    // Shaders drawing the scene read their transforms the way the DrawList submits them
+    ShaderDefines drawDefines = DrawList::drawDefines();
+    ShaderDefines sceneDefines = core::shadowDefines();
+    sceneDefines.insert(drawDefines.begin(), drawDefines.end());
+
+    Shader lightShader("light.vert", "light.frag", core::Path.shaders, drawDefines);
+    Shader simpleDepthShader("simpleDepthShader.vert", "simpleDepthShader.frag", core::Path.shaders, drawDefines);
     Shader depthShader("depthShader.vert", "depthShader.frag", core::Path.shaders);
+    Shader solidShader("vertexShader.vert", "shaderSingleColour.frag", core::Path.shaders, sceneDefines);
 
-    Shader *shader = core::Data.shader3d;
+    // Only the permutation for the chosen shadow quality is ever compiled
+    Shader shader3d = core::Data.shader3d->variant(sceneDefines);
+    Shader *shader = &shader3d;
+
+    // Compiles everything together rather than waiting on each program in turn
+    Shader::buildAll({shader, &lightShader, &simpleDepthShader, &depthShader, &solidShader});
+    ShaderCache::report();
+    GeometryArena::report();
     Shader *shader2d = core::Data.shader2d;
     Model *model = core::Data.models.at(0);
 
+    // Checks each shader against the layout of the model it draws, so a mismatch is found before anything is drawn
+    shader->validate(model->getLayout(), "CubeModel");
+    solidShader.validate(model->getLayout(), "CubeModel");
+    lightShader.validate(model->getLayout(), "CubeModel");
+    simpleDepthShader.validate(model->getLayout(), "CubeModel");
+    depthShader.validate(square.getLayout(), "SquareModel");
+
     glm::vec3 lightColour(1.0f, 1.0f, 1.0f);
     glm::vec3 lightPos(1.0f, 1.5f, 2.0f);
 
     shader->use();
-    shader->setVec3("objectColour", 1.0f, 1.0f, 1.0f);
-    shader->setVec3("lightColour", lightColour);
-    shader->setVec3("lightPos", lightPos);
-    shader->setFloat("ambientStrength", 0.3f);
-    shader->setFloat("diffuseStrength", 1.0f);
-    shader->setFloat("specularStrength", 0.5f);
+    shader->setVec3("objectColour"_u, 1.0f, 1.0f, 1.0f);
+    shader->setFloat("ambientStrength"_u, 0.3f);
+    shader->setFloat("diffuseStrength"_u, 1.0f);
+    shader->setFloat("specularStrength"_u, 0.5f);
 
     lightShader.use();
-    lightShader.setVec3("colour", lightColour);
+    lightShader.setVec3("colour"_u, lightColour);
 
-    Shader solidShader("vertexShader.vert", "shaderSingleColour.frag", core::Path.shaders);
     solidShader.use();
-    solidShader.setInt("alpha", 1);
-    solidShader.setVec3("lightPos", lightPos);
+    solidShader.setInt("alpha"_u, 1);
+
+    if(runBenchmark) {
+        benchmark::uniformLookup("shader3d", *shader, 10000);
+        benchmark::uniformLookup("solidShader", solidShader, 10000);
+        benchmark::uniformLookup("lightShader", lightShader, 10000);
+        benchmark::shaderCompile();
+        benchmark::pipelineLink();
+        benchmark::vertexFormats(128, 20);
+        benchmark::instancing(10000, 20);
+        benchmark::multiDraw(10000, 20);
+        benchmark::streaming(200, 50, 100);
+        benchmark::levelsOfDetail(1000, 20);
+        benchmark::meshletCulling(400, 20);
+        benchmark::meshLoading(256, 512, 3);
+        benchmark::meshImport(512, 1024, 3);
+        return 0;
+    }
 
     unsigned int depthMapFBO;
     glGenFramebuffers(1, &depthMapFBO);
@@ -268,27 +337,31 @@ int main() {
 
 
 
-    // shader configuration
-    // --------------------
-    shader->use();
-    shader->setInt("diffuseTexture", 0);
-    shader->setInt("shadowMap", 1);
-    solidShader.use();
-    solidShader.setInt("diffuseTexture", 0);
-    solidShader.setInt("shadowMap", 1);
-    depthShader.use();
-    depthShader.setInt("depthMap", 0);
+    // Samplers were pointed at their texture units when the shaders were built
+
+    // Rebuilds shaders when their files are saved, so they can be tuned without restarting
+    std::unique_ptr<ShaderWatcher> watcher;
+    if(core::Data.diskShaders) watcher.reset(new ShaderWatcher(core::Path.shaders));
 
+    // Attributes the cost of each frame to the shaders drawing it
+    std::unique_ptr<ShaderProfiler> profiler;
+    if(profile) {
+        profiler.reset(new ShaderProfiler(core::Path.root + "profile.csv"));
+        ShaderProfiler::active = profiler.get();
+    }
+    float lastShown = glfwGetTime();
 
     while (!core::shouldClose()) {
         float currentFrame = glfwGetTime();
         float deltaTime = currentFrame - core::Data.lastFrame;
         core::Data.lastFrame = currentFrame;
 
-        core::processInput(deltaTime);
+        // Swaps in any shaders rebuilt since the last frame
+        if(watcher) watcher->update();
+        if(profiler) profiler->beginFrame();
 
-        shader->use();
-        shader->setVec3("viewPos", core::Data.camera->cameraPos);
+        core::processInput(deltaTime);
+        core::Data.lods.beginFrame(*core::Data.camera, core::Data.SCR_HEIGHT);
 
 //        core::drawScene(shader, &lightShader, &solidShader, model, lightPos);
 
@@ -301,17 +374,15 @@ int main() {
                                                 glm::vec3(0.0f, 1.0f, 0.0f));
         glm::mat4 lightSpaceMatrix = lightProjection * lightView;
 
-        simpleDepthShader.use();
-        int matLoc = glGetUniformLocation(simpleDepthShader.ID, "lightSpaceMatrix");
-
-        // Sets the relative shader3d uniform
-        glUniformMatrix4fv(matLoc, 1, GL_FALSE, glm::value_ptr(lightSpaceMatrix));
+        // Shared by every shader through the Frame uniform block
+        core::updateFrame(lightPos, lightColour, lightSpaceMatrix);
 
         // 1. first render to depth map
         glViewport(0, 0, SHADOW_WIDTH, SHADOW_HEIGHT);
         glBindFramebuffer(GL_FRAMEBUFFER, depthMapFBO);
         glClear(GL_DEPTH_BUFFER_BIT);
         glBindTexture(GL_TEXTURE_2D, cardboard);
+        core::Data.culler.setView(lightSpaceMatrix, lightPos);
         core::drawScene(&simpleDepthShader, &simpleDepthShader, &simpleDepthShader, model, lightPos, false);
         glBindFramebuffer(GL_FRAMEBUFFER, 0);
         // 2. then render scene as normal with shadow mapping (using depth map)
@@ -322,30 +393,34 @@ int main() {
         glActiveTexture(GL_TEXTURE1);
         glBindTexture(GL_TEXTURE_2D, depthMap);
 
-        shader->use();
-        matLoc = glGetUniformLocation(shader->ID, "lightSpaceMatrix");
-        glUniformMatrix4fv(matLoc, 1, GL_FALSE, glm::value_ptr(lightSpaceMatrix));
-
-        solidShader.use();
-        matLoc = glGetUniformLocation(solidShader.ID, "lightSpaceMatrix");
-        glUniformMatrix4fv(matLoc, 1, GL_FALSE, glm::value_ptr(lightSpaceMatrix));
-
-        core::makeModel(*shader);
-        core::makeModel(lightShader);
-        core::makeModel(solidShader);
+        core::Data.culler.setView(core::Data.camera->getPerspectiveTransformation()
+                * core::Data.camera->getTransformation(), core::Data.camera->cameraPos);
         core::drawScene(shader, &lightShader, &solidShader, model, lightPos, true);
 
         // render Depth map to quad for visual debugging
         // ---------------------------------------------
 //        depthShader.use();
-//        depthShader.setFloat("near_plane", near_plane);
-//        depthShader.setFloat("far_plane", far_plane);
+//        depthShader.setFloat("near_plane"_u, near_plane);
+//        depthShader.setFloat("far_plane"_u, far_plane);
 //        glActiveTexture(GL_TEXTURE0);
 //        glBindTexture(GL_TEXTURE_2D, depthMap);
 //        square.bind();
 //        square.draw(glm::vec2(0.0f), glm::vec2(core::Data.SCR_WIDTH, core::Data.SCR_HEIGHT), glm::vec2(core::Data.SCR_WIDTH, core::Data.SCR_HEIGHT), depthShader);
 
 
+        if(profiler) {
+            profiler->endFrame();
+            // The most expensive programs are shown in the title once a second
+            if(currentFrame - lastShown >= 1.0f) {
+                glfwSetWindowTitle(core::Data.window, core::profileTitle(profiler->getFrame(), 3).c_str());
+                lastShown = currentFrame;
+            }
+        }
+
+        // Fences the data streamed this frame, so it isn't overwritten until drawn
+        core::Data.stream->endFrame();
+        core::Data.lods.endFrame();
+
         core::glCheckError();
         glfwPollEvents();
         glfwSwapBuffers(core::Data.window);
@@ -373,6 +448,6 @@ int main() {
             core::Data.camera->moveOnPlane(BACKWARD, Z, deltaTime);
         }
     }
-    core::close();
+    if(profiler) profiler->report();
 }
 
@@ -3,6 +3,8 @@ out vec4 FragColor;
 
 in vec2 TexCoords;
 
+#include "frame.glsl"
+
 uniform sampler2D utexture;
 
 void main()
@@ -5,6 +5,8 @@ layout (location = 1) in vec2 aTexCoords;
 out vec2 TexCoords;
 out vec4 p;
 
+#include "frame.glsl"
+
 uniform vec2 position;
 uniform vec2 screen;
 uniform vec2 size;
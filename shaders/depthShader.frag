@@ -3,6 +3,8 @@ out vec4 FragColor;
 
 in vec2 TexCoords;
 
+#include "frame.glsl"
+
 uniform sampler2D depthMap;
 uniform float near_plane;
 uniform float far_plane;
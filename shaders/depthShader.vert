@@ -4,6 +4,8 @@ layout (location = 1) in vec2 aTexCoords;
 
 out vec2 TexCoords;
 
+#include "frame.glsl"
+
 void main()
 {
     TexCoords = aTexCoords;
@@ -0,0 +1,10 @@
+// Camera and light data shared by every shader, updated once per frame (see FrameUniforms)
+layout (std140) uniform Frame {
+    mat4 view;
+    mat4 projection;
+    mat4 viewProjection;
+    mat4 lightSpaceMatrix;
+    vec4 viewPos;
+    vec4 lightPos;
+    vec4 lightColour;
+};
\ No newline at end of file
@@ -1,6 +1,8 @@
 #version 330 core
 out vec4 FragColor;
 
+#include "frame.glsl"
+
 uniform vec3 colour;
 
 void main()
@@ -0,0 +1,41 @@
+// Shadow map rendered from the light's point of view
+uniform sampler2D shadowMap;
+
+// Radius of the PCF kernel, set per shadow quality tier. 0 turns shadows off
+#ifndef PCF_RADIUS
+#define PCF_RADIUS 5
+#endif
+
+float findShadow(vec4 fragPosLightSpace) {
+#if PCF_RADIUS == 0
+    return 0.0;
+#else
+    // perform perspective divide
+    vec3 projCoords = fragPosLightSpace.xyz / fragPosLightSpace.w;
+    // transform [-1, 1] to [0, 1]
+    projCoords = projCoords * 0.5 + 0.5;
+    // get closest depth value from light's perspective (using [0,1] range fragPosLight as coords)
+    float closestDepth = texture(shadowMap, projCoords.xy).r;
+    // get depth of current fragment from light's perspective
+    float currentDepth = projCoords.z;
+
+    float bias = 0.01;
+    // check whether current frag pos is in shadow
+    float shadow = 0.0;
+    vec2 texelSize = 1.0 / textureSize(shadowMap, 0);
+    for(int x = -PCF_RADIUS; x <= PCF_RADIUS; ++x)
+    {
+        for(int y = -PCF_RADIUS; y <= PCF_RADIUS; ++y)
+        {
+            float pcfDepth = texture(shadowMap, projCoords.xy + vec2(x, y) * texelSize).r;
+            shadow += currentDepth - bias > pcfDepth ? 1.0 : 0.0;
+        }
+    }
+    shadow /= float((2 * PCF_RADIUS + 1) * (2 * PCF_RADIUS + 1));
+
+    if(projCoords.z > 1.0)
+        shadow = 0.0;
+
+    return shadow;
+#endif
+}
\ No newline at end of file
@@ -1,5 +1,7 @@
 #version 330 core
 
+#include "frame.glsl"
+
 void main()
 {
     // gl_FragDepth = gl_FragCoord.z;
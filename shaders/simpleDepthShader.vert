@@ -1,10 +1,19 @@
 #version 330 core
 layout (location = 0) in vec3 aPos;
 
-uniform mat4 lightSpaceMatrix;
+#include "frame.glsl"
+
+#ifdef INSTANCED
+// Per instance, from Model::drawInstanced
+layout (location = 3) in mat4 instanceModel;
+#else
 uniform mat4 model;
+#endif
 
 void main()
 {
+#ifdef INSTANCED
+    mat4 model = instanceModel;
+#endif
     gl_Position = lightSpaceMatrix * model * vec4(aPos, 1.0);
 }
\ No newline at end of file
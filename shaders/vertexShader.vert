@@ -9,18 +9,27 @@ out vec3 LightPos;
 out vec2 TexCoords;
 out vec4 FragPosLightSpace;
 
+#include "frame.glsl"
+
+#ifdef INSTANCED
+// Per instance, from Model::drawInstanced
+layout (location = 3) in mat4 instanceModel;
+layout (location = 7) in vec4 instanceColour;
+out vec4 InstanceColour;
+#else
 uniform mat4 model;
-uniform mat4 view;
-uniform mat4 projection;
-uniform vec3 lightPos;
-uniform mat4 lightSpaceMatrix;
+#endif
 
 void main()
 {
-    gl_Position = projection * view * model * vec4(aPos, 1.0);
+#ifdef INSTANCED
+    mat4 model = instanceModel;
+    InstanceColour = instanceColour;
+#endif
+    gl_Position = viewProjection * model * vec4(aPos, 1.0);
     Normal = mat3(transpose(inverse(model))) * aNormal;
     FragPos = vec3(model * vec4(aPos, 1.0f));
-    LightPos = vec4(lightPos, 1.0f).xyz;
+    LightPos = lightPos.xyz;
     TexCoords = aTexCoords;
     FragPosLightSpace = lightSpaceMatrix * vec4(FragPos, 1.0);
 }
\ No newline at end of file
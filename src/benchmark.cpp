@@ -0,0 +1,860 @@
+#pragma once
+#include "data.cpp"
+#include "../classes/ShaderCache.h"
+#include "../classes/Extensions.h"
+#include "../classes/CubeModel.h"
+#include "../classes/LightModel.h"
+#include "../classes/DrawList.h"
+#include "../classes/StreamBuffer.h"
+#include "../classes/LodSelector.h"
+#include "../classes/MeshletCuller.h"
+#include "../classes/MeshFile.h"
+#include "../classes/ObjLoader.h"
+#include "../classes/GltfLoader.h"
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+
+/**
+ * Micro-benchmarks, run instead of the main loop when started with --benchmark
+ */
+
+namespace benchmark {
+
+    /**
+     * Compares the per-frame cost of finding every uniform of a shader by querying OpenGL, by name in the uniform
+     * table built after linking, and by a precomputed UniformId as "name"_u literals are
+     * @param name Name to print the results under
+     * @param shader Shader to look the uniforms up in
+     * @param frames Number of frames to simulate
+     */
+    void uniformLookup(const std::string &name, const Shader &shader, int frames);
+    /**
+     * Compares the wall-clock time of building every program in shaders/ one at a time, waiting on each, against
+     * submitting them all as one batch. The binary cache is bypassed so both really compile
+     */
+    void shaderCompile();
+    /**
+     * Compares the cumulative time to build a growing set of vertex and fragment shader combinations as whole
+     * programs, where each combination is linked, against pipelines of separable stages, where each stage is linked
+     * once however many combinations use it. The binary cache is bypassed so both really link
+     */
+    void pipelineLink();
+    /**
+     * Compares the bytes per vertex and vertex throughput of a grid of cubes stored as floats, as CubeModel was,
+     * against the packed format CubeModel now uses, drawn with the shadow pass's shader into a depth buffer
+     * @param cubes Number of cubes along each side of the grid
+     * @param draws Number of times to draw each format
+     */
+    void vertexFormats(int cubes, int draws);
+    /**
+     * Compares drawing many cubes with a draw call each, setting the model matrix every time, against one
+     * instanced draw, with the shadow pass's shader into a depth buffer
+     * @param cubes Number of cubes
+     * @param frames Number of frames to draw them over
+     */
+    void instancing(int cubes, int frames);
+    /**
+     * Compares submitting a scene of cubes and lights, each model its own vertex format, through a DrawList drawing
+     * each object with glDrawElementsBaseVertex against one drawing each format with glMultiDrawElementsIndirect,
+     * with the shadow pass's shader into a depth buffer. Skipped if the driver can't draw indirectly
+     * @param objects Number of objects
+     * @param frames Number of frames to draw them over
+     */
+    void multiDraw(int objects, int frames);
+    /**
+     * Compares uploading the per-instance attributes of many small instanced draws each frame by orphaning a buffer,
+     * against writing them through a StreamBuffer mapped each write, and one persistently mapped where supported,
+     * with the shadow pass's shader into a depth buffer
+     * @param draws Number of instanced draws each frame
+     * @param instances Number of cubes in each draw
+     * @param frames Number of frames to draw
+     */
+    void streaming(int draws, int instances, int frames);
+    /**
+     * Compares drawing a field of detailed spheres receding from the camera in full, against at the levels of detail
+     * a LodSelector picks for them, through a DrawList with the shadow pass's shader into a depth buffer
+     * @param objects Number of spheres
+     * @param frames Number of frames to draw them over
+     */
+    void levelsOfDetail(int objects, int frames);
+    /**
+     * Compares drawing a field of dense spheres around the camera whole, against culling their meshlets first, through
+     * a DrawList with the shadow pass's shader into a depth buffer, and measures the cost of culling
+     * @param objects Number of spheres
+     * @param frames Number of frames to draw them over
+     */
+    void meshletCulling(int objects, int frames);
+    /**
+     * Compares loading a dense sphere by parsing it from an OBJ file and packing it, against mapping it from a mesh
+     * file and uploading it as it is. Both files are written first, so they're read from the page cache rather than
+     * the disk
+     * @param rings Number of rings of triangles from pole to pole
+     * @param segments Number of triangles around each ring
+     * @param loads Number of times to load each file
+     */
+    void meshLoading(int rings, int segments, int loads);
+    /**
+     * Measures how fast a dense sphere is imported from an OBJ file and from a binary glTF file, on a ThreadPool of
+     * each power of two threads up to every core. Both files are written first, so they're read from the page cache
+     * @param rings Number of rings of triangles from pole to pole
+     * @param segments Number of triangles around each ring
+     * @param loads Number of times to load each file on each pool, keeping the fastest
+     */
+    void meshImport(int rings, int segments, int loads);
+    /**
+     * Builds a closed unit sphere of positions and normals, whose seam and poles weld away so it can be simplified
+     * @param rings Number of rings of triangles from pole to pole
+     * @param segments Number of triangles around each ring
+     * @return Welded sphere
+     */
+    Mesh sphereMesh(int rings, int segments);
+    /**
+     * Writes a mesh of positions and normals as an OBJ file, with texture coordinates taken from the positions so
+     * every attribute is written and read
+     * @param path Path of the file to write
+     * @param mesh Mesh of 6 floats per vertex
+     * @return True if the file was written
+     */
+    bool writeObj(const std::string &path, const Mesh &mesh);
+    /**
+     * Writes a mesh of positions and normals as a binary glTF file of one node, with texture coordinates taken from
+     * the positions as writeObj's are
+     * @param path Path of the file to write
+     * @param mesh Mesh of 6 floats per vertex
+     * @return True if the file was written
+     */
+    bool writeGlb(const std::string &path, const Mesh &mesh);
+    /**
+     * Creates a depth only framebuffer to draw into, and binds it with a matching viewport
+     * @param size Width and height in pixels
+     * @param texture Location to store the depth texture
+     * @return Framebuffer ID
+     */
+    unsigned int bindDepthTarget(int size, unsigned int *texture);
+    /**
+     * Deletes a framebuffer from bindDepthTarget, restoring the window's framebuffer and viewport
+     * @param framebuffer Framebuffer ID
+     * @param texture Depth texture
+     */
+    void deleteDepthTarget(unsigned int framebuffer, unsigned int texture);
+
+    /**
+     * A Model drawing a Mesh built by a benchmark
+     */
+    class BenchmarkModel : public Model {
+    public:
+        BenchmarkModel(const Mesh &mesh, const VertexLayout &layout) : Model(mesh, layout) {}
+        BenchmarkModel(const Mesh &mesh, const std::vector<PackedAttribute> &format, const std::string &name)
+                : Model(mesh, format, name) {}
+        void draw(glm::vec3 position, const Shader &shader) {}
+        void draw(glm::vec2 position, glm::vec2 screen, glm::vec2 size, const Shader &shader) {}
+        explicit BenchmarkModel(const MeshFile &file) : Model(file) {}
+        void drawS(glm::vec3 position, const Shader &shader, float size) {}
+    };
+
+    void uniformLookup(const std::string &name, const Shader &shader, int frames) {
+        const std::vector<Uniform> &uniforms = shader.getUniforms();
+        // Stops the compiler optimising the lookups away
+        volatile int sink = 0;
+
+        auto start = std::chrono::steady_clock::now();
+        for (int frame = 0; frame < frames; frame++) {
+            for (const Uniform &uniform : uniforms) {
+                // Uniforms of a pipeline belong to one of its stage programs
+                sink = sink + glGetUniformLocation(uniform.program ? uniform.program : shader.getID(), uniform.name.c_str());
+            }
+        }
+        auto queried = std::chrono::steady_clock::now();
+        for (int frame = 0; frame < frames; frame++) {
+            for (const Uniform &uniform : uniforms) {
+                sink = sink + shader.getLocation(uniform.name);
+            }
+        }
+        auto cached = std::chrono::steady_clock::now();
+        std::vector<UniformId> ids;
+        for (const Uniform &uniform : uniforms) {
+            ids.emplace_back(uniform.hash);
+        }
+        auto hashStart = std::chrono::steady_clock::now();
+        for (int frame = 0; frame < frames; frame++) {
+            for (UniformId id : ids) {
+                sink = sink + shader.getLocation(id);
+            }
+        }
+        auto hashed = std::chrono::steady_clock::now();
+
+        double before = std::chrono::duration<double, std::nano>(queried - start).count() / frames;
+        double after = std::chrono::duration<double, std::nano>(cached - queried).count() / frames;
+        double afterHashed = std::chrono::duration<double, std::nano>(hashed - hashStart).count() / frames;
+        std::cout << "BENCHMARK::UNIFORM_LOOKUP " << name << " (" << uniforms.size() << " uniforms): "
+                  << before << "ns/frame with glGetUniformLocation, "
+                  << after << "ns/frame by name in the uniform table, "
+                  << afterHashed << "ns/frame by UniformId" << std::endl;
+    }
+
+    void shaderCompile() {
+        const std::vector<std::pair<std::string, std::string>> sources = {
+                {"vertexShader.vert", "fragmentShader.frag"},
+                {"vertexShader.vert", "shaderSingleColour.frag"},
+                {"2dImage.vert", "2dImage.frag"},
+                {"light.vert", "light.frag"},
+                {"simpleDepthShader.vert", "simpleDepthShader.frag"},
+                {"depthShader.vert", "depthShader.frag"}
+        };
+        std::string cache = ShaderCache::directory;
+        ShaderCache::directory = "";
+
+        // A define unique to each run gives new sources, so nothing is shared with programs already built
+        std::vector<Shader> serial;
+        for (const auto &pair : sources) {
+            serial.emplace_back(pair.first, pair.second, core::Path.shaders, ShaderDefines{{"BENCHMARK_RUN", "1"}});
+        }
+        auto start = std::chrono::steady_clock::now();
+        for (const Shader &shader : serial) {
+            shader.getID();
+        }
+        double serialMilliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+        std::vector<Shader> batch;
+        std::vector<const Shader *> pointers;
+        for (const auto &pair : sources) {
+            batch.emplace_back(pair.first, pair.second, core::Path.shaders, ShaderDefines{{"BENCHMARK_RUN", "2"}});
+        }
+        for (const Shader &shader : batch) {
+            pointers.push_back(&shader);
+        }
+        double batchMilliseconds = Shader::buildAll(pointers);
+
+        ShaderCache::directory = cache;
+        std::cout << "BENCHMARK::SHADER_COMPILE " << sources.size() << " programs: " << serialMilliseconds
+                  << "ms one at a time, " << batchMilliseconds << "ms as a batch ("
+                  << (const char *) glGetString(GL_RENDERER) << ")" << std::endl;
+    }
+
+    void pipelineLink() {
+        if(!Extensions::separateShaderObjects) {
+            std::cout << "BENCHMARK::PIPELINE_LINK skipped, separate shader objects aren't supported" << std::endl;
+            return;
+        }
+        // Every pairing whose stage interfaces match
+        const std::vector<std::pair<std::string, std::string>> combinations = {
+                {"vertexShader.vert", "fragmentShader.frag"},
+                {"vertexShader.vert", "shaderSingleColour.frag"},
+                {"vertexShader.vert", "light.frag"},
+                {"vertexShader.vert", "simpleDepthShader.frag"},
+                {"light.vert", "light.frag"},
+                {"light.vert", "simpleDepthShader.frag"},
+                {"simpleDepthShader.vert", "light.frag"},
+                {"simpleDepthShader.vert", "simpleDepthShader.frag"},
+                {"2dImage.vert", "2dImage.frag"},
+                {"2dImage.vert", "depthShader.frag"},
+                {"depthShader.vert", "2dImage.frag"},
+                {"depthShader.vert", "depthShader.frag"}
+        };
+        std::string cache = ShaderCache::directory;
+        ShaderCache::directory = "";
+        bool separable = Shader::separable;
+
+        // The first program built pays the driver's one-off start up costs, so isn't timed
+        Shader warmUp("light.vert", "light.frag", core::Path.shaders, ShaderDefines{{"BENCHMARK_RUN", "warm up"}});
+        warmUp.getID();
+
+        // Cumulative milliseconds after each combination, as whole programs then as pipelines
+        std::vector<double> milliseconds[2];
+        for(int mode = 0; mode < 2; mode++) {
+            Shader::separable = mode == 1;
+            std::vector<Shader> shaders;
+            for(const auto &pair : combinations) {
+                // A define unique to each mode gives new sources, so nothing is shared with programs already built
+                shaders.emplace_back(pair.first, pair.second, core::Path.shaders,
+                        ShaderDefines{{"BENCHMARK_RUN", std::to_string(3 + mode)}});
+            }
+            double total = 0;
+            for(const Shader &shader : shaders) {
+                auto start = std::chrono::steady_clock::now();
+                shader.getID();
+                total += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+                milliseconds[mode].push_back(total);
+            }
+        }
+
+        Shader::separable = separable;
+        ShaderCache::directory = cache;
+        for(size_t i = 0; i < combinations.size(); i++) {
+            std::cout << "BENCHMARK::PIPELINE_LINK " << i + 1 << " combinations: " << milliseconds[0][i]
+                      << "ms as programs, " << milliseconds[1][i] << "ms as pipelines" << std::endl;
+        }
+    }
+
+    void vertexFormats(int cubes, int draws) {
+        // Many small cubes, so the time is spent reading and transforming vertices rather than filling pixels
+        MeshBuilder builder(8);
+        float spacing = 2.0f / cubes;
+        for (int x = 0; x < cubes; x++) {
+            for (int y = 0; y < cubes; y++) {
+                glm::vec3 offset(-1.0f + (x + 0.5f) * spacing, -1.0f + (y + 0.5f) * spacing, 0.0f);
+                for (size_t i = 0; i < sizeof(vertices) / sizeof(float); i += 8) {
+                    float vertex[8];
+                    std::copy(vertices + i, vertices + i + 8, vertex);
+                    for (int c = 0; c < 3; c++) vertex[c] = vertex[c] * spacing * 0.5f + offset[c];
+                    builder.add(vertex);
+                }
+            }
+        }
+        const Mesh &mesh = builder.getMesh();
+        BenchmarkModel floats(mesh, VertexLayout{8 * sizeof(float), {
+                {0, 3, GL_FLOAT, 0},
+                {1, 3, GL_FLOAT, 3 * sizeof(float)},
+                {2, 2, GL_FLOAT, 6 * sizeof(float)}
+        }});
+        BenchmarkModel packed(mesh, {
+                {0, 3, 0, VertexPacking::QUANTISED_SHORT},
+                {1, 3, 3, VertexPacking::NORMALISED_INT_2_10_10_10},
+                {2, 2, 6, VertexPacking::HALF_FLOAT}
+        }, "benchmark");
+        BenchmarkModel *models[2] = {&floats, &packed};
+
+        unsigned int depth;
+        unsigned int framebuffer = bindDepthTarget(1024, &depth);
+
+        // The grid already fills clip space
+        FrameUniforms frame{};
+        frame.lightSpaceMatrix = glm::mat4(1.0f);
+        core::Data.frame->update(&frame);
+        Shader depthShader("simpleDepthShader.vert", "simpleDepthShader.frag", core::Path.shaders);
+        depthShader.use();
+
+        // Formats take turns so neither is favoured by the driver warming up
+        double milliseconds[2] = {0, 0};
+        for (int draw = -1; draw < draws; draw++) {
+            for (int format = 0; format < 2; format++) {
+                models[format]->bind();
+                depthShader.setMat4("model"_u, models[format]->getDequantisation());
+                glClear(GL_DEPTH_BUFFER_BIT);
+                glFinish();
+                auto start = std::chrono::steady_clock::now();
+                models[format]->drawMesh((int) mesh.indices.size());
+                glFinish();
+                // The first round isn't timed
+                if (draw >= 0) {
+                    milliseconds[format] += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+                }
+            }
+        }
+
+        deleteDepthTarget(framebuffer, depth);
+
+        const char *names[2] = {"floats", "packed"};
+        for (int format = 0; format < 2; format++) {
+            double perDraw = milliseconds[format] / draws;
+            std::cout << "BENCHMARK::VERTEX_FORMAT " << names[format] << ": "
+                      << models[format]->getLayout().stride << " bytes per vertex, "
+                      << mesh.vertexCount() * models[format]->getLayout().stride / 1024 << "KB, "
+                      << perDraw << "ms per draw, " << mesh.indices.size() / perDraw / 1000 << "M vertices/s" << std::endl;
+        }
+    }
+
+    void instancing(int cubes, int frames) {
+        CubeModel cube;
+        std::vector<glm::mat4> transforms;
+        std::vector<glm::vec3> positions;
+        int side = (int) std::ceil(std::sqrt((double) cubes));
+        for (int i = 0; i < cubes; i++) {
+            glm::vec3 position(i % side - (side - 1) * 0.5f, i / side - (side - 1) * 0.5f, 0.0f);
+            positions.push_back(position);
+            transforms.push_back(glm::translate(glm::mat4(1.0f), position));
+        }
+
+        unsigned int depth;
+        unsigned int framebuffer = bindDepthTarget(1024, &depth);
+        FrameUniforms frame{};
+        // Fits the grid of touching cubes to clip space
+        frame.lightSpaceMatrix = glm::scale(glm::mat4(1.0f), glm::vec3(2.0f / side));
+        core::Data.frame->update(&frame);
+        Shader separate("simpleDepthShader.vert", "simpleDepthShader.frag", core::Path.shaders);
+        Shader instanced = separate.variant({{"INSTANCED", "1"}});
+        Shader::buildAll({&separate, &instanced});
+
+        // Cumulative milliseconds, drawing a cube at a time then all at once. The first frame isn't timed
+        double milliseconds[2] = {0, 0};
+        for (int f = -1; f < frames; f++) {
+            glClear(GL_DEPTH_BUFFER_BIT);
+            glFinish();
+            auto start = std::chrono::steady_clock::now();
+            separate.use();
+            cube.bind();
+            for (const glm::vec3 &position : positions) {
+                cube.draw(position, separate);
+            }
+            glFinish();
+            auto drawn = std::chrono::steady_clock::now();
+            glClear(GL_DEPTH_BUFFER_BIT);
+            glFinish();
+            auto instancedStart = std::chrono::steady_clock::now();
+            instanced.use();
+            cube.drawInstanced(36, transforms.data(), transforms.size());
+            glFinish();
+            auto instancedDrawn = std::chrono::steady_clock::now();
+            if (f >= 0) {
+                milliseconds[0] += std::chrono::duration<double, std::milli>(drawn - start).count();
+                milliseconds[1] += std::chrono::duration<double, std::milli>(instancedDrawn - instancedStart).count();
+            }
+        }
+        deleteDepthTarget(framebuffer, depth);
+
+        std::cout << "BENCHMARK::INSTANCING " << cubes << " cubes: " << milliseconds[0] / frames
+                  << "ms/frame with a draw call each, " << milliseconds[1] / frames
+                  << "ms/frame with one instanced draw" << std::endl;
+    }
+
+    void multiDraw(int objects, int frames) {
+        if (!Extensions::multiDrawIndirect) {
+            std::cout << "BENCHMARK::MULTI_DRAW skipped, multi draw indirect isn't supported" << std::endl;
+            return;
+        }
+        CubeModel cube;
+        LightModel light;
+        std::vector<glm::mat4> transforms;
+        int side = (int) std::ceil(std::sqrt((double) objects));
+        for (int i = 0; i < objects; i++) {
+            glm::vec3 position(i % side - (side - 1) * 0.5f, i / side - (side - 1) * 0.5f, 0.0f);
+            transforms.push_back(glm::translate(glm::mat4(1.0f), position));
+        }
+
+        unsigned int depth;
+        unsigned int framebuffer = bindDepthTarget(1024, &depth);
+        FrameUniforms frame{};
+        frame.lightSpaceMatrix = glm::scale(glm::mat4(1.0f), glm::vec3(2.0f / side));
+        core::Data.frame->update(&frame);
+        Shader looped("simpleDepthShader.vert", "simpleDepthShader.frag", core::Path.shaders, DrawList::drawDefines(false));
+        Shader indirect = looped.variant(DrawList::drawDefines(true));
+        Shader::buildAll({&looped, &indirect});
+
+        // Cumulative milliseconds, including building the list, drawing an object at a time then a format at a time.
+        // The first frame isn't timed
+        DrawList lists[2] = {DrawList(false), DrawList(true)};
+        const Shader *shaders[2] = {&looped, &indirect};
+        double milliseconds[2] = {0, 0};
+        for (int f = -1; f < frames; f++) {
+            for (int list = 0; list < 2; list++) {
+                glClear(GL_DEPTH_BUFFER_BIT);
+                glFinish();
+                auto start = std::chrono::steady_clock::now();
+                for (int i = 0; i < objects; i++) {
+                    const Model &model = i % 2 ? (const Model &) light : cube;
+                    lists[list].add(*shaders[list], model, 36, transforms[i]);
+                }
+                lists[list].draw();
+                glFinish();
+                if (f >= 0) {
+                    milliseconds[list] += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+                }
+            }
+        }
+        deleteDepthTarget(framebuffer, depth);
+
+        std::cout << "BENCHMARK::MULTI_DRAW " << objects << " objects: " << milliseconds[0] / frames
+                  << "ms/frame with a draw call each, " << milliseconds[1] / frames
+                  << "ms/frame with a multi draw indirect call per format" << std::endl;
+    }
+
+    void streaming(int draws, int instances, int frames) {
+        CubeModel cube;
+        std::vector<glm::mat4> transforms;
+        for (int i = 0; i < draws * instances; i++) {
+            transforms.push_back(glm::translate(glm::mat4(1.0f), glm::vec3(i % 32 - 15.5f, i / 32 % 32 - 15.5f, 0.0f)));
+        }
+
+        unsigned int depth;
+        unsigned int framebuffer = bindDepthTarget(1024, &depth);
+        Shader instanced("simpleDepthShader.vert", "simpleDepthShader.frag", core::Path.shaders, {{"INSTANCED", "1"}});
+        Shader::buildAll({&instanced});
+        instanced.use();
+
+        // The ring in use is restored once done
+        StreamBuffer *previous = StreamBuffer::active;
+        const char *names[3] = {"orphaning", "mapping each write", "persistently mapped"};
+        for (int method = 0; method < 3; method++) {
+            if (method == 2 && !Extensions::bufferStorage) break;
+            std::unique_ptr<StreamBuffer> stream;
+            if (method > 0) stream.reset(new StreamBuffer(transforms.size() * sizeof(glm::mat4), 3, method == 2));
+            StreamBuffer::active = stream.get();
+
+            // Every frame is timed, as the waits on the GPU are what's being measured
+            FrameUniforms frame{};
+            frame.lightSpaceMatrix = glm::scale(glm::mat4(1.0f), glm::vec3(1.0f / 16));
+            glFinish();
+            auto start = std::chrono::steady_clock::now();
+            for (int f = 0; f < frames; f++) {
+                core::Data.frame->update(&frame);
+                glClear(GL_DEPTH_BUFFER_BIT);
+                for (int d = 0; d < draws; d++) {
+                    cube.drawInstanced(36, transforms.data() + d * instances, instances);
+                }
+                if (stream) stream->endFrame();
+            }
+            glFinish();
+            double milliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+            std::cout << "BENCHMARK::STREAMING " << draws << " draws of " << instances << " instances, "
+                      << names[method] << ": " << milliseconds / frames << "ms/frame";
+            if (stream) {
+                StreamBuffer::Stats stats = stream->getStats();
+                std::cout << ", " << stats.stalls << " stalls waiting " << stats.stallMilliseconds << "ms";
+            }
+            std::cout << std::endl;
+        }
+        StreamBuffer::active = previous;
+        deleteDepthTarget(framebuffer, depth);
+    }
+
+    void levelsOfDetail(int objects, int frames) {
+        Mesh mesh = MeshSimplifier::generateLods(sphereMesh(64, 128), 3, "benchmark", 5);
+        BenchmarkModel sphere(mesh, VertexLayout{6 * sizeof(float), {
+                {0, 3, GL_FLOAT, 0},
+                {1, 3, GL_FLOAT, 3 * sizeof(float)}
+        }});
+
+        // Rows of spheres stretching away from a camera at the origin
+        Camera camera(1.0f);
+        camera.cameraPos = glm::vec3(0.0f);
+        int side = (int) std::ceil(std::sqrt((double) objects));
+        std::vector<glm::mat4> transforms;
+        for (int i = 0; i < objects; i++) {
+            glm::vec3 position((i % side - (side - 1) * 0.5f) * 3.0f, 0.0f, -5.0f - (i / side) * 3.0f);
+            transforms.push_back(glm::translate(glm::mat4(1.0f), position));
+        }
+
+        const int size = 1024;
+        unsigned int depth;
+        unsigned int framebuffer = bindDepthTarget(size, &depth);
+        FrameUniforms frame{};
+        frame.lightSpaceMatrix = glm::perspective(glm::radians(camera.fov), 1.0f, MIN_DISTANCE, MAX_DISTANCE)
+                * glm::lookAt(camera.cameraPos, glm::vec3(0.0f, 0.0f, -1.0f), camera.cameraUp);
+        core::Data.frame->update(&frame);
+        Shader depthShader("simpleDepthShader.vert", "simpleDepthShader.frag", core::Path.shaders, DrawList::drawDefines());
+        Shader::buildAll({&depthShader});
+
+        // Cumulative milliseconds, including building the list, drawing every sphere in full then at its level of
+        // detail. The first frame isn't timed
+        DrawList list;
+        LodSelector selector;
+        std::vector<int> levels(objects, 0);
+        double milliseconds[2] = {0, 0};
+        for (int f = -1; f < frames; f++) {
+            for (int lod = 0; lod < 2; lod++) {
+                glClear(GL_DEPTH_BUFFER_BIT);
+                glFinish();
+                auto start = std::chrono::steady_clock::now();
+                if (lod) selector.beginFrame(camera, size);
+                for (int i = 0; i < objects; i++) {
+                    const MeshLod &level = lod ? selector.select(sphere, transforms[i], levels[i]) : sphere.getLods()[0];
+                    list.add(depthShader, sphere, level, transforms[i]);
+                }
+                list.draw();
+                glFinish();
+                if (lod) selector.endFrame();
+                if (f >= 0) {
+                    milliseconds[lod] += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+                }
+            }
+        }
+        deleteDepthTarget(framebuffer, depth);
+
+        const LodSelector::Frame &counts = selector.getFrame();
+        std::cout << "BENCHMARK::LOD " << objects << " spheres of " << mesh.lods.size() << " levels: "
+                  << counts.fullTriangles << " triangles in " << milliseconds[0] / frames << "ms/frame in full, "
+                  << counts.triangles << " triangles in " << milliseconds[1] / frames
+                  << "ms/frame with levels of detail" << std::endl;
+    }
+
+    void meshletCulling(int objects, int frames) {
+        Mesh mesh = MeshletBuilder::build(sphereMesh(64, 128), 3, "benchmark");
+        BenchmarkModel sphere(mesh, VertexLayout{6 * sizeof(float), {
+                {0, 3, GL_FLOAT, 0},
+                {1, 3, GL_FLOAT, 3 * sizeof(float)}
+        }});
+
+        // A grid of spheres in every direction around a camera above them, so some are behind it
+        glm::vec3 cameraPos(0.0f, 3.0f, 0.0f);
+        int side = (int) std::ceil(std::sqrt((double) objects));
+        std::vector<glm::mat4> transforms;
+        for (int i = 0; i < objects; i++) {
+            glm::vec3 position((i % side - (side - 1) * 0.5f) * 3.0f, 0.0f, (i / side - (side - 1) * 0.5f) * 3.0f);
+            transforms.push_back(glm::translate(glm::mat4(1.0f), position));
+        }
+
+        unsigned int depth;
+        unsigned int framebuffer = bindDepthTarget(1024, &depth);
+        FrameUniforms frame{};
+        frame.lightSpaceMatrix = glm::perspective(glm::radians(45.0f), 1.0f, MIN_DISTANCE, MAX_DISTANCE)
+                * glm::lookAt(cameraPos, glm::vec3(0.0f, 0.0f, -10.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+        core::Data.frame->update(&frame);
+        Shader depthShader("simpleDepthShader.vert", "simpleDepthShader.frag", core::Path.shaders, DrawList::drawDefines());
+        Shader::buildAll({&depthShader});
+
+        // Cumulative milliseconds, including building the list, drawing every meshlet then only those left after
+        // culling. The first frame isn't timed
+        MeshletCuller culler;
+        culler.setView(frame.lightSpaceMatrix, cameraPos);
+        DrawList lists[2];
+        lists[1].setCuller(&culler);
+        double milliseconds[2] = {0, 0};
+        for (int f = -1; f < frames; f++) {
+            for (int cull = 0; cull < 2; cull++) {
+                glClear(GL_DEPTH_BUFFER_BIT);
+                glFinish();
+                auto start = std::chrono::steady_clock::now();
+                for (const glm::mat4 &transform : transforms) {
+                    lists[cull].add(depthShader, sphere, sphere.getLods()[0], transform);
+                }
+                lists[cull].draw();
+                glFinish();
+                if (f >= 0) {
+                    milliseconds[cull] += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+                }
+            }
+        }
+        deleteDepthTarget(framebuffer, depth);
+
+        const MeshletCuller::Stats &stats = culler.getStats();
+        std::cout << "BENCHMARK::MESHLETS " << objects << " spheres of " << mesh.meshlets.size() << " meshlets: "
+                  << milliseconds[0] / frames << "ms/frame whole, " << milliseconds[1] / frames
+                  << "ms/frame culled, rejecting " << 100.0 * stats.trianglesCulled / stats.triangles
+                  << "% of triangles (" << 100.0 * stats.frustumCulled / stats.meshlets << "% of meshlets outside the view, "
+                  << 100.0 * stats.coneCulled / stats.meshlets << "% facing away) at "
+                  << stats.milliseconds * 1000000 / stats.triangles << "ms per million triangles" << std::endl;
+    }
+
+    void meshLoading(int rings, int segments, int loads) {
+        std::error_code error;
+        std::filesystem::create_directories(core::Path.cache, error);
+        std::string objPath = core::Path.cache + "benchmark.obj", meshPath = core::Path.cache + "benchmark.mesh";
+
+        if (!writeObj(objPath, sphereMesh(rings, segments))) return;
+        std::vector<PackedAttribute> format = {
+                {0, 3, 0, VertexPacking::QUANTISED_SHORT},
+                {1, 3, 3, VertexPacking::NORMALISED_INT_2_10_10_10},
+                {2, 2, 6, VertexPacking::HALF_FLOAT}
+        };
+        Mesh parsed;
+        if (!ObjLoader::load(objPath, "benchmark", &parsed) || !MeshFile::write(meshPath, parsed, format, "benchmark")) return;
+        // Models are only built from files that open, so a file that doesn't is reported rather than timed
+        if (!MeshFile(meshPath).isOpen()) return;
+
+        // Each load includes the upload, as the mesh file's only work is the upload
+        double milliseconds[2] = {0, 0};
+        size_t sizes[2] = {std::filesystem::file_size(objPath, error), std::filesystem::file_size(meshPath, error)};
+        for (int load = 0; load < loads; load++) {
+            glFinish();
+            auto start = std::chrono::steady_clock::now();
+            {
+                Mesh mesh;
+                ObjLoader::load(objPath, "benchmark", &mesh);
+                BenchmarkModel model(mesh, format, "benchmark");
+                glFinish();
+            }
+            auto parsedAt = std::chrono::steady_clock::now();
+            {
+                MeshFile file(meshPath);
+                BenchmarkModel model(file);
+                glFinish();
+            }
+            auto mappedAt = std::chrono::steady_clock::now();
+            milliseconds[0] += std::chrono::duration<double, std::milli>(parsedAt - start).count();
+            milliseconds[1] += std::chrono::duration<double, std::milli>(mappedAt - parsedAt).count();
+        }
+        std::filesystem::remove(objPath, error);
+        std::filesystem::remove(meshPath, error);
+
+        const char *names[2] = {"OBJ", "mesh file"};
+        std::cout << "BENCHMARK::MESH_LOADING " << parsed.indices.size() / 3 << " triangles:";
+        for (int file = 0; file < 2; file++) {
+            double perLoad = milliseconds[file] / loads;
+            std::cout << (file ? ", " : " ") << names[file] << " of " << sizes[file] / 1024 << "KB in " << perLoad
+                      << "ms (" << sizes[file] / 1048576.0 / (perLoad / 1000) << "MB/s)";
+        }
+        std::cout << std::endl;
+    }
+
+    void meshImport(int rings, int segments, int loads) {
+        std::error_code error;
+        std::filesystem::create_directories(core::Path.cache, error);
+        std::string paths[2] = {core::Path.cache + "benchmark.obj", core::Path.cache + "benchmark.glb"};
+        Mesh sphere = sphereMesh(rings, segments);
+        if (!writeObj(paths[0], sphere) || !writeGlb(paths[1], sphere)) return;
+
+        // Powers of two up to every core, then every core if that isn't one
+        std::vector<unsigned int> threadCounts;
+        unsigned int cores = std::max(1u, std::thread::hardware_concurrency());
+        for (unsigned int threads = 1; threads < cores; threads *= 2) threadCounts.push_back(threads);
+        threadCounts.push_back(cores);
+
+        const char *names[2] = {"OBJ", "glTF"};
+        for (int format = 0; format < 2; format++) {
+            size_t size = std::filesystem::file_size(paths[format], error);
+            double serial = 0;
+            Mesh mesh;
+            for (unsigned int threads : threadCounts) {
+                ThreadPool pool(threads);
+                double fastest = 0;
+                for (int load = 0; load < loads; load++) {
+                    auto start = std::chrono::steady_clock::now();
+                    if (format == 0) ObjLoader::load(paths[format], "benchmark", &mesh, &pool);
+                    else GltfLoader::load(paths[format], "benchmark", &mesh, &pool);
+                    double milliseconds = std::chrono::duration<double, std::milli>(
+                            std::chrono::steady_clock::now() - start).count();
+                    fastest = load ? std::min(fastest, milliseconds) : milliseconds;
+                }
+                if (threads == 1) serial = fastest;
+                std::cout << "BENCHMARK::MESH_IMPORT " << names[format] << " of " << size / 1024 << "KB, "
+                          << mesh.indices.size() / 3 << " triangles on " << threads << " threads: " << fastest
+                          << "ms (" << size / 1048576.0 / (fastest / 1000) << "MB/s, " << serial / fastest
+                          << "x one thread)" << std::endl;
+            }
+
+            // The import is ready to pack into a Model as it is
+            BenchmarkModel model(mesh, {
+                    {0, 3, 0, VertexPacking::QUANTISED_SHORT},
+                    {1, 3, 3, VertexPacking::NORMALISED_INT_2_10_10_10},
+                    {2, 2, 6, VertexPacking::HALF_FLOAT}
+            }, names[format]);
+            std::filesystem::remove(paths[format], error);
+        }
+    }
+
+    Mesh sphereMesh(int rings, int segments) {
+        auto vertexAt = [rings, segments](int ring, int segment, float *vertex) {
+            float phi = glm::pi<float>() * ring / rings;
+            float theta = glm::two_pi<float>() * (segment % segments) / segments;
+            glm::vec3 position(std::sin(phi) * std::cos(theta), std::cos(phi), std::sin(phi) * std::sin(theta));
+            // The poles are exact, so every segment's pole is the same vertex
+            if (ring == 0 || ring == rings) position = glm::vec3(0.0f, ring == 0 ? 1.0f : -1.0f, 0.0f);
+            for (int c = 0; c < 3; c++) vertex[c] = vertex[c + 3] = position[c];
+        };
+        MeshBuilder builder(6);
+        for (int ring = 0; ring < rings; ring++) {
+            for (int segment = 0; segment < segments; segment++) {
+                float corners[4][6];
+                vertexAt(ring, segment, corners[0]);
+                vertexAt(ring + 1, segment, corners[1]);
+                vertexAt(ring + 1, segment + 1, corners[2]);
+                vertexAt(ring, segment + 1, corners[3]);
+                // Anticlockwise seen from outside, leaving out the triangles that meet at a pole
+                if (ring < rings - 1) {
+                    builder.add(corners[0]);
+                    builder.add(corners[2]);
+                    builder.add(corners[1]);
+                }
+                if (ring > 0) {
+                    builder.add(corners[0]);
+                    builder.add(corners[3]);
+                    builder.add(corners[2]);
+                }
+            }
+        }
+        return builder.getMesh();
+    }
+
+    bool writeObj(const std::string &path, const Mesh &mesh) {
+        std::ofstream obj(path);
+        for (size_t v = 0; v < mesh.vertexCount(); v++) {
+            const float *vertex = mesh.vertices.data() + v * mesh.floatsPerVertex;
+            obj << "v " << vertex[0] << " " << vertex[1] << " " << vertex[2] << "\n";
+            obj << "vt " << vertex[0] * 0.5f + 0.5f << " " << vertex[1] * 0.5f + 0.5f << "\n";
+            obj << "vn " << vertex[3] << " " << vertex[4] << " " << vertex[5] << "\n";
+        }
+        for (size_t i = 0; i < mesh.indices.size(); i += 3) {
+            obj << "f";
+            for (int corner = 0; corner < 3; corner++) {
+                uint32_t index = mesh.indices[i + corner] + 1;
+                obj << " " << index << "/" << index << "/" << index;
+            }
+            obj << "\n";
+        }
+        if (!obj) {
+            std::cerr << "ERROR::BENCHMARK::WRITE_FAILED " << path << std::endl;
+            return false;
+        }
+        return true;
+    }
+
+    bool writeGlb(const std::string &path, const Mesh &mesh) {
+        // One buffer view each of positions, normals, texture coordinates and indices, in that order
+        size_t vertices = mesh.vertexCount(), indices = mesh.indices.size();
+        std::vector<float> attributes;
+        attributes.reserve(vertices * 8);
+        glm::vec3 minimum(0.0f), maximum(0.0f);
+        for (int attribute = 0; attribute < 3; attribute++) {
+            for (size_t v = 0; v < vertices; v++) {
+                const float *vertex = mesh.vertices.data() + v * mesh.floatsPerVertex;
+                if (attribute == 0) {
+                    minimum = v ? glm::min(minimum, glm::make_vec3(vertex)) : glm::make_vec3(vertex);
+                    maximum = v ? glm::max(maximum, glm::make_vec3(vertex)) : glm::make_vec3(vertex);
+                }
+                if (attribute < 2) attributes.insert(attributes.end(), vertex + attribute * 3, vertex + attribute * 3 + 3);
+                // Flipped, as glTF's texture coordinates start at the top
+                else attributes.insert(attributes.end(), {vertex[0] * 0.5f + 0.5f, 0.5f - vertex[1] * 0.5f});
+            }
+        }
+        size_t sizes[4] = {vertices * 12, vertices * 12, vertices * 8, indices * 4};
+        size_t binSize = sizes[0] + sizes[1] + sizes[2] + sizes[3];
+
+        std::ostringstream json;
+        json << R"({"asset":{"version":"2.0"},"scene":0,"scenes":[{"nodes":[0]}],"nodes":[{"mesh":0}],)"
+             << R"("meshes":[{"primitives":[{"attributes":{"POSITION":0,"NORMAL":1,"TEXCOORD_0":2},"indices":3}]}],)"
+             << R"("buffers":[{"byteLength":)" << binSize << R"(}],"bufferViews":[)";
+        for (size_t view = 0, offset = 0; view < 4; offset += sizes[view++]) {
+            json << (view ? "," : "") << R"({"buffer":0,"byteOffset":)" << offset << R"(,"byteLength":)" << sizes[view]
+                 << "}";
+        }
+        json << R"(],"accessors":[)"
+             << R"({"bufferView":0,"componentType":5126,"count":)" << vertices << R"(,"type":"VEC3","min":[)"
+             << minimum.x << "," << minimum.y << "," << minimum.z << "],\"max\":[" << maximum.x << ","
+             << maximum.y << "," << maximum.z << "]},"
+             << R"({"bufferView":1,"componentType":5126,"count":)" << vertices << R"(,"type":"VEC3"},)"
+             << R"({"bufferView":2,"componentType":5126,"count":)" << vertices << R"(,"type":"VEC2"},)"
+             << R"({"bufferView":3,"componentType":5125,"count":)" << indices << R"(,"type":"SCALAR"}]})";
+        std::string text = json.str();
+        // Chunks are padded to 4 bytes, the JSON with spaces
+        text.resize((text.size() + 3) / 4 * 4, ' ');
+
+        uint32_t header[5] = {0x46546C67, 2, (uint32_t) (12 + 8 + text.size() + 8 + binSize), (uint32_t) text.size(),
+                0x4E4F534A};
+        uint32_t binHeader[2] = {(uint32_t) binSize, 0x004E4942};
+        std::ofstream glb(path, std::ios::binary);
+        glb.write((const char *) header, sizeof(header));
+        glb.write(text.data(), text.size());
+        glb.write((const char *) binHeader, sizeof(binHeader));
+        glb.write((const char *) attributes.data(), attributes.size() * sizeof(float));
+        glb.write((const char *) mesh.indices.data(), indices * sizeof(uint32_t));
+        if (!glb) {
+            std::cerr << "ERROR::BENCHMARK::WRITE_FAILED " << path << std::endl;
+            return false;
+        }
+        return true;
+    }
+
+    unsigned int bindDepthTarget(int size, unsigned int *texture) {
+        unsigned int framebuffer;
+        glGenFramebuffers(1, &framebuffer);
+        glGenTextures(1, texture);
+        glBindTexture(GL_TEXTURE_2D, *texture);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_DEPTH_COMPONENT, size, size, 0, GL_DEPTH_COMPONENT, GL_FLOAT, nullptr);
+        glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_TEXTURE_2D, *texture, 0);
+        glDrawBuffer(GL_NONE);
+        glReadBuffer(GL_NONE);
+        glViewport(0, 0, size, size);
+        return framebuffer;
+    }
+
+    void deleteDepthTarget(unsigned int framebuffer, unsigned int texture) {
+        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+        glDeleteFramebuffers(1, &framebuffer);
+        glDeleteTextures(1, &texture);
+        glViewport(0, 0, core::Data.SCR_WIDTH, core::Data.SCR_HEIGHT);
+    }
+}
@@ -8,9 +8,24 @@
 #include "../classes/Shader.h"
 #include "../classes/Camera.h"
 #include "../classes/Model.h"
+#include "../classes/UniformBuffer.h"
+#include "../classes/DrawList.h"
+#include "../classes/StreamBuffer.h"
+#include "../classes/LodSelector.h"
+#include "../classes/MeshletCuller.h"
 
 namespace core {
 
+    /**
+     * Shadow quality tiers, given as the radius of the PCF kernel used to soften shadow edges
+     */
+    enum ShadowQuality {
+        SHADOWS_OFF = 0,
+        SHADOWS_LOW = 1,
+        SHADOWS_MEDIUM = 2,
+        SHADOWS_HIGH = 5
+    };
+
     /**
      * Holds Screen and Program data
      */
@@ -22,6 +37,21 @@ namespace core {
         Shader *shader3d = nullptr;
         Shader *shader2d = nullptr;
         Camera *camera = nullptr;
+        UniformBuffer *frame = nullptr;
+        // Ring the data rewritten every frame is written through
+        StreamBuffer *stream = nullptr;
+        // Collects the objects of the scene to submit them together
+        DrawList *drawList = nullptr;
+        // Picks the level of detail of each object of the scene
+        LodSelector lods;
+        // Levels the light and the cube were last drawn at, so they only change past the selector's hysteresis
+        int lightLevel = 0;
+        int cubeLevel = 0;
+        // Rejects the meshlets of models split into them, set to the view of each pass
+        MeshletCuller culler;
+        ShadowQuality shadowQuality = SHADOWS_HIGH;
+        // Whether shaders are read from Path.shaders and reloaded when saved, rather than using those built in
+        bool diskShaders = false;
         std::vector<Model*> models;
     } Data;
 
@@ -42,6 +72,7 @@ namespace core {
         std::string root = "../";
         std::string assets = root + "assets/";
         std::string shaders = root + "shaders/";
+        std::string cache = root + "cache/";
     } Path;
 
     /**
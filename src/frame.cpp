@@ -1,6 +1,8 @@
 #include "data.cpp"
 #include "../classes/Shader.h"
 #include "../classes/Camera.h"
+#include "../classes/ShaderProfiler.h"
+#include <sstream>
 
 /**
  * Methods used from frame to frame
@@ -21,10 +23,19 @@ namespace core {
      */
     void prerender(float r, float g, float b);
     /**
-     * Builds the model and transforms to the view space
-     * @param shader Shader to transform
+     * Uploads the camera and light data every shader reads from the Frame uniform block
+     * @param lightPos Position of the light
+     * @param lightColour Colour of the light
+     * @param lightSpaceMatrix Transform from world space to the light's clip space
      */
-    void makeModel(Shader shader);
+    void updateFrame(glm::vec3 lightPos, glm::vec3 lightColour, glm::mat4 lightSpaceMatrix);
+    /**
+     * Summarises a profiled frame short enough to show in the window title
+     * @param frame Costs of each program, most expensive first
+     * @param programs Number of programs to show
+     * @return GPU time of the frame and of its most expensive programs
+     */
+    std::string profileTitle(const std::vector<ProgramCost> &frame, int programs);
 
     void processInput(float deltaT) {
         // Pretty Straightforward
@@ -39,14 +50,30 @@ namespace core {
         glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT | GL_STENCIL_BUFFER_BIT); // NOLINT(hicpp-signed-bitwise)
     }
 
-    void makeModel(Shader shader) {
-        glm::mat4 view = Data.camera->getTransformation();
-        glm::mat4 projection = Data.camera->getPerspectiveTransformation();
+    void updateFrame(glm::vec3 lightPos, glm::vec3 lightColour, glm::mat4 lightSpaceMatrix) {
+        FrameUniforms frame{};
+        frame.view = Data.camera->getTransformation();
+        frame.projection = Data.camera->getPerspectiveTransformation();
+        frame.viewProjection = frame.projection * frame.view;
+        frame.lightSpaceMatrix = lightSpaceMatrix;
+        frame.viewPos = glm::vec4(Data.camera->cameraPos, 1.0f);
+        frame.lightPos = glm::vec4(lightPos, 1.0f);
+        frame.lightColour = glm::vec4(lightColour, 1.0f);
+
+        // One upload reaches every program, as they all share the binding point
+        Data.frame->update(&frame);
+    }
+
+    std::string profileTitle(const std::vector<ProgramCost> &frame, int programs) {
+        double total = 0;
+        for (const ProgramCost &cost : frame) total += cost.gpuMilliseconds;
 
-        shader.use();
-        int viewLoc = glGetUniformLocation(shader.ID, "view");
-        glUniformMatrix4fv(viewLoc, 1, GL_FALSE, glm::value_ptr(view));
-        int projectionLoc = glGetUniformLocation(shader.ID, "projection");
-        glUniformMatrix4fv(projectionLoc, 1, GL_FALSE, glm::value_ptr(projection));
+        std::ostringstream title;
+        title.precision(3);
+        title << "GPU " << total << "ms";
+        for (int i = 0; i < programs && i < (int) frame.size(); i++) {
+            title << " | " << frame[i].name << " " << frame[i].gpuMilliseconds << "ms, " << frame[i].drawCalls << " draws";
+        }
+        return title.str();
     }
-}
\ No newline at end of file
+}
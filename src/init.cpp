@@ -13,6 +13,15 @@ namespace core {
      * @param isPNG Whether the image is a png (has an alpha channel)
      */
     void generateTexture(unsigned int *texture, std::string path, bool isPNG);
+    /**
+     * Gets the defines that build the shadow quality chosen into shaders that include shadow.glsl
+     * @return Defines to build the shader with
+     */
+    ShaderDefines shadowDefines();
+
+    ShaderDefines shadowDefines() {
+        return ShaderDefines{{"PCF_RADIUS", std::to_string(Data.shadowQuality)}};
+    }
 
     void generateTexture(unsigned int *texture, const std::string path, bool isPNG) {
         glGenTextures(1, texture);
@@ -0,0 +1,66 @@
+/**
+ * Converts Wavefront OBJ and binary glTF files into mesh files the program maps and uploads without parsing
+ *
+ * Usage: meshconvert <input.obj|input.glb> <output.mesh> [--lods <levels>] [--meshlets]
+ *
+ * The input is parsed on every core. The mesh is welded and optimised for the vertex cache, overdraw and vertex
+ * fetch, then packed as CubeModel is: quantised positions, 2_10_10_10 normals and half float texture coordinates.
+ * Levels of detail and meshlets are each built only when asked for, as meshlets only pay off for dense meshes
+ */
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include "../classes/GltfLoader.h"
+#include "../classes/MeshFile.h"
+#include "../classes/MeshOptimiser.h"
+#include "../classes/MeshSimplifier.h"
+#include "../classes/MeshletBuilder.h"
+#include "../classes/ObjLoader.h"
+
+int main(int argc, char *argv[])
+{
+    if(argc < 3)
+    {
+        std::cerr << "Usage: meshconvert <input.obj|input.glb> <output.mesh> [--lods <levels>] [--meshlets]"
+                  << std::endl;
+        return 1;
+    }
+    std::string input = argv[1];
+    std::string output = argv[2];
+    int levels = 1;
+    bool meshlets = false;
+    for(int i = 3; i < argc; i++)
+    {
+        if(strcmp(argv[i], "--lods") == 0 && i + 1 < argc) levels = std::max(1, atoi(argv[++i]));
+        else if(strcmp(argv[i], "--meshlets") == 0) meshlets = true;
+        else
+        {
+            std::cerr << "ERROR::MESHCONVERT::UNKNOWN_OPTION " << argv[i] << std::endl;
+            return 1;
+        }
+    }
+
+    Mesh mesh;
+    ThreadPool pool;
+    bool glb = input.size() >= 4 && input.compare(input.size() - 4, 4, ".glb") == 0;
+    if(!(glb ? GltfLoader::load(input, input, &mesh, &pool) : ObjLoader::load(input, input, &mesh, &pool))) return 1;
+    if(mesh.indices.empty())
+    {
+        std::cerr << "ERROR::MESHCONVERT::NO_TRIANGLES " << input << std::endl;
+        return 1;
+    }
+
+    mesh = MeshOptimiser::optimise(mesh, 3, input);
+    if(levels > 1) mesh = MeshSimplifier::generateLods(mesh, 3, input, levels);
+    if(meshlets) mesh = MeshletBuilder::build(mesh, 3, input);
+
+    bool written = MeshFile::write(output, mesh, {
+            {0, 3, 0, VertexPacking::QUANTISED_SHORT},
+            {1, 3, 3, VertexPacking::NORMALISED_INT_2_10_10_10},
+            {2, 2, 6, VertexPacking::HALF_FLOAT}
+    }, input);
+    return written ? 0 : 1;
+}
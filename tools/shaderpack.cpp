@@ -0,0 +1,140 @@
+/**
+ * Build step that checks every shader in a directory and writes their preprocessed sources, compressed, into a C++
+ * file compiled into the program
+ *
+ * Usage: shaderpack <shaders directory> <output file> [glslangValidator]
+ *
+ * Each .vert and .frag file has its includes resolved, which fails the build if any is missing. When a path to
+ * glslangValidator is given each resolved source is also compiled by it, so syntax errors fail the build rather than
+ * showing up at runtime
+ */
+
+#include <zlib.h>
+
+#include <algorithm>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "../classes/ShaderPreprocessor.h"
+
+/**
+ * Compiles a resolved source with glslangValidator
+ * @param validator Path to glslangValidator
+ * @param temporary Path to write the source to so it can be compiled
+ * @param stage "vert" or "frag"
+ * @param source Source code
+ * @return True if it compiled
+ */
+bool validate(const std::string &validator, const std::string &temporary, const std::string &stage, const std::string &source)
+{
+    {
+        std::ofstream file(temporary);
+        file << source;
+    }
+    std::string command = "\"" + validator + "\" -S " + stage + " \"" + temporary + "\"";
+    int result = std::system(command.c_str());
+    std::filesystem::remove(temporary);
+    return result == 0;
+}
+
+/**
+ * Compresses a source with zlib
+ * @param source Source code
+ * @param compressed Location to store the compressed bytes
+ * @return True if it was compressed
+ */
+bool compress(const std::string &source, std::vector<unsigned char> *compressed)
+{
+    uLongf length = compressBound(source.size());
+    compressed->resize(length);
+    if(compress2(compressed->data(), &length, (const Bytef *) source.data(), source.size(), Z_BEST_COMPRESSION) != Z_OK) return false;
+    compressed->resize(length);
+    return true;
+}
+
+int main(int argc, char *argv[])
+{
+    if(argc < 3)
+    {
+        std::cerr << "Usage: shaderpack <shaders directory> <output file> [glslangValidator]" << std::endl;
+        return 1;
+    }
+    std::string location = std::string(argv[1]) + "/";
+    std::string output = argv[2];
+    std::string validator = argc > 3 ? argv[3] : "";
+
+    std::vector<std::string> paths;
+    for(const auto &entry : std::filesystem::directory_iterator(location))
+    {
+        std::string extension = entry.path().extension().string();
+        if(entry.is_regular_file() && (extension == ".vert" || extension == ".frag"))
+        {
+            paths.push_back(entry.path().filename().string());
+        }
+    }
+    // Keeps the output the same between builds
+    std::sort(paths.begin(), paths.end());
+
+    std::ofstream file(output);
+    file << "// Generated by shaderpack from " << location << ". Do not edit\n\n";
+    file << "#include \"classes/EmbeddedShaders.h\"\n\n";
+
+    bool valid = true;
+    size_t originalSize = 0, compressedSize = 0;
+    ShaderPreprocessor preprocessor(location);
+    for(size_t i = 0; i < paths.size(); i++)
+    {
+        std::string source;
+        if(!preprocessor.process(paths[i], {}, &source))
+        {
+            std::cerr << "ERROR::SHADERPACK::PREPROCESSING_FAILED " << paths[i] << std::endl;
+            valid = false;
+            continue;
+        }
+        std::string stage = paths[i].substr(paths[i].size() - 4);
+        if(!validator.empty() && !validate(validator, output + "." + paths[i], stage, source))
+        {
+            std::cerr << "ERROR::SHADERPACK::VALIDATION_FAILED " << paths[i] << std::endl;
+            valid = false;
+            continue;
+        }
+
+        std::vector<unsigned char> compressed;
+        if(!compress(source, &compressed))
+        {
+            std::cerr << "ERROR::SHADERPACK::COMPRESSION_FAILED " << paths[i] << std::endl;
+            valid = false;
+            continue;
+        }
+        originalSize += source.size();
+        compressedSize += compressed.size();
+
+        file << "// " << paths[i] << "\nstatic const unsigned char shader" << i << "[] = {";
+        for(size_t j = 0; j < compressed.size(); j++)
+        {
+            file << (j % 20 == 0 ? "\n        " : " ") << (int) compressed[j] << ",";
+        }
+        file << "\n};\n\n";
+    }
+    if(!valid)
+    {
+        file.close();
+        std::filesystem::remove(output);
+        return 1;
+    }
+
+    file << "const EmbeddedShader embeddedShaders[] = {\n";
+    for(size_t i = 0; i < paths.size(); i++)
+    {
+        file << "        {\"" << paths[i] << "\", shader" << i << ", sizeof(shader" << i << ")},\n";
+    }
+    file << "};\n";
+    file << "const unsigned int embeddedShaderCount = " << paths.size() << ";\n";
+
+    std::cout << "INFO::SHADERPACK::EMBEDDED " << paths.size() << " shaders, " << originalSize << " bytes compressed to "
+              << compressedSize << std::endl;
+    return 0;
+}